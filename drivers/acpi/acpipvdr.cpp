@@ -23,6 +23,7 @@ using namespace tacOS::Drivers::Acpi;
 AcpiDef::RSDPAddress AcpiProvider::RsdpAddr;
 AcpiDef::Rsdp* AcpiProvider::Rsdp;
 AcpiDef::Xsdt* AcpiProvider::Xsdt;
+AcpiDef::Fadt* AcpiProvider::Fadt;
 
 /// @brief Intialize ACPI for Kernel
 /// @return ACPI Initialization Status
@@ -52,5 +53,11 @@ AcpiDef::Status AcpiProvider::Initialize()
     }
 
     Xsdt = (AcpiDef::Xsdt*)Rsdp->XsdtAddress;
+
+    /* The FADT is Mandatory, but Tolerate Firmware that Omits it */
+    AcpiDef::Address FadtAddr;
+    if (AcpiDef::GetTableBySignature(ACPI_SIG_FADT, Xsdt, &FadtAddr))
+        Fadt = (AcpiDef::Fadt*)FadtAddr;
+
     return 1;
 }
\ No newline at end of file
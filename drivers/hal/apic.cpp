@@ -17,14 +17,20 @@
 */
 
 #include <kernel/mem/virtualmm.hpp>
+#include <asm/cpu.hpp>
 #include <drivers/acpi/acpipvdr.hpp>
 #include <drivers/hal/apic.hpp>
 #include <tools/kernelrtl/kernelrtl.hpp>
 
+using namespace tacOS::ASM;
 using namespace tacOS::Drivers::HAL;
 using namespace tacOS::Drivers::Acpi;
 using namespace tacOS::Tools::KernelRTL;
 
+/* Define Statics */
+u32* Apic::LocalApicAddr;
+bool Apic::X2ApicMode;
+
 static Apic::Status ProcessApicISROverride(AcpiDef::MadtEntryApicISROverride* ApicISROverride)
 {
 }
@@ -64,8 +70,9 @@ Apic::Status Apic::Initialize()
         https://uefi.org/htmlspecs/ACPI_Spec_6_4_html/05_ACPI_Software_Programming_Model/ACPI_Software_Programming_Model.html#multiple-apic-description-table-madt
     */
 
+    u64 LocalApicPhysAddr = Madt->LocalAPICAddr;
     AcpiDef::MadtEntryApic* IoApic;
-    AcpiDef::MadtEntryLocalApic* LApicList[10];
+    bool NeedsX2Apic = false;
 
     u8* MadtEntryPtr = (u8*) (Madt + 1);
     u8* MadtEnd = (u8*) Madt + Madt->Header.Length;
@@ -76,11 +83,18 @@ Apic::Status Apic::Initialize()
 
         switch(Header->EntryType) {
             case AcpiDef::MadtEntryType::LOCAL_APIC: {
-                AcpiDef::MadtEntryLocalApic* LApic = (AcpiDef::MadtEntryLocalApic*) Header;
-                LApicList[LApic->AcpiProcessorId] = LApic;
+                /* Processors are Registered by Smp::Initialize(), and Reported by Topology::Dump() */
+                break;
+            }
 
-                printf("Processor Detected (CPUID): ");
-                printf(LApic->AcpiProcessorId);
+            case AcpiDef::MadtEntryType::LOCAL_X2APIC: {
+                /* IDs past the xAPIC Range can only be Addressed in x2APIC Mode */
+                AcpiDef::MadtEntryLocalX2Apic* LX2Apic = (AcpiDef::MadtEntryLocalX2Apic*) Header;
+                if (LX2Apic->ApicId > APIC_X2APIC_MAXXAPICID)
+                    NeedsX2Apic = true;
+
+                printf("Processor Detected (x2APIC UID): ");
+                printf(LX2Apic->AcpiId);
                 printf("\n");
                 break;
             }
@@ -101,6 +115,13 @@ Apic::Status Apic::Initialize()
                 break;
             }
 
+            case AcpiDef::MadtEntryType::LOCAL_APIC_ADDR_OVERRIDE: {
+                /* 64-bit Local APIC Address supersedes the MADT Header Field */
+                AcpiDef::MadtEntryLocalApicAddrOverride* AddrOverride = (AcpiDef::MadtEntryLocalApicAddrOverride*) Header;
+                LocalApicPhysAddr = AddrOverride->PhysicalAddress;
+                break;
+            }
+
             default: {
                 printf("Unknown MADT Entry Type ");
                 printf(Header->EntryType);
@@ -118,5 +139,77 @@ Apic::Status Apic::Initialize()
     /* Write to IOREGSEL */
     *IoApicAddr = 0;
 
+    /*
+        x2APIC mode is only entered when the MADT lists a processor
+        that xAPIC cannot address. Once entered, every processor has
+        to switch, as IPIs are then sent with 32-bit destinations.
+
+        Refer:
+        Intel SDM Vol. 3A, Section 11.12.1 (Detecting and Enabling x2APIC Mode)
+    */
+
+    u32 Eax, Ebx, Ecx, Edx;
+    Cpu::Cpuid(1, 0, &Eax, &Ebx, &Ecx, &Edx);
+    X2ApicMode = NeedsX2Apic && (Ecx & (1 << 21));
+
+    /* Map the Local APIC, Enable it to receive MSIs and IPIs */
+    LocalApicAddr = (u32*) VirtualMemory::HardwareRemap((u64*) LocalApicPhysAddr);
+    EnableLocalApic();
+
     return Status::OK;
+}
+
+/// @brief Software-enables the Local APIC of the Executing Processor
+void Apic::EnableLocalApic()
+{
+    /*
+        The Local APIC is hardware-enabled on reset but stays soft
+        -ware-disabled till the APIC Software Enable bit is set in
+        the Spurious Interrupt Vector Register (SVR). The low byte
+        of the SVR selects the vector delivered for spurious inter
+        -rupts. Those are never acknowledged with an EOI.
+
+        A Task Priority of zero lets every interrupt class through.
+
+        Refer:
+        https://wiki.osdev.org/APIC#Spurious_Interrupt_Vector_Register
+    */
+
+    if (X2ApicMode) {
+        /* xAPIC Enable must be Set before (or with) x2APIC Enable */
+        u64 Base = Cpu::ReadMsr(ASM_CPU_MSR_APICBASE);
+        Cpu::WriteMsr(ASM_CPU_MSR_APICBASE, Base | APIC_BASE_MSR_ENABLE | APIC_BASE_MSR_X2APIC);
+    }
+
+    WriteLocal(APIC_LAPIC_REG_TPR, 0);
+    WriteLocal(APIC_LAPIC_REG_SVR, APIC_LAPIC_SVR_ENABLE | APIC_LAPIC_SPURIOUS_VECTOR);
+}
+
+/// @brief Sends an Inter-Processor Interrupt
+/// @param ApicId Local APIC ID of the Destination Processor
+/// @param Command Low ICR Word (Delivery Mode, Level, Vector)
+void Apic::SendIpi(u32 ApicId, u32 Command)
+{
+    /*
+        Writing the low ICR word sends the IPI, so the destination
+        is written first. Interrupts are held across both writes,
+        a handler sending its own IPI would clobber the destination.
+        In x2APIC mode, a single MSR write carries both halves.
+
+        Refer:
+        Intel SDM Vol. 3A, Section 11.6.1 (Interrupt Command Register (ICR))
+    */
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    if (X2ApicMode) {
+        Cpu::WriteMsr(APIC_X2APIC_MSR_ICR, ((u64)ApicId << 32) | Command);
+    } else {
+        WriteLocal(APIC_LAPIC_REG_ICRHIGH, ApicId << 24);
+        WriteLocal(APIC_LAPIC_REG_ICRLOW, Command);
+
+        while (ReadLocal(APIC_LAPIC_REG_ICRLOW) & APIC_LAPIC_ICR_PENDING)
+            Cpu::Pause();
+    }
+
+    Cpu::RestoreFlags(Flags);
 }
\ No newline at end of file
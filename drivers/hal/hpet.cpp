@@ -0,0 +1,238 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <drivers/acpi/acpipvdr.hpp>
+#include <drivers/hal/hpet.hpp>
+#include <drivers/pci/msi.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/interrupts/intrdef.hpp>
+#include <kernel/mem/virtualmm.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::Drivers::Acpi;
+using namespace tacOS::Drivers::PCI;
+using namespace tacOS::Kernel;
+using namespace tacOS::ASM;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+volatile u64* Hpet::Registers;
+u64 Hpet::Frequency;
+u32 Hpet::TimerCount;
+ClockSource::Source Hpet::Clock;
+Hpet::Comparator Hpet::Comparators[HPET_MAXTIMERS];
+
+/// @brief Maps the HPET, Starts its Counter and Registers it as a Clock Source
+/// @return OK if Registered
+Hpet::Status Hpet::Initialize()
+{
+    /*
+        The HPET is a memory-mapped, constant rate counter (at
+        least 10 MHz) with a set of comparators. Reads are slow
+        (an uncached MMIO access), so it is rated below an invariant
+        TSC. It is stable in every power state and is emulated
+        faithfully by hypervisors, which makes it the calibration
+        reference and the fallback clock.
+    */
+
+    AcpiDef::Address HpetAddr;
+    if (!AcpiDef::GetTableBySignature(ACPI_SIG_HPET, AcpiProvider::Xsdt, &HpetAddr))
+        return Status::ERROR;
+
+    AcpiDef::Hpet* Table = (AcpiDef::Hpet*)HpetAddr;
+    if (Table->Address.AddressSpace != ACPI_GAS_SYSTEMMEMORY)
+        return Status::ERROR;
+
+    volatile u64* Mapped = (volatile u64*)VirtualMemory::HardwareRemap(
+        (PhysicalMemory::PhysicalAddress*)Table->Address.Address, HPET_REGISTERS_SIZE);
+
+    u64 Capabilities = Mapped[HPET_REG_CAPABILITIES / sizeof(u64)];
+    u64 Period = Capabilities >> HPET_CAP_PERIODSHIFT;
+    if (!Period || Period > HPET_MAXPERIOD_FS) {
+        Logging::LogMessage(Logging::LogLevel::ERROR, "HPET Reports an Invalid Period");
+        return Status::ERROR;
+    }
+
+    Registers = Mapped;
+    Frequency = HPET_FEMTOSEC_PER_SEC / Period;
+    TimerCount = ((Capabilities >> HPET_CAP_TIMERSSHIFT) & HPET_CAP_TIMERSMASK) + 1;
+
+    /* Comparators stay Disabled until Claimed, Legacy Routing is not Used */
+    for (u32 Index = 0; Index < TimerCount; Index++) {
+        u64 Config = Read(HPET_REG_TIMERCONFIG(Index));
+        Config &= ~(HPET_TIMER_ENABLE | HPET_TIMER_PERIODIC | HPET_TIMER_FSBENABLE);
+        Write(HPET_REG_TIMERCONFIG(Index), Config);
+    }
+
+    u64 Config = Read(HPET_REG_CONFIG);
+    Config &= ~HPET_CONFIG_LEGACYROUTE;
+    Write(HPET_REG_CONFIG, Config | HPET_CONFIG_ENABLE);
+
+    printf("HPET KHz: ");
+    printf(Frequency / 1000);
+    printf("\n");
+
+    Clock.Name = "hpet";
+    Clock.Rating = HPET_RATING;
+    Clock.Read = ReadClock;
+    Clock.Mask = (Capabilities & HPET_CAP_COUNTERSIZE) ? ~0ULL : 0xFFFFFFFFULL;
+    ClockSource::SetFrequency(&Clock, Frequency);
+    ClockSource::Register(&Clock);
+
+    return Status::OK;
+}
+
+/// @brief Claims a Comparator as a Timer Event Device of a Processor
+/// @param Cpu Logical CPU Index receiving the Events
+/// @return OK if Registered
+Hpet::Status Hpet::InitializeCpu(u32 Cpu)
+{
+    /*
+        Comparators are delivered through FSB messages, which are
+        MSI writes straight to the target Local APIC. The I/O APIC
+        is not routed by this kernel, so comparators without FSB
+        delivery are left unused.
+    */
+
+    if (!Available())
+        return Status::ERROR;
+
+    Comparator* Cmp = 0;
+    for (u32 Index = 0; Index < TimerCount && Index < HPET_MAXTIMERS; Index++) {
+        u64 Config = Read(HPET_REG_TIMERCONFIG(Index));
+        if (!Comparators[Index].InUse && (Config & HPET_TIMER_FSBCAP)) {
+            Cmp = &Comparators[Index];
+            Cmp->Index = Index;
+            break;
+        }
+    }
+
+    /* FSB Messages carry an 8-bit Destination, like MSIs */
+    if (!Cmp || Smp::GetApicId(Cpu) > MSI_ADDRESS_MAXDESTID)
+        return Status::ERROR;
+
+    Cmp->Vector = Interrupt::AllocateVector(Cpu, Interrupt::TIMER);
+    if (!Cmp->Vector)
+        return Status::ERROR;
+
+    Cmp->InUse = true;
+    Interrupt::BindHandler(Cpu, Cmp->Vector, TimerInterrupt, Cmp);
+
+    /* FSB Route: Address in the High Dword, Data in the Low Dword */
+    u64 Route = ((u64)Msi::ComposeAddress(Smp::GetApicId(Cpu)) << 32) | Msi::ComposeData(Cmp->Vector);
+    Write(HPET_REG_TIMERFSBROUTE(Cmp->Index), Route);
+
+    /* Edge Triggered, Enabled when Programmed */
+    u64 Config = Read(HPET_REG_TIMERCONFIG(Cmp->Index));
+    Cmp->Mask = (Config & HPET_TIMER_64BITCAP) ? Clock.Mask : 0xFFFFFFFFULL;
+    Config &= ~(HPET_TIMER_LEVEL | HPET_TIMER_ENABLE | HPET_TIMER_PERIODIC);
+    Write(HPET_REG_TIMERCONFIG(Cmp->Index), Config | HPET_TIMER_FSBENABLE);
+
+    ClockEvent::Device* Event = &Cmp->Event;
+    Event->Name = "hpet";
+    Event->Features = KERNEL_CLOCKEVT_ONESHOT;
+    if (Config & HPET_TIMER_PERIODICCAP)
+        Event->Features |= KERNEL_CLOCKEVT_PERIODIC;
+
+    Event->Rating = HPET_EVENT_RATING;
+    Event->Cpu = Cpu;
+    Event->SetPeriodic = SetPeriodic;
+    Event->SetOneShot = SetOneShot;
+    Event->Shutdown = Shutdown;
+    Event->Elapsed = Elapsed;
+    Event->Context = Cmp;
+
+    ClockEvent::SetFrequency(Event, Frequency);
+    Event->MinDeltaNs = HPET_MINDELTA_NS;
+    Event->MaxDeltaNs = ClockEvent::TicksToNs(Event, (Config & HPET_TIMER_64BITCAP) ? 0x7FFFFFFFFFFFULL : 0x7FFFFFFFULL);
+
+    ClockEvent::Register(Event);
+    return Status::OK;
+}
+
+u64 Hpet::ReadClock(ClockSource::Source* Src)
+{
+    return ReadCounter();
+}
+
+/// @brief Comparator Vector Handler, EOI is sent by the Dispatcher
+void Hpet::TimerInterrupt(u8 Vector, void* Context)
+{
+    Comparator* Cmp = (Comparator*)Context;
+    if (Cmp->Event.EventHandler)
+        Cmp->Event.EventHandler(&Cmp->Event);
+}
+
+void Hpet::SetPeriodic(ClockEvent::Device* Dev, u64 PeriodNs)
+{
+    Comparator* Cmp = (Comparator*)Dev->Context;
+    u64 Period = ClockEvent::NsToTicks(Dev, PeriodNs);
+    u64 Config = Read(HPET_REG_TIMERCONFIG(Cmp->Index));
+
+    /* With VALUESET, the first Write sets the Comparator, the second the Period */
+    Write(HPET_REG_TIMERCONFIG(Cmp->Index), Config | HPET_TIMER_ENABLE | HPET_TIMER_PERIODIC | HPET_TIMER_VALUESET);
+    Cmp->Start = ReadCounter();
+    Write(HPET_REG_TIMERCOMPARATOR(Cmp->Index), (Cmp->Start + Period) & Cmp->Mask);
+    Write(HPET_REG_TIMERCOMPARATOR(Cmp->Index), Period);
+}
+
+void Hpet::SetOneShot(ClockEvent::Device* Dev, u64 DeltaNs)
+{
+    /*
+        The comparator fires on an exact match. If the counter has
+        already passed the new value by the time it is written, the
+        event would only arrive after a full counter wrap. The
+        counter is re-read after the write, and a missed deadline is
+        retried with a doubled delta. 32-bit comparators match the
+        low half of the counter, so the deadline wraps at their own
+        width rather than the counter's.
+    */
+
+    Comparator* Cmp = (Comparator*)Dev->Context;
+    u64 Delta = ClockEvent::NsToTicks(Dev, DeltaNs);
+    u64 Config = Read(HPET_REG_TIMERCONFIG(Cmp->Index));
+
+    Config &= ~HPET_TIMER_PERIODIC;
+    Write(HPET_REG_TIMERCONFIG(Cmp->Index), Config | HPET_TIMER_ENABLE);
+
+    for (;;) {
+        Cmp->Start = ReadCounter();
+        Write(HPET_REG_TIMERCOMPARATOR(Cmp->Index), (Cmp->Start + Delta) & Cmp->Mask);
+
+        /* Still Ahead of the Counter, the Match will Happen */
+        if (((ReadCounter() - Cmp->Start) & Clock.Mask) < Delta)
+            break;
+
+        Delta *= 2;
+    }
+}
+
+void Hpet::Shutdown(ClockEvent::Device* Dev)
+{
+    Comparator* Cmp = (Comparator*)Dev->Context;
+    u64 Config = Read(HPET_REG_TIMERCONFIG(Cmp->Index));
+    Write(HPET_REG_TIMERCONFIG(Cmp->Index), Config & ~(HPET_TIMER_ENABLE | HPET_TIMER_PERIODIC));
+}
+
+u64 Hpet::Elapsed(ClockEvent::Device* Dev)
+{
+    Comparator* Cmp = (Comparator*)Dev->Context;
+    return ClockEvent::TicksToNs(Dev, (ReadCounter() - Cmp->Start) & Clock.Mask);
+}
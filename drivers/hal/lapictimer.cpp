@@ -0,0 +1,178 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <drivers/hal/lapictimer.hpp>
+#include <drivers/hal/refclock.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/interrupts/intrdef.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::Kernel;
+using namespace tacOS::ASM;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+u64 LapicTimer::Frequency;
+LapicTimer::CpuTimer LapicTimer::Timers[KERNEL_SMP_MAXCPUS];
+
+/// @brief Calibrates the Timer and Registers it on the Bootstrap Processor
+/// @return OK if Registered
+Apic::Status LapicTimer::Initialize()
+{
+    /*
+        The LAPIC timer runs off the bus or core crystal clock,
+        which is not architecturally reported on most processors.
+        It is measured against the reference clock once at boot. All
+        processors share the clock, so the result is reused when
+        the timer of each Application Processor is registered.
+    */
+
+    if (!Apic::LocalApicAddr)
+        return Apic::Status::ERROR;
+
+    Frequency = Calibrate();
+    if (!Frequency) {
+        Logging::LogMessage(Logging::LogLevel::ERROR, "LAPIC Timer Calibration Failed");
+        return Apic::Status::ERROR;
+    }
+
+    printf("LAPIC Timer KHz: ");
+    printf(Frequency / 1000);
+    printf("\n");
+    return InitializeCpu(KERNEL_SMP_BOOTCPU);
+}
+
+/// @brief Measures the Divided Timer Frequency against the Reference Clock
+/// @return Ticks per Second, or 0 if the Reference is Stuck
+u64 LapicTimer::Calibrate()
+{
+    u64 BestTicks = 0;
+    u64 BestNs = 0;
+
+    Apic::WriteLocal(APIC_LAPIC_REG_TIMERDIVIDE, APIC_LAPIC_TIMER_DIVIDE16);
+    Apic::WriteLocal(APIC_LAPIC_REG_LVTTIMER, APIC_LAPIC_LVT_MASKED);
+
+    /* An SMI inside the Window inflates the Count, keep the Smallest Rate */
+    for (u32 Run = 0; Run < LAPICTIMER_CALIBRATION_RUNS; Run++) {
+        Apic::WriteLocal(APIC_LAPIC_REG_TIMERINITIAL, 0xFFFFFFFF);
+        u64 WindowNs = RefClock::Wait(LAPICTIMER_CALIBRATION_HZ);
+        u64 Counted = 0xFFFFFFFF - Apic::ReadLocal(APIC_LAPIC_REG_TIMERCURRENT);
+
+        if (!WindowNs)
+            return 0;
+
+        if (!BestNs || Counted * BestNs < BestTicks * WindowNs) {
+            BestTicks = Counted;
+            BestNs = WindowNs;
+        }
+    }
+
+    Apic::WriteLocal(APIC_LAPIC_REG_TIMERINITIAL, 0);
+    return (BestTicks * KERNEL_NSEC_PER_SEC) / BestNs;
+}
+
+/// @brief Registers the Timer of the Executing Processor
+/// @param Cpu Logical Index of the Executing Processor
+/// @return OK if Registered
+Apic::Status LapicTimer::InitializeCpu(u32 Cpu)
+{
+    CpuTimer* Timer = &Timers[Cpu];
+    memset(Timer, 0, sizeof(CpuTimer));
+
+    Timer->Vector = Interrupt::AllocateVector(Cpu, Interrupt::TIMER);
+    if (!Timer->Vector)
+        return Apic::Status::ERROR;
+
+    Interrupt::BindHandler(Cpu, Timer->Vector, TimerInterrupt, Timer);
+    Apic::WriteLocal(APIC_LAPIC_REG_TIMERDIVIDE, APIC_LAPIC_TIMER_DIVIDE16);
+    Apic::WriteLocal(APIC_LAPIC_REG_LVTTIMER, APIC_LAPIC_LVT_MASKED);
+
+    ClockEvent::Device* Event = &Timer->Event;
+    Event->Name = "lapic";
+    Event->Features = KERNEL_CLOCKEVT_PERIODIC | KERNEL_CLOCKEVT_ONESHOT;
+    Event->Rating = LAPICTIMER_RATING;
+    Event->Cpu = Cpu;
+    Event->SetPeriodic = SetPeriodic;
+    Event->SetOneShot = SetOneShot;
+    Event->Shutdown = Shutdown;
+    Event->Elapsed = Elapsed;
+    Event->Context = Timer;
+
+    ClockEvent::SetFrequency(Event, Frequency);
+    Event->MinDeltaNs = LAPICTIMER_MINDELTA_NS;
+    Event->MaxDeltaNs = ClockEvent::TicksToNs(Event, 0xFFFFFFFF);
+
+    ClockEvent::Register(Event);
+    return Apic::Status::OK;
+}
+
+/// @brief Timer Vector Handler, EOI is sent by the Dispatcher
+void LapicTimer::TimerInterrupt(u8 Vector, void* Context)
+{
+    CpuTimer* Timer = (CpuTimer*)Context;
+    if (Timer->Event.EventHandler)
+        Timer->Event.EventHandler(&Timer->Event);
+}
+
+/// @brief Computes an Initial Count, Clamped to the 32-bit Register
+static u32 GetInitialCount(ClockEvent::Device* Dev, u64 Ns)
+{
+    u64 Ticks = ClockEvent::NsToTicks(Dev, Ns);
+    if (Ticks == 0)
+        return 1;
+
+    return (Ticks > 0xFFFFFFFF) ? 0xFFFFFFFF : (u32)Ticks;
+}
+
+void LapicTimer::SetPeriodic(ClockEvent::Device* Dev, u64 PeriodNs)
+{
+    CpuTimer* Timer = (CpuTimer*)Dev->Context;
+    Timer->InitialCount = GetInitialCount(Dev, PeriodNs);
+
+    Apic::WriteLocal(APIC_LAPIC_REG_LVTTIMER, Timer->Vector | APIC_LAPIC_TIMER_PERIODIC);
+    Apic::WriteLocal(APIC_LAPIC_REG_TIMERINITIAL, Timer->InitialCount);
+}
+
+void LapicTimer::SetOneShot(ClockEvent::Device* Dev, u64 DeltaNs)
+{
+    CpuTimer* Timer = (CpuTimer*)Dev->Context;
+    Timer->InitialCount = GetInitialCount(Dev, DeltaNs);
+
+    /* Writing the Initial Count (Re)starts the Countdown */
+    Apic::WriteLocal(APIC_LAPIC_REG_LVTTIMER, Timer->Vector);
+    Apic::WriteLocal(APIC_LAPIC_REG_TIMERINITIAL, Timer->InitialCount);
+}
+
+void LapicTimer::Shutdown(ClockEvent::Device* Dev)
+{
+    CpuTimer* Timer = (CpuTimer*)Dev->Context;
+    Timer->InitialCount = 0;
+
+    Apic::WriteLocal(APIC_LAPIC_REG_LVTTIMER, APIC_LAPIC_LVT_MASKED);
+    Apic::WriteLocal(APIC_LAPIC_REG_TIMERINITIAL, 0);
+}
+
+u64 LapicTimer::Elapsed(ClockEvent::Device* Dev)
+{
+    /* The Current Count stops at 0 in One-Shot Mode */
+    CpuTimer* Timer = (CpuTimer*)Dev->Context;
+    u32 Current = Apic::ReadLocal(APIC_LAPIC_REG_TIMERCURRENT);
+    return ClockEvent::TicksToNs(Dev, Timer->InitialCount - Current);
+}
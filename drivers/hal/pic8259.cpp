@@ -18,12 +18,14 @@
 
 #include <asm/io.hpp>
 #include <drivers/hal/pic8259.hpp>
+#include <kernel/time/delay.hpp>
 #include <drivers/ps2/keyboard.hpp>
 #include <drivers/video/vga.hpp> // REMOVE IN FUTURE WHEN APIs ARE IMPL.
 
 using namespace tacOS::Drivers::Video; // REMOVE IN FUTURE WHEN APIs ARE IMPL.
 using namespace tacOS::Drivers::HAL;
 using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
 
 /// @brief Intializes the 8259 Programmable Interrupt Contoller
 void Pic8259::Initialize()
@@ -33,13 +35,12 @@ void Pic8259::Initialize()
         Both the master and slave PICs are traditionally
         initialized together.
 
-        After a Command is sent to the PIC, write gibberish to
-        port 0x80 (Linux does it this way). Why? The PIC takes
-        time to process the request. We need a small timer but,
-        timers work on interrupts and we're writing this block
-        of code to enable interrupts. The hack involves writing
-        gibbersh that takes around 1 to 4 microseconds. It's
-        guaranteed that the PIC will process the request by then.
+        After a Command is sent to the PIC, wait for it to process
+        the request. Old boards need a few microseconds. The wait
+        spins on the calibrated TSC (Delay). Writing to port 0x80,
+        the traditional hack, is a trapping VM exit under a hyper
+        -visor for every command. Before the TSC is calibrated,
+        Delay falls back to those port writes.
 
         Refer:
         https://docs.rs/crate/pic8259/0.10.1/source/src/lib.rs
@@ -52,11 +53,11 @@ void Pic8259::Initialize()
 
     /* Intialize the Master PIC, Wait (for old motherboards) */
     IO::outb(PIC8259_MASTER, PIC8259_INIT | PIC8259_ICW1_ICW4);
-    IO::wait();
+    Delay::Microseconds(PIC8259_COMMAND_DELAY_US);
 
     /* Intialize the Slave PIC with Init and ICW4 Present */
     IO::outb(PIC8259_SLAVE, PIC8259_INIT | PIC8259_ICW1_ICW4);
-    IO::wait();
+    Delay::Microseconds(PIC8259_COMMAND_DELAY_US);
 
     /*
         Both PICs would wait for the next three
@@ -72,9 +73,9 @@ void Pic8259::Initialize()
 
     /* Set Offset. Protected and Long modes reserve interrupts 0-31 for CPU */
     IO::outb(PIC8259_MASTER_DATA, PIC8259_MASTER_OFFSET);
-    IO::wait();
+    Delay::Microseconds(PIC8259_COMMAND_DELAY_US);
     IO::outb(PIC8259_SLAVE_DATA, PIC8259_SLAVE_OFFSET);
-    IO::wait();
+    Delay::Microseconds(PIC8259_COMMAND_DELAY_US);
 
     /*
         Configure Cascading.
@@ -90,15 +91,15 @@ void Pic8259::Initialize()
     const u8 SLAVE_ICW3 = 0b00000010; /* Slave ID is 2 */
 
     IO::outb(PIC8259_MASTER_DATA, MASTER_ICW3);
-    IO::wait();
+    Delay::Microseconds(PIC8259_COMMAND_DELAY_US);
     IO::outb(PIC8259_SLAVE_DATA, SLAVE_ICW3);
-    IO::wait();
+    Delay::Microseconds(PIC8259_COMMAND_DELAY_US);
 
     /* Make Master and Slave PIC use 8086 Mode (Using ICW4) */
     IO::outb(PIC8259_MASTER_DATA, PIC8259_ICW4_8086);
-    IO::wait();
+    Delay::Microseconds(PIC8259_COMMAND_DELAY_US);
     IO::outb(PIC8259_SLAVE_DATA, PIC8259_ICW4_8086);
-    IO::wait();
+    Delay::Microseconds(PIC8259_COMMAND_DELAY_US);
 
     /* Restore the Masks in Both PICs. Then, they're ready for interrupts */
     IO::outb(PIC8259_MASTER_DATA, mask01);
@@ -113,6 +114,22 @@ void Pic8259::Disable()
     IO::outb(PIC8259_SLAVE_DATA, 0xFF);
 }
 
+/// @brief Masks a single IRQ Line in the Interrupt Mask Register
+/// @param Line ISA IRQ Line
+void Pic8259::MaskIrq(Irq Line)
+{
+    u16 Port = (Line < 8) ? PIC8259_MASTER_DATA : PIC8259_SLAVE_DATA;
+    IO::outb(Port, IO::inb(Port) | (1 << (Line % 8)));
+}
+
+/// @brief Unmasks a single IRQ Line in the Interrupt Mask Register
+/// @param Line ISA IRQ Line
+void Pic8259::UnmaskIrq(Irq Line)
+{
+    u16 Port = (Line < 8) ? PIC8259_MASTER_DATA : PIC8259_SLAVE_DATA;
+    IO::outb(Port, IO::inb(Port) & ~(1 << (Line % 8)));
+}
+
 /// @brief Sends EOI Acknowledgement after every Interrupt.
 void Pic8259::EndOfInterrupt(u8 Code)
 {
@@ -131,6 +148,37 @@ void Pic8259::EndOfInterrupt(u8 Code)
     IO::outb(PIC8259_MASTER, PIC8259_EOI);
 }
 
+/// @brief Detects Spurious IRQ 7 and IRQ 15 Interrupts
+/// @param InterruptCode Interrupt Vector raised by the PIC
+/// @return True if no IRQ is actually In-Service
+bool Pic8259::IsSpurious(u8 InterruptCode)
+{
+    /*
+        When an IRQ is de-asserted before the CPU acknowledges it,
+        the PIC still delivers its lowest priority IRQ (7 or 15).
+        The In-Service Register then lacks the corresponding bit.
+        A spurious IRQ 7 must not be acknowledged. A spurious IRQ
+        15 came through the cascade, so the Master still needs one.
+
+        Refer:
+        https://wiki.osdev.org/8259_PIC#Spurious_IRQs
+    */
+
+    u8 PicIrq = (InterruptCode - PIC8259_MASTER_OFFSET);
+    if (PicIrq != Irq::LPT1 && PicIrq != Irq::ATA_HDD_2)
+        return false;
+
+    u16 Port = (PicIrq == Irq::LPT1) ? PIC8259_MASTER : PIC8259_SLAVE;
+    IO::outb(Port, PIC8259_OCW3_READISR);
+    if (IO::inb(Port) & (1 << 7))
+        return false;
+
+    if (PicIrq == Irq::ATA_HDD_2)
+        IO::outb(PIC8259_MASTER, PIC8259_EOI);
+
+    return true;
+}
+
 void Pic8259::TranslateInterrupt(u8 InterruptCode)
 {
     u8 PicIrq = (InterruptCode - PIC8259_MASTER_OFFSET);
@@ -158,8 +206,7 @@ void Pic8259::TranslateInterrupt(u8 InterruptCode)
             https://wiki.osdev.org/IRQ#Ports
         */
 
-        u8 ScanCode = IO::inb(0x60);
-        PS2::Keyboard::KeyboardInterrupt(ScanCode);        
+        PS2::Keyboard::KeyboardInterrupt();
         Pic8259::EndOfInterrupt(InterruptCode);
         break;
     }
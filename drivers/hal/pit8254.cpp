@@ -0,0 +1,46 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/io.hpp>
+#include <drivers/hal/pit8254.hpp>
+
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::ASM;
+
+/// @brief Starts a Channel 2 Countdown, polled with CountdownExpired
+/// @param Count PIT Ticks (1193182 Hz) to count down
+void Pit8254::StartCountdown(u16 Count)
+{
+    /* Disable the Gate and the Speaker while Programming */
+    u8 Gate = IO::inb(PIT8254_GATE_PORT);
+    Gate &= ~(PIT8254_GATE_CHANNEL2 | PIT8254_GATE_SPEAKER);
+    IO::outb(PIT8254_GATE_PORT, Gate);
+
+    IO::outb(PIT8254_COMMAND, PIT8254_CMD_CHANNEL2_ONESHOT);
+    IO::outb(PIT8254_CHANNEL2_DATA, Count & 0xFF);
+    IO::outb(PIT8254_CHANNEL2_DATA, Count >> 8);
+
+    /* A Rising Gate Edge starts Counting, OUT2 stays Low until Terminal Count */
+    IO::outb(PIT8254_GATE_PORT, Gate | PIT8254_GATE_CHANNEL2);
+}
+
+/// @brief Checks if the Channel 2 Countdown reached Terminal Count
+bool Pit8254::CountdownExpired()
+{
+    return IO::inb(PIT8254_GATE_PORT) & PIT8254_GATE_OUTPUT2;
+}
@@ -0,0 +1,99 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/io.hpp>
+#include <drivers/acpi/acpipvdr.hpp>
+#include <drivers/hal/pmtimer.hpp>
+#include <kernel/mem/virtualmm.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::Drivers::Acpi;
+using namespace tacOS::Kernel;
+using namespace tacOS::ASM;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+u16 PmTimer::Port;
+volatile u32* PmTimer::Address;
+ClockSource::Source PmTimer::Clock;
+
+/// @brief Locates the PM Timer in the FADT and Registers it as a Clock Source
+/// @return OK if Registered
+PmTimer::Status PmTimer::Initialize()
+{
+    /*
+        Every ACPI system has a PM timer. It is a free-running
+        counter at 3.579545 MHz, 24 bits wide unless the FADT sets
+        TMR_VAL_EXT. A 24-bit counter wraps every ~4.7 seconds, so
+        the clock source layer accumulates it at least twice per
+        wrap. Reads go through an I/O port on most chipsets, which
+        is slow, hence the rating below the HPET.
+
+        Refer:
+        https://wiki.osdev.org/ACPI_Timer
+        ACPI Specification 6.4, Section 4.8.3.3 (Power Management Timer)
+    */
+
+    AcpiDef::Fadt* Fadt = AcpiProvider::Fadt;
+    if (!Fadt)
+        return Status::ERROR;
+
+    /* The Extended Block is Preferred, if the Table is long enough to have it */
+    u64 ExEnd = (u64)&Fadt->ExPmTimerBlock + sizeof(Fadt->ExPmTimerBlock) - (u64)Fadt;
+    AcpiDef::GenericAddressStructure* ExBlock = &Fadt->ExPmTimerBlock;
+
+    if (Fadt->Header.Length >= ExEnd && ExBlock->Address) {
+        if (ExBlock->AddressSpace == ACPI_GAS_SYSTEMIO)
+            Port = (u16)ExBlock->Address;
+        else if (ExBlock->AddressSpace == ACPI_GAS_SYSTEMMEMORY)
+            Address = (volatile u32*)VirtualMemory::HardwareRemap(
+                (PhysicalMemory::PhysicalAddress*)ExBlock->Address, sizeof(u32));
+    }
+
+    else if (Fadt->PmTimerBlock && Fadt->PmTimerLength == 4)
+        Port = (u16)Fadt->PmTimerBlock;
+
+    if (!Port && !Address)
+        return Status::ERROR;
+
+    Clock.Name = "acpi_pm";
+    Clock.Rating = PMTIMER_RATING;
+    Clock.Read = ReadClock;
+    Clock.Mask = (Fadt->Flags & ACPI_FADT_TMRVALEXT) ? PMTIMER_MASK32 : PMTIMER_MASK24;
+    ClockSource::SetFrequency(&Clock, PMTIMER_FREQUENCY);
+    ClockSource::Register(&Clock);
+
+    printf("ACPI PM Timer Bits: ");
+    printf((Clock.Mask == PMTIMER_MASK32) ? 32 : 24);
+    printf("\n");
+
+    return Status::OK;
+}
+
+/// @brief Reads the Counter, Masked to its Width
+u32 PmTimer::ReadCounter()
+{
+    u32 Value = (Port) ? IO::inl(Port) : *Address;
+    return Value & (u32)Clock.Mask;
+}
+
+u64 PmTimer::ReadClock(ClockSource::Source* Src)
+{
+    return ReadCounter();
+}
@@ -0,0 +1,84 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <drivers/hal/hpet.hpp>
+#include <drivers/hal/pit8254.hpp>
+#include <drivers/hal/pmtimer.hpp>
+#include <drivers/hal/refclock.hpp>
+
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::ASM;
+
+/// @brief Busy-Waits for about 1/Hz Seconds on the best Reference Clock
+/// @param Hz Inverse of the Window Length
+/// @return Exact Length of the Window in Nanoseconds, 0 if the Reference is Stuck
+u64 RefClock::Wait(u32 Hz)
+{
+    /*
+        Clocks of unknown rate (TSC, LAPIC timer) are counted across
+        this window. The HPET is preferred as it is read directly
+        and is precise to its period. The ACPI PM timer is present
+        on every ACPI system. PIT channel 2 is the legacy fallback,
+        whose window is only known by its programmed count.
+    */
+
+    u32 Spins = 0;
+    if (Hpet::Available()) {
+        u64 Target = Hpet::Frequency / Hz;
+        u64 Start = Hpet::ReadCounter();
+        u64 Counted;
+
+        while ((Counted = (Hpet::ReadCounter() - Start) & Hpet::Clock.Mask) < Target) {
+            if (++Spins == REFCLOCK_TIMEOUT_SPINS)
+                return 0;
+
+            Cpu::Pause();
+        }
+
+        return (Counted * KERNEL_NSEC_PER_SEC) / Hpet::Frequency;
+    }
+
+    if (PmTimer::Available()) {
+        u64 Target = PMTIMER_FREQUENCY / Hz;
+        u64 Start = PmTimer::ReadCounter();
+        u64 Counted;
+
+        /* Masking handles a Wrap inside the Window */
+        while ((Counted = (PmTimer::ReadCounter() - Start) & PmTimer::Clock.Mask) < Target) {
+            if (++Spins == REFCLOCK_TIMEOUT_SPINS)
+                return 0;
+
+            Cpu::Pause();
+        }
+
+        return (Counted * KERNEL_NSEC_PER_SEC) / PMTIMER_FREQUENCY;
+    }
+
+    u16 Window = PIT8254_FREQUENCY / Hz;
+    Pit8254::StartCountdown(Window);
+
+    while (!Pit8254::CountdownExpired()) {
+        if (++Spins == REFCLOCK_TIMEOUT_SPINS)
+            return 0;
+
+        Cpu::Pause();
+    }
+
+    return ((u64)Window * KERNEL_NSEC_PER_SEC) / PIT8254_FREQUENCY;
+}
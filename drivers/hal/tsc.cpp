@@ -0,0 +1,157 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <drivers/hal/refclock.hpp>
+#include <drivers/hal/tsc.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/time/delay.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::Kernel;
+using namespace tacOS::ASM;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+u64 Tsc::Frequency;
+bool Tsc::Invariant;
+Tsc::Calibration Tsc::Method;
+ClockSource::Source Tsc::Clock;
+
+/// @brief Calibrates the TSC and Registers it as a Clock Source
+/// @return OK if Registered
+Tsc::Status Tsc::Initialize()
+{
+    /*
+        An invariant TSC ticks at a constant rate in every P-, C-
+        and T-state, and is the cheapest clock available (rdtsc
+        takes a few dozen cycles, there is no I/O). Its frequency
+        is reported by CPUID on recent processors. Otherwise it is
+        measured against a reference clock (HPET, PM Timer, else the PIT).
+
+        Refer:
+        Intel SDM Vol. 3B, Section 18.17 (Time-Stamp Counter)
+        Intel SDM Vol. 2A, CPUID Leaves 15H and 16H
+    */
+
+    Invariant = IsInvariant();
+    Frequency = CalibrateCpuid();
+    if (!Frequency) {
+        Method = REFERENCE;
+        Frequency = CalibrateReference();
+    }
+
+    if (!Frequency) {
+        Method = NONE;
+        Logging::LogMessage(Logging::LogLevel::ERROR, "TSC Calibration Failed");
+        return Status::ERROR;
+    }
+
+    if (!Invariant)
+        Logging::LogMessage(Logging::LogLevel::WARNING, "TSC is not Invariant, Rating Lowered");
+
+    /* Short Waits spin on the TSC from here on */
+    Delay::Calibrate(Frequency);
+
+    printf("TSC KHz: ");
+    printf(Frequency / 1000);
+    printf("\n");
+
+    Clock.Name = "tsc";
+    Clock.Rating = (Invariant) ? TSC_RATING_INVARIANT : TSC_RATING_UNSTABLE;
+    Clock.Read = Read;
+    Clock.Mask = ~0ULL;
+    ClockSource::SetFrequency(&Clock, Frequency);
+    ClockSource::Register(&Clock);
+
+    return Status::OK;
+}
+
+/// @brief Checks if the TSC Rate is Constant across Power States
+bool Tsc::IsInvariant()
+{
+    if (Cpu::CpuidMaxLeaf(0x80000000) < TSC_CPUID_LEAF_POWER)
+        return false;
+
+    u32 Eax, Ebx, Ecx, Edx;
+    Cpu::Cpuid(TSC_CPUID_LEAF_POWER, 0, &Eax, &Ebx, &Ecx, &Edx);
+    return Edx & TSC_CPUID_INVARIANT;
+}
+
+/// @brief Reads the TSC Frequency Reported by CPUID
+/// @return Frequency in Hz, or 0 if not Reported
+u64 Tsc::CalibrateCpuid()
+{
+    u32 MaxLeaf = Cpu::CpuidMaxLeaf(0);
+    u32 Eax, Ebx, Ecx, Edx;
+
+    /* Base Frequency in MHz, Used if the Crystal Clock is not Enumerated */
+    u64 BaseMHz = 0;
+    if (MaxLeaf >= TSC_CPUID_LEAF_FREQUENCY) {
+        Cpu::Cpuid(TSC_CPUID_LEAF_FREQUENCY, 0, &Eax, &Ebx, &Ecx, &Edx);
+        BaseMHz = Eax & 0xFFFF;
+    }
+
+    if (MaxLeaf >= TSC_CPUID_LEAF_CRYSTAL) {
+        /* TSC = Crystal * EBX / EAX */
+        Cpu::Cpuid(TSC_CPUID_LEAF_CRYSTAL, 0, &Eax, &Ebx, &Ecx, &Edx);
+        if (Eax && Ebx && Ecx) {
+            Method = CPUID_CRYSTAL;
+            return ((u64)Ecx * Ebx) / Eax;
+        }
+    }
+
+    /* The Base Frequency is the Nominal TSC Rate on Invariant Parts */
+    if (BaseMHz && Invariant) {
+        Method = CPUID_BASE;
+        return BaseMHz * 1000000;
+    }
+
+    return 0;
+}
+
+/// @brief Measures the TSC against the Reference Clock
+/// @return Frequency in Hz, or 0 if the Reference is Stuck
+u64 Tsc::CalibrateReference()
+{
+    u64 BestCycles = 0;
+    u64 BestNs = 0;
+
+    /* An SMI inside the Window inflates the Count, keep the Smallest Rate */
+    for (u32 Run = 0; Run < TSC_CALIBRATION_RUNS; Run++) {
+        u64 Start = Cpu::ReadTscOrdered();
+        u64 WindowNs = RefClock::Wait(TSC_CALIBRATION_HZ);
+        u64 Counted = Cpu::ReadTscOrdered() - Start;
+
+        if (!WindowNs)
+            return 0;
+
+        if (!BestNs || Counted * BestNs < BestCycles * WindowNs) {
+            BestCycles = Counted;
+            BestNs = WindowNs;
+        }
+    }
+
+    return (BestCycles * KERNEL_NSEC_PER_SEC) / BestNs;
+}
+
+u64 Tsc::Read(ClockSource::Source* Src)
+{
+    return Cpu::ReadTscOrdered();
+}
@@ -18,6 +18,7 @@
 
 #include <drivers/hal/virtkbd.hpp>
 #include <drivers/video/vga.hpp>
+#include <kernel/interrupts/intrstat.hpp>
 
 using namespace tacOS::Drivers::HAL;
 using namespace tacOS::Drivers::Video;
@@ -63,6 +64,12 @@ void VirtualKbd::KeyPressed(VKey KeyCode)
         break;
     }
 
+    case VKey::F12: {
+        /* Diagnostics Key (Like SysRq), Dumps Interrupt Statistics */
+        InterruptStats::Dump();
+        break;
+    }
+
     default: {
         /* Get ASCII Code for current Virtual Key Code */
         u8 AsciiCode = AsciiKeycodeMap[KeyCode];
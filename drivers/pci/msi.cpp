@@ -0,0 +1,409 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <drivers/pci/msi.hpp>
+#include <kernel/mem/bootmem.hpp>
+#include <kernel/mem/virtualmm.hpp>
+#include <kernel/smp/isolation.hpp>
+#include <kernel/smp/smp.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Drivers::PCI;
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools::KernelRTL;
+
+/// @brief Disables legacy INTx Signaling and enables Bus Mastering
+/// @param Dev PCI Function Location
+static void PrepareMessageSignaling(PciDef::Device Dev)
+{
+    /*
+        Messages are memory writes issued by the function, so it
+        must be allowed to master the bus. INTx is disabled such
+        that the function never asserts a shared legacy line.
+    */
+
+    u16 Command = PciDef::ConfigRead16(Dev, PCI_REG_COMMAND);
+    Command |= (PCI_COMMAND_BUSMASTER | PCI_COMMAND_MEMORY | PCI_COMMAND_INTXDISABLE);
+    PciDef::ConfigWrite16(Dev, PCI_REG_COMMAND, Command);
+}
+
+/// @brief Picks the Processor a Message is Delivered to
+/// @param Cpu [in/out] Requested Logical CPU Index, Replaced by the Receiving one
+/// @return ERROR if no Housekeeping Processor is Addressable
+Msi::Status Msi::SelectTarget(u32* Cpu)
+{
+    /*
+        Without interrupt remapping, the message address carries an
+        8-bit destination ID. Processors with larger (x2APIC) IDs
+        cannot receive messages, the first addressable housekeeping
+        processor takes them instead. Masking the ID would deliver
+        the vector to whichever processor owns the truncated ID.
+
+        Refer:
+        Intel SDM Vol. 3A, Section 11.11.1 (Message Address Register Format)
+    */
+
+    u32 Target = Isolation::IrqCpu(*Cpu);
+    if (Smp::GetApicId(Target) > MSI_ADDRESS_MAXDESTID) {
+        Target = KERNEL_SMP_MAXCPUS;
+        for (u32 Candidate = 0; Candidate < Smp::CpuCount; Candidate++) {
+            if (Isolation::IsHousekeeping(Candidate) && Smp::GetApicId(Candidate) <= MSI_ADDRESS_MAXDESTID) {
+                Target = Candidate;
+                break;
+            }
+        }
+
+        if (Target == KERNEL_SMP_MAXCPUS)
+            return Status::ERROR;
+    }
+
+    *Cpu = Target;
+    return Status::OK;
+}
+
+/// @brief Parses the MSI Capability of a PCI Function
+/// @param Dev PCI Function Location
+/// @param Info [out] Parsed Capability Information
+/// @return OK if the Function supports MSI
+Msi::Status Msi::ParseMsi(PciDef::Device Dev, MsiInfo* Info)
+{
+    /*
+        The MSI capability holds a single message address and data
+        pair. A function may request multiple messages, but those
+        have to be a naturally aligned block of vectors. We only
+        ever enable a single message (MME = 0), multi-queue devices
+        are expected to use MSI-X instead.
+
+        Refer:
+        https://wiki.osdev.org/PCI#Message_Signaled_Interrupts
+        PCI Local Bus Specification 3.0, Section 6.8.1
+    */
+
+    u8 CapOffset = PciDef::FindCapability(Dev, PCI_CAP_ID_MSI);
+    if (!CapOffset)
+        return Status::ERROR;
+
+    u16 Control = PciDef::ConfigRead16(Dev, CapOffset + MSI_REG_CONTROL);
+    Info->Device = Dev;
+    Info->CapOffset = CapOffset;
+    Info->Is64Bit = (Control & MSI_CONTROL_64BIT);
+    Info->PerVectorMask = (Control & MSI_CONTROL_PERVECTORMASK);
+    Info->Cpu = 0;
+    Info->Vector = 0;
+
+    return Status::OK;
+}
+
+/// @brief Programs and Enables MSI delivery to a Processor
+/// @param Info Parsed MSI Capability
+/// @param Cpu Logical CPU Index receiving the Interrupt, Steered off Isolated and Unaddressable ones
+/// @param Routine Handler bound to the allocated Vector
+/// @param Context Opaque pointer passed to the Handler
+/// @return OK if Enabled
+Msi::Status Msi::EnableMsi(MsiInfo* Info, u32 Cpu, Interrupt::Handler Routine, void* Context)
+{
+    if (SelectTarget(&Cpu) != Status::OK)
+        return Status::ERROR;
+
+    u8 Vector = Interrupt::AllocateVector(Cpu);
+    if (!Vector)
+        return Status::ERROR;
+
+    /* Edge-Triggered, so the Handler may run Nested below the Timer and IPIs */
+    if (!Interrupt::BindHandler(Cpu, Vector, Routine, Context, true)) {
+        Interrupt::FreeVector(Cpu, Vector);
+        return Status::ERROR;
+    }
+
+    Info->Cpu = Cpu;
+    Info->Vector = Vector;
+
+    /* Program Address and Data while the Capability is Disabled */
+    PciDef::Device Dev = Info->Device;
+    u8 CapOffset = Info->CapOffset;
+    u16 Control = PciDef::ConfigRead16(Dev, CapOffset + MSI_REG_CONTROL);
+    Control &= ~(MSI_CONTROL_ENABLE | MSI_CONTROL_MMEMASK);
+    PciDef::ConfigWrite16(Dev, CapOffset + MSI_REG_CONTROL, Control);
+
+    PciDef::ConfigWrite32(Dev, CapOffset + MSI_REG_ADDRLOW, ComposeAddress(Smp::GetApicId(Cpu)));
+    if (Info->Is64Bit) {
+        PciDef::ConfigWrite32(Dev, CapOffset + MSI_REG_ADDRHIGH, 0);
+        PciDef::ConfigWrite16(Dev, CapOffset + MSI_REG_DATA64, ComposeData(Vector));
+    } else {
+        PciDef::ConfigWrite16(Dev, CapOffset + MSI_REG_DATA32, ComposeData(Vector));
+    }
+
+    /* Enable Message Signaling */
+    PrepareMessageSignaling(Dev);
+    PciDef::ConfigWrite16(Dev, CapOffset + MSI_REG_CONTROL, Control | MSI_CONTROL_ENABLE);
+    UnmaskMsi(Info);
+
+    return Status::OK;
+}
+
+/// @brief Moves MSI Delivery to another Processor
+/// @param Info Enabled MSI Capability
+/// @param Cpu Logical CPU Index receiving the Interrupt, Steered off Isolated and Unaddressable ones
+/// @return OK if Moved
+Msi::Status Msi::SetMsiAffinity(MsiInfo* Info, u32 Cpu)
+{
+    /*
+        The handler is bound to a vector on the new processor before
+        the message is retargeted, and the old vector is freed after.
+        A message already in flight to the old one is counted as
+        spurious there. Functions without per-vector masking may
+        send one between the address and data writes, it's then
+        spurious on the new processor.
+    */
+
+    if (SelectTarget(&Cpu) != Status::OK)
+        return Status::ERROR;
+
+    if (!Info->Vector || Cpu == Info->Cpu)
+        return Status::OK;
+
+    Interrupt::VectorEntry* Old = &Interrupt::VectorTables[Info->Cpu]->Entries[Info->Vector];
+    u8 Vector = Interrupt::AllocateVector(Cpu);
+    if (!Vector)
+        return Status::ERROR;
+
+    if (!Interrupt::BindHandler(Cpu, Vector, Old->Routine, Old->Context, true)) {
+        Interrupt::FreeVector(Cpu, Vector);
+        return Status::ERROR;
+    }
+
+    MaskMsi(Info);
+    PciDef::ConfigWrite32(Info->Device, Info->CapOffset + MSI_REG_ADDRLOW, ComposeAddress(Smp::GetApicId(Cpu)));
+    PciDef::ConfigWrite16(Info->Device, Info->CapOffset + (Info->Is64Bit ? MSI_REG_DATA64 : MSI_REG_DATA32), ComposeData(Vector));
+    UnmaskMsi(Info);
+
+    Interrupt::FreeVector(Info->Cpu, Info->Vector);
+    Info->Cpu = Cpu;
+    Info->Vector = Vector;
+    return Status::OK;
+}
+
+/// @brief Disables MSI and releases its Vector
+/// @param Info Parsed MSI Capability
+void Msi::DisableMsi(MsiInfo* Info)
+{
+    u16 Control = PciDef::ConfigRead16(Info->Device, Info->CapOffset + MSI_REG_CONTROL);
+    PciDef::ConfigWrite16(Info->Device, Info->CapOffset + MSI_REG_CONTROL, Control & ~MSI_CONTROL_ENABLE);
+
+    if (Info->Vector) {
+        Interrupt::FreeVector(Info->Cpu, Info->Vector);
+        Info->Vector = 0;
+    }
+}
+
+/// @brief Masks the MSI Message (Per-Vector Masking Capable Functions)
+/// @param Info Parsed MSI Capability
+void Msi::MaskMsi(MsiInfo* Info)
+{
+    if (!Info->PerVectorMask)
+        return;
+
+    u8 MaskOffset = Info->CapOffset + (Info->Is64Bit ? MSI_REG_MASK64 : MSI_REG_MASK32);
+    u32 Mask = PciDef::ConfigRead32(Info->Device, MaskOffset);
+    PciDef::ConfigWrite32(Info->Device, MaskOffset, Mask | 1);
+}
+
+/// @brief Unmasks the MSI Message (Per-Vector Masking Capable Functions)
+/// @param Info Parsed MSI Capability
+void Msi::UnmaskMsi(MsiInfo* Info)
+{
+    if (!Info->PerVectorMask)
+        return;
+
+    u8 MaskOffset = Info->CapOffset + (Info->Is64Bit ? MSI_REG_MASK64 : MSI_REG_MASK32);
+    u32 Mask = PciDef::ConfigRead32(Info->Device, MaskOffset);
+    PciDef::ConfigWrite32(Info->Device, MaskOffset, Mask & ~1U);
+}
+
+/// @brief Parses the MSI-X Capability and maps its Tables
+/// @param Dev PCI Function Location
+/// @param Info [out] Parsed Capability Information
+/// @return OK if the Function supports MSI-X
+Msi::Status Msi::ParseMsiX(PciDef::Device Dev, MsiXInfo* Info)
+{
+    /*
+        Unlike MSI, every MSI-X vector has its own address, data
+        and mask in a table that lives in memory space behind one
+        of the function's BARs. The Table Offset/BIR register tells
+        which BAR (low 3 bits) and the offset into it. The Pending
+        Bit Array (PBA) is located the same way.
+
+        Refer:
+        https://wiki.osdev.org/PCI#Enabling_MSI-X
+        PCI Local Bus Specification 3.0, Section 6.8.2
+    */
+
+    u8 CapOffset = PciDef::FindCapability(Dev, PCI_CAP_ID_MSIX);
+    if (!CapOffset)
+        return Status::ERROR;
+
+    u16 Control = PciDef::ConfigRead16(Dev, CapOffset + MSIX_REG_CONTROL);
+    u32 TableReg = PciDef::ConfigRead32(Dev, CapOffset + MSIX_REG_TABLE);
+    u32 PbaReg = PciDef::ConfigRead32(Dev, CapOffset + MSIX_REG_PBA);
+
+    u64 TableBase = PciDef::GetBarAddress(Dev, TableReg & MSIX_BIR_MASK);
+    u64 PbaBase = PciDef::GetBarAddress(Dev, PbaReg & MSIX_BIR_MASK);
+    if (!TableBase || !PbaBase)
+        return Status::ERROR;
+
+    /* Bindings are Recorded, Unbinding doesn't Depend on where Steering would Pick now */
+    u64 BindingsSize = ((Control & MSIX_CONTROL_TABLESIZE) + 1) * sizeof(MsiXBinding);
+    Info->Bindings = (MsiXBinding*)BootMem::VirtAllocateBlock(BootMem::AlignAddressToPage(BindingsSize) / KERNEL_BOOTMEM_PMMGR_BLOCKSIZE);
+    if (!Info->Bindings)
+        return Status::ERROR;
+
+    memset(Info->Bindings, 0, BindingsSize);
+    Info->Device = Dev;
+    Info->CapOffset = CapOffset;
+    Info->TableSize = (Control & MSIX_CONTROL_TABLESIZE) + 1;
+
+    /* Map the Vector Table and PBA (Tables may span multiple pages) */
+    u64 TableAddress = TableBase + (TableReg & ~MSIX_BIR_MASK);
+    u64 PbaAddress = PbaBase + (PbaReg & ~MSIX_BIR_MASK);
+    Info->Table = (volatile u32*)VirtualMemory::HardwareRemap(
+        (PhysicalMemory::PhysicalAddress*)TableAddress, Info->TableSize * MSIX_ENTRY_SIZE);
+    Info->PendingBits = (volatile u32*)VirtualMemory::HardwareRemap(
+        (PhysicalMemory::PhysicalAddress*)PbaAddress, ((Info->TableSize + 63) / 64) * 8);
+
+    return Status::OK;
+}
+
+/// @brief Enables MSI-X with every Vector Masked
+/// @param Info Parsed MSI-X Capability
+/// @return OK if Enabled
+Msi::Status Msi::EnableMsiX(MsiXInfo* Info)
+{
+    /*
+        The Function Mask is held while the capability is enabled
+        so no message can be sent from a half-programmed entry.
+        Entries are then individually masked, and drivers unmask
+        them as they're bound with BindMsiXEntry().
+    */
+
+    PciDef::Device Dev = Info->Device;
+    u8 ControlOffset = Info->CapOffset + MSIX_REG_CONTROL;
+    u16 Control = PciDef::ConfigRead16(Dev, ControlOffset);
+
+    PrepareMessageSignaling(Dev);
+    PciDef::ConfigWrite16(Dev, ControlOffset, Control | MSIX_CONTROL_ENABLE | MSIX_CONTROL_FUNCMASK);
+
+    for (u16 Entry = 0; Entry < Info->TableSize; Entry++)
+        MaskMsiXEntry(Info, Entry);
+
+    PciDef::ConfigWrite16(Dev, ControlOffset, (Control | MSIX_CONTROL_ENABLE) & ~MSIX_CONTROL_FUNCMASK);
+    return Status::OK;
+}
+
+/// @brief Disables MSI-X for the Function
+/// @param Info Parsed MSI-X Capability
+void Msi::DisableMsiX(MsiXInfo* Info)
+{
+    u8 ControlOffset = Info->CapOffset + MSIX_REG_CONTROL;
+    u16 Control = PciDef::ConfigRead16(Info->Device, ControlOffset);
+    PciDef::ConfigWrite16(Info->Device, ControlOffset, Control & ~MSIX_CONTROL_ENABLE);
+}
+
+/// @brief Binds an MSI-X Table Entry to a Vector local to a Processor
+/// @param Info Parsed MSI-X Capability
+/// @param Entry MSI-X Table Index
+/// @param Cpu Logical CPU Index receiving the Interrupt, Steered off Isolated and Unaddressable ones
+/// @param Routine Handler bound to the allocated Vector
+/// @param Context Opaque pointer passed to the Handler
+/// @return OK if Bound
+Msi::Status Msi::BindMsiXEntry(MsiXInfo* Info, u16 Entry, u32 Cpu, Interrupt::Handler Routine, void* Context)
+{
+    /*
+        Each entry gets a vector from the target processor's own
+        vector space. Multi-queue drivers bind queue N to CPU N
+        such that completions are handled where they're consumed.
+        The entry stays masked while its address/data are written.
+        Queues of isolated processors are served by the nearest
+        housekeeping one. Binding a bound entry again moves it, the
+        old vector is freed once the entry points elsewhere.
+    */
+
+    if (Entry >= Info->TableSize)
+        return Status::ERROR;
+
+    if (SelectTarget(&Cpu) != Status::OK)
+        return Status::ERROR;
+
+    u8 Vector = Interrupt::AllocateVector(Cpu);
+    if (!Vector)
+        return Status::ERROR;
+
+    /* Edge-Triggered, so the Handler may run Nested below the Timer and IPIs */
+    if (!Interrupt::BindHandler(Cpu, Vector, Routine, Context, true)) {
+        Interrupt::FreeVector(Cpu, Vector);
+        return Status::ERROR;
+    }
+
+    volatile u32* TableEntry = Info->Table + (Entry * (MSIX_ENTRY_SIZE / 4));
+    MaskMsiXEntry(Info, Entry);
+    TableEntry[MSIX_ENTRY_ADDRLOW] = ComposeAddress(Smp::GetApicId(Cpu));
+    TableEntry[MSIX_ENTRY_ADDRHIGH] = 0;
+    TableEntry[MSIX_ENTRY_DATA] = ComposeData(Vector);
+    UnmaskMsiXEntry(Info, Entry);
+
+    MsiXBinding* Binding = &Info->Bindings[Entry];
+    if (Binding->Vector)
+        Interrupt::FreeVector(Binding->Cpu, Binding->Vector);
+
+    Binding->Cpu = Cpu;
+    Binding->Vector = Vector;
+    return Status::OK;
+}
+
+/// @brief Masks an MSI-X Entry and releases its Vector
+/// @param Info Parsed MSI-X Capability
+/// @param Entry MSI-X Table Index
+void Msi::UnbindMsiXEntry(MsiXInfo* Info, u16 Entry)
+{
+    if (Entry >= Info->TableSize || !Info->Bindings[Entry].Vector)
+        return;
+
+    MaskMsiXEntry(Info, Entry);
+    MsiXBinding* Binding = &Info->Bindings[Entry];
+    Interrupt::FreeVector(Binding->Cpu, Binding->Vector);
+    Binding->Vector = 0;
+}
+
+/// @brief Masks a single MSI-X Vector
+void Msi::MaskMsiXEntry(MsiXInfo* Info, u16 Entry)
+{
+    volatile u32* TableEntry = Info->Table + (Entry * (MSIX_ENTRY_SIZE / 4));
+    TableEntry[MSIX_ENTRY_CONTROL] |= MSIX_ENTRY_CONTROL_MASKED;
+}
+
+/// @brief Unmasks a single MSI-X Vector
+void Msi::UnmaskMsiXEntry(MsiXInfo* Info, u16 Entry)
+{
+    volatile u32* TableEntry = Info->Table + (Entry * (MSIX_ENTRY_SIZE / 4));
+    TableEntry[MSIX_ENTRY_CONTROL] &= ~MSIX_ENTRY_CONTROL_MASKED;
+}
+
+/// @brief Checks if a masked MSI-X Vector has a Message Pending
+bool Msi::IsMsiXEntryPending(MsiXInfo* Info, u16 Entry)
+{
+    return Info->PendingBits[Entry / 32] & (1U << (Entry % 32));
+}
@@ -0,0 +1,130 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/io.hpp>
+#include <drivers/pci/pcidef.hpp>
+
+using namespace tacOS::Drivers::PCI;
+using namespace tacOS::ASM;
+
+/// @brief Builds a Configuration Address for Mechanism #1
+/// @param Dev PCI Function Location
+/// @param Offset Register Offset (Dword Aligned)
+/// @return Value for the CONFIG_ADDRESS Port
+static inline u32 ConfigAddress(PciDef::Device Dev, u8 Offset)
+{
+    /*
+        Bit 31 enables configuration cycles, bits 23-16 select the
+        bus, 15-11 the device, 10-8 the function and 7-2 the dword
+        register. The two lowest bits are always zero.
+
+        Refer:
+        https://wiki.osdev.org/PCI#Configuration_Space_Access_Mechanism_.231
+    */
+
+    return PCI_CONFIG_ENABLE
+        | ((u32)Dev.Bus << 16)
+        | ((u32)(Dev.Slot & 0x1F) << 11)
+        | ((u32)(Dev.Function & 0x07) << 8)
+        | (Offset & 0xFC);
+}
+
+/// @brief Reads a Dword from Configuration Space
+u32 PciDef::ConfigRead32(Device Dev, u8 Offset)
+{
+    IO::outl(PCI_CONFIG_ADDRESS, ConfigAddress(Dev, Offset));
+    return IO::inl(PCI_CONFIG_DATA);
+}
+
+/// @brief Reads a Word from Configuration Space
+u16 PciDef::ConfigRead16(Device Dev, u8 Offset)
+{
+    IO::outl(PCI_CONFIG_ADDRESS, ConfigAddress(Dev, Offset));
+    return IO::inw(PCI_CONFIG_DATA + (Offset & 0x02));
+}
+
+/// @brief Reads a Byte from Configuration Space
+u8 PciDef::ConfigRead8(Device Dev, u8 Offset)
+{
+    IO::outl(PCI_CONFIG_ADDRESS, ConfigAddress(Dev, Offset));
+    return IO::inb(PCI_CONFIG_DATA + (Offset & 0x03));
+}
+
+/// @brief Writes a Dword to Configuration Space
+void PciDef::ConfigWrite32(Device Dev, u8 Offset, u32 Value)
+{
+    IO::outl(PCI_CONFIG_ADDRESS, ConfigAddress(Dev, Offset));
+    IO::outl(PCI_CONFIG_DATA, Value);
+}
+
+/// @brief Writes a Word to Configuration Space
+void PciDef::ConfigWrite16(Device Dev, u8 Offset, u16 Value)
+{
+    IO::outl(PCI_CONFIG_ADDRESS, ConfigAddress(Dev, Offset));
+    IO::outw(PCI_CONFIG_DATA + (Offset & 0x02), Value);
+}
+
+/// @brief Walks the Capability List of a PCI Function
+/// @param Dev PCI Function Location
+/// @param CapabilityId Capability to look for
+/// @return Configuration Space Offset of the Capability or 0 (if absent)
+u8 PciDef::FindCapability(Device Dev, u8 CapabilityId)
+{
+    /*
+        If bit 4 of the Status Register is set, the Capabilities
+        Pointer (0x34) holds the offset of the first entry of a
+        linked list. Each entry starts with its ID byte followed
+        by the offset of the next entry. The list is bounded to
+        guard against malformed (looping) lists.
+
+        Refer:
+        https://wiki.osdev.org/PCI#Capabilities_List
+    */
+
+    if (!(ConfigRead16(Dev, PCI_REG_STATUS) & PCI_STATUS_CAPLIST))
+        return 0;
+
+    u8 CapOffset = ConfigRead8(Dev, PCI_REG_CAPPTR) & 0xFC;
+    for (u8 Hops = 0; CapOffset && Hops < 48; Hops++) {
+        if (ConfigRead8(Dev, CapOffset) == CapabilityId)
+            return CapOffset;
+
+        CapOffset = ConfigRead8(Dev, CapOffset + 1) & 0xFC;
+    }
+
+    return 0;
+}
+
+/// @brief Decodes the Physical Address of a Memory BAR
+/// @param Dev PCI Function Location
+/// @param Bar Base Address Register Index (0-5)
+/// @return Physical Base Address or 0 (for I/O Space BARs)
+u64 PciDef::GetBarAddress(Device Dev, u8 Bar)
+{
+    u8 BarOffset = PCI_REG_BAR0 + (Bar * 4);
+    u32 BarLow = ConfigRead32(Dev, BarOffset);
+
+    if (BarLow & PCI_BAR_IOSPACE)
+        return 0;
+
+    u64 Address = BarLow & ~0xFULL;
+    if ((BarLow & PCI_BAR_TYPEMASK) == PCI_BAR_TYPE64)
+        Address |= ((u64)ConfigRead32(Dev, BarOffset + 4)) << 32;
+
+    return Address;
+}
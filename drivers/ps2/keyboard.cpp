@@ -16,11 +16,17 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <asm/io.hpp>
 #include <drivers/ps2/keyboard.hpp>
+#include <drivers/hal/pic8259.hpp>
 #include <drivers/hal/virtkbd.hpp>
 
 using namespace tacOS::Drivers::PS2;
 using namespace tacOS::Drivers::HAL;
+using namespace tacOS::ASM;
+
+/* Define Statics */
+InterruptPoll::PollContext Keyboard::PollCtx;
 
 /// @brief PS/2 Keyboard Scan Code Set 01
 static const VirtualKbd::VKey ScanCodeS1[512] = {
@@ -377,9 +383,63 @@ static const VirtualKbd::VKey ScanCodeS2[512] = {
     VirtualKbd::VKey::F7
 };
 
-/// @brief Handle PS/2 Keyboard Interrupts, Translate to VKey Inputs.
+/// @brief Initializes the PS/2 Keyboard Driver
+void Keyboard::Initialize()
+{
+    /* Opt in to Interrupt/Polling Hybrid Mode */
+    InterruptPoll::Register(&PollCtx, Poll, DisableIrq, EnableIrq, 0);
+    PollCtx.HasPending = HasPending;
+}
+
+/// @brief Top Half of PS/2 Keyboard Interrupts, Switches to Polling.
+void Keyboard::KeyboardInterrupt()
+{
+    /*
+        The first scan code of a burst masks IRQ 1 and schedules
+        the controller for polling. Scan codes are then read in
+        batches by the bottom half, with interrupts enabled, till
+        the controller's output buffer is empty.
+    */
+
+    InterruptPoll::Schedule(&PollCtx);
+}
+
+/// @brief Polls the PS/2 Controller for Scan Codes
+/// @param Context Keyboard Polling Context
+/// @param Budget Maximum number of Scan Codes to Process
+/// @return Number of Scan Codes Processed
+u32 Keyboard::Poll(InterruptPoll::PollContext* Context, u32 Budget)
+{
+    u32 Processed = 0;
+    while (Processed < Budget && HasPending(Context)) {
+        ProcessScanCode(IO::inb(PS2_DATA_PORT));
+        Processed++;
+    }
+
+    return Processed;
+}
+
+/// @brief Checks if the Controller holds an unread Scan Code
+bool Keyboard::HasPending(InterruptPoll::PollContext* Context)
+{
+    return (IO::inb(PS2_STATUS_PORT) & PS2_STATUS_OUTPUTFULL);
+}
+
+/// @brief Masks the Keyboard IRQ Line
+void Keyboard::DisableIrq(InterruptPoll::PollContext* Context)
+{
+    Pic8259::MaskIrq(Pic8259::Irq::KEYBOARD);
+}
+
+/// @brief Unmasks the Keyboard IRQ Line
+void Keyboard::EnableIrq(InterruptPoll::PollContext* Context)
+{
+    Pic8259::UnmaskIrq(Pic8259::Irq::KEYBOARD);
+}
+
+/// @brief Translate PS/2 Scan Codes to VKey Inputs.
 /// @param ScanCode Scan Code obtained from PS/2 Controller
-void Keyboard::KeyboardInterrupt(u8 ScanCode)
+void Keyboard::ProcessScanCode(u8 ScanCode)
 {
     /*
         This routine handles converting PS/2 Keyboard inputs,
@@ -395,4 +455,4 @@ void Keyboard::KeyboardInterrupt(u8 ScanCode)
 
     if ((ScanCode & 128) != 128)
         VirtualKbd::KeyPressed(Code);
-}
\ No newline at end of file
+}
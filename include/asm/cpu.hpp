@@ -0,0 +1,205 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASM_CPU_HPP
+#define ASM_CPU_HPP
+
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define ASM_CPU_RFLAGS_IF (1 << 9) /* Interrupt Enable Flag */
+#define ASM_CPU_CR0_TS (1 << 3) /* Task Switched, Extended State use Faults (#NM) */
+
+#define ASM_CPU_MSR_APICBASE 0x1B
+#define ASM_CPU_MSR_GSBASE 0xC0000101
+
+namespace tacOS {
+namespace ASM {
+    /// @brief Contains x86 Assembly Helpers for Processor Control
+    class Cpu {
+    public:
+        /// @brief Clears the Interrupt Flag
+        static inline void DisableInterrupts()
+        {
+            __asm__ volatile("cli" : : : "memory");
+        }
+
+        /// @brief Sets the Interrupt Flag
+        static inline void EnableInterrupts()
+        {
+            __asm__ volatile("sti" : : : "memory");
+        }
+
+        /// @brief Saves RFLAGS, then Clears the Interrupt Flag
+        /// @return Saved RFLAGS, to be passed to RestoreFlags()
+        static inline u64 SaveFlagsAndDisable()
+        {
+            u64 Flags;
+            __asm__ volatile(
+                "pushfq\n"
+                "pop %0\n"
+                "cli"
+                : "=r"(Flags)
+                :
+                : "memory");
+
+            return Flags;
+        }
+
+        /// @brief Restores the Interrupt Flag saved by SaveFlagsAndDisable()
+        /// @param Flags Previously Saved RFLAGS
+        static inline void RestoreFlags(u64 Flags)
+        {
+            if (Flags & ASM_CPU_RFLAGS_IF)
+                EnableInterrupts();
+        }
+
+        /// @brief Checks if Interrupts are Enabled on this Processor
+        static inline bool InterruptsEnabled()
+        {
+            u64 Flags;
+            __asm__ volatile("pushfq; pop %0" : "=r"(Flags));
+            return (Flags & ASM_CPU_RFLAGS_IF);
+        }
+
+        /// @brief Enables Interrupts and Halts till the next one
+        static inline void EnableInterruptsAndHalt()
+        {
+            /* sti delays recognition by one instruction, no wakeup is lost */
+            __asm__ volatile("sti; hlt" : : : "memory");
+        }
+
+        /// @brief Arms Address Monitoring for a following Mwait()
+        /// @param Address Address within the Monitored Line
+        static inline void Monitor(const volatile void* Address)
+        {
+            __asm__ volatile("monitor" : : "a"(Address), "c"(0), "d"(0) : "memory");
+        }
+
+        /// @brief Waits for a Write to the Monitored Line, or an Interrupt
+        /// @param Hint Target C-State and Sub-State (EAX)
+        /// @param Extensions MWAIT Extensions (ECX)
+        static inline void Mwait(u32 Hint, u32 Extensions)
+        {
+            __asm__ volatile("mwait" : : "a"(Hint), "c"(Extensions) : "memory");
+        }
+
+        /// @brief Enables Interrupts and Waits on the Monitored Line
+        /// @param Hint Target C-State and Sub-State (EAX)
+        static inline void EnableInterruptsAndMwait(u32 Hint)
+        {
+            /* As with sti; hlt, an Interrupt after sti still Ends the Wait */
+            __asm__ volatile("sti; mwait" : : "a"(Hint), "c"(0) : "memory");
+        }
+
+        /// @brief Reads the Time Stamp Counter
+        /// @return Current TSC Value (Cycles)
+        static inline u64 ReadTsc()
+        {
+            u32 Low, High;
+            __asm__ volatile("rdtsc" : "=a"(Low), "=d"(High));
+            return ((u64)High << 32) | Low;
+        }
+
+        /// @brief Reads the Time Stamp Counter after Prior Instructions Complete
+        /// @return Current TSC Value (Cycles)
+        static inline u64 ReadTscOrdered()
+        {
+            /* LFENCE keeps rdtsc from executing ahead of earlier loads */
+            u32 Low, High;
+            __asm__ volatile("lfence; rdtsc" : "=a"(Low), "=d"(High) : : "memory");
+            return ((u64)High << 32) | Low;
+        }
+
+        /// @brief Executes CPUID
+        /// @param Leaf Value of EAX
+        /// @param SubLeaf Value of ECX
+        static inline void Cpuid(u32 Leaf, u32 SubLeaf, u32* Eax, u32* Ebx, u32* Ecx, u32* Edx)
+        {
+            __asm__ volatile("cpuid"
+                             : "=a"(*Eax), "=b"(*Ebx), "=c"(*Ecx), "=d"(*Edx)
+                             : "a"(Leaf), "c"(SubLeaf));
+        }
+
+        /// @brief Returns the Highest Supported CPUID Leaf of a Range
+        /// @param Base 0 for Standard Leaves, 0x80000000 for Extended Leaves
+        static inline u32 CpuidMaxLeaf(u32 Base)
+        {
+            u32 Eax, Ebx, Ecx, Edx;
+            Cpuid(Base, 0, &Eax, &Ebx, &Ecx, &Edx);
+            return Eax;
+        }
+
+        /// @brief Reads a Model Specific Register
+        /// @param Msr Register Index (ECX)
+        static inline u64 ReadMsr(u32 Msr)
+        {
+            u32 Low, High;
+            __asm__ volatile("rdmsr" : "=a"(Low), "=d"(High) : "c"(Msr));
+            return ((u64)High << 32) | Low;
+        }
+
+        /// @brief Writes a Model Specific Register
+        /// @param Msr Register Index (ECX)
+        /// @param Value Value to be Written
+        static inline void WriteMsr(u32 Msr, u64 Value)
+        {
+            __asm__ volatile("wrmsr" : : "c"(Msr), "a"((u32)Value), "d"((u32)(Value >> 32)) : "memory");
+        }
+
+        /// @brief Reads Control Register 0
+        static inline u64 ReadCr0()
+        {
+            u64 Value;
+            __asm__ volatile("mov %%cr0, %0" : "=r"(Value));
+            return Value;
+        }
+
+        /// @brief Writes Control Register 0 (Serializing)
+        /// @param Value Value to be Written
+        static inline void WriteCr0(u64 Value)
+        {
+            __asm__ volatile("mov %0, %%cr0" : : "r"(Value) : "memory");
+        }
+
+        /// @brief Clears CR0.TS without a Control Register Write
+        static inline void ClearTaskSwitched()
+        {
+            __asm__ volatile("clts" : : : "memory");
+        }
+
+        /// @brief Reads an Extended Control Register
+        /// @param Xcr Register Index (ECX), 0 is XCR0
+        static inline u64 ReadXcr(u32 Xcr)
+        {
+            u32 Low, High;
+            __asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(Xcr));
+            return ((u64)High << 32) | Low;
+        }
+
+        /// @brief Spin-loop Hint, reduces power and pipeline flushes
+        static inline void Pause()
+        {
+            __asm__ volatile("pause" : : : "memory");
+        }
+    };
+}
+} // namespace tacOS
+
+#endif
@@ -64,6 +64,42 @@ namespace ASM {
             return input;
         }
 
+        /// @brief Sends a Word as an output to a port
+        /// @param port Defines the Output Port
+        /// @param output Defines the Output Message (2 bytes)
+        static inline void outw(u16 port, u16 output)
+        {
+            __asm__ volatile("outw %w0, %w1" : : "a"(output), "Nd"(port) : "memory");
+        }
+
+        /// @brief Recevies a Word as input from a port
+        /// @param port Defines Input Port
+        /// @return Word read from the Port
+        static inline u16 inw(u16 port)
+        {
+            u16 input;
+            __asm__ volatile("inw %w1, %w0" : "=a"(input) : "Nd"(port) : "memory");
+            return input;
+        }
+
+        /// @brief Sends a Double Word as an output to a port
+        /// @param port Defines the Output Port
+        /// @param output Defines the Output Message (4 bytes)
+        static inline void outl(u16 port, u32 output)
+        {
+            __asm__ volatile("outl %0, %w1" : : "a"(output), "Nd"(port) : "memory");
+        }
+
+        /// @brief Recevies a Double Word as input from a port
+        /// @param port Defines Input Port
+        /// @return Double Word read from the Port
+        static inline u32 inl(u16 port)
+        {
+            u32 input;
+            __asm__ volatile("inl %w1, %0" : "=a"(input) : "Nd"(port) : "memory");
+            return input;
+        }
+
         /// @brief Delay Timer that takes 1 to 4 microseconds.
         static inline void wait()
         {
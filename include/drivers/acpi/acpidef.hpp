@@ -32,6 +32,24 @@ using namespace tacOS::Kernel;
 #define ACPI_SIG_RSDP "RSD PTR "
 #define ACPI_SIG_FADT "FACP"
 #define ACPI_SIG_MADT "APIC"
+#define ACPI_SIG_HPET "HPET"
+#define ACPI_SIG_SRAT "SRAT"
+#define ACPI_SIG_SLIT "SLIT"
+
+/* FADT Fixed Feature Flags */
+#define ACPI_FADT_TMRVALEXT (1 << 8) /* PM Timer is 32 bits wide, else 24 */
+
+/* MADT Processor Local (x2)APIC Flags */
+#define ACPI_MADT_LAPIC_ENABLED (1 << 0)
+#define ACPI_MADT_LAPIC_ONLINECAPABLE (1 << 1) /* Disabled, may be Hot-Added */
+
+/* SRAT Affinity Entry Flags */
+#define ACPI_SRAT_ENABLED (1 << 0) /* Entry is Valid, else Ignored */
+#define ACPI_SRAT_HOTPLUGGABLE (1 << 1) /* Memory may be Hot-Removed */
+
+/* Generic Address Structure Address Spaces */
+#define ACPI_GAS_SYSTEMMEMORY 0
+#define ACPI_GAS_SYSTEMIO 1
 
 namespace tacOS {
 namespace Drivers {
@@ -74,6 +92,12 @@ namespace Drivers {
                 LOCAL_X2APIC = 9
             };
 
+            enum SratEntryType {
+                PROCESSOR_APIC_AFFINITY = 0,
+                MEMORY_AFFINITY = 1,
+                PROCESSOR_X2APIC_AFFINITY = 2
+            };
+
             /// @brief Common Header for all ACPI System Descriptor Tables
             struct SdtHeader {
                 char Signature[4];
@@ -109,7 +133,7 @@ namespace Drivers {
                 u8 BitOffset;
                 u8 AccessSize;
                 u64 Address;
-            };
+            } __attribute__((packed));
 
             /// @brief The Root System Descriptor Pointer Structure
             struct Rsdp {
@@ -340,6 +364,95 @@ namespace Drivers {
                 u32 AcpiId;
             } __attribute__((packed));
 
+            /// @brief High Precision Event Timer Description Table
+            struct Hpet {
+                /*
+                    Describes one HPET block. Only the base address is
+                    needed, the block describes itself through its
+                    General Capabilities register.
+
+                    Refer:
+                    https://wiki.osdev.org/HPET
+                    IA-PC HPET Specification 1.0a, Section 3.2.4
+                */
+
+                SdtHeader Header;
+                u8 HardwareRevisionId;
+                u8 BlockInfo; /* Comparators (4:0), 64-bit Counter (5), Legacy Route (7) */
+                u16 PciVendorId;
+                GenericAddressStructure Address;
+                u8 HpetNumber;
+                u16 MinimumTick; /* Minimum Periodic Tick, in Counter Ticks */
+                u8 PageProtection;
+            } __attribute__((packed));
+
+            /// @brief System Resource Affinity Table
+            struct Srat {
+                /*
+                    Associates processors and memory ranges with proximity
+                    domains (NUMA nodes). Like the MADT, it's followed by
+                    variable length entries, each starting with a type
+                    and length (MadtEntryHeader layout).
+
+                    Refer:
+                    https://uefi.org/htmlspecs/ACPI_Spec_6_4_html/05_ACPI_Software_Programming_Model/ACPI_Software_Programming_Model.html#system-resource-affinity-table-srat
+                */
+
+                SdtHeader Header;
+                u32 TableRevision;
+                u64 Reserved;
+            } __attribute__((packed));
+
+            /// @brief SRAT Processor Local APIC Affinity Entry
+            struct SratProcessorApic {
+                MadtEntryHeader Header;
+                u8 ProximityDomainLow; /* Bits 7:0 */
+                u8 ApicId;
+                u32 Flags;
+                u8 LocalSapicEid;
+                u8 ProximityDomainHigh[3]; /* Bits 31:8 */
+                u32 ClockDomain;
+            } __attribute__((packed));
+
+            /// @brief SRAT Memory Affinity Entry
+            struct SratMemory {
+                MadtEntryHeader Header;
+                u32 ProximityDomain;
+                u16 Reserved;
+                u64 BaseAddress;
+                u64 Length;
+                u32 Reserved2;
+                u32 Flags;
+                u64 Reserved3;
+            } __attribute__((packed));
+
+            /// @brief SRAT Processor Local x2APIC Affinity Entry
+            struct SratProcessorX2Apic {
+                MadtEntryHeader Header;
+                u16 Reserved;
+                u32 ProximityDomain;
+                u32 X2ApicId;
+                u32 Flags;
+                u32 ClockDomain;
+                u32 Reserved2;
+            } __attribute__((packed));
+
+            /// @brief System Locality Information Table
+            struct Slit {
+                /*
+                    A Localities x Localities matrix of relative memory
+                    distances between proximity domains, row major. The
+                    local distance is 10, unreachable is 255.
+
+                    Refer:
+                    https://uefi.org/htmlspecs/ACPI_Spec_6_4_html/05_ACPI_Software_Programming_Model/ACPI_Software_Programming_Model.html#system-locality-information-table-slit
+                */
+
+                SdtHeader Header;
+                u64 Localities;
+                u8 Entries[1];
+            } __attribute__((packed));
+
             static RSDPAddress GetRSDPAddr();
             static Version GetACPIVersion(const Rsdp* XsdpTbl);
             static Status GetTableBySignature(char* Signature, Xsdt* Xsdt, Address* Table);
@@ -32,6 +32,7 @@ namespace Drivers {
             static AcpiDef::RSDPAddress RsdpAddr;
             static AcpiDef::Rsdp* Rsdp;
             static AcpiDef::Xsdt* Xsdt;
+            static AcpiDef::Fadt* Fadt;
 
             static AcpiDef::Status Initialize();
         };
@@ -19,9 +19,54 @@
 #ifndef DRIVERS_HAL_IOAPIC_HPP
 #define DRIVERS_HAL_IOAPIC_HPP
 
+#include <asm/cpu.hpp>
 #include <kernel/types.hpp>
 using namespace tacOS::Kernel;
 
+/*
+    Local APIC Register Offsets (xAPIC, Memory-Mapped).
+    Registers are 32 bits wide and aligned to 16 bytes.
+
+    Refer:
+    https://wiki.osdev.org/APIC#Local_APIC_registers
+    Intel SDM Vol. 3A, Table 11-1 (Local APIC Register Address Map)
+*/
+
+#define APIC_LAPIC_REG_ID 0x020
+#define APIC_LAPIC_REG_VERSION 0x030
+#define APIC_LAPIC_REG_TPR 0x080 /* Task Priority Register */
+#define APIC_LAPIC_REG_EOI 0x0B0
+#define APIC_LAPIC_REG_SVR 0x0F0 /* Spurious Interrupt Vector Register */
+#define APIC_LAPIC_REG_ICRLOW 0x300 /* Interrupt Command Register */
+#define APIC_LAPIC_REG_ICRHIGH 0x310
+
+#define APIC_LAPIC_SVR_ENABLE (1 << 8)
+#define APIC_LAPIC_SPURIOUS_VECTOR 0xFF
+
+#define APIC_LAPIC_ICR_FIXED (0 << 8)
+#define APIC_LAPIC_ICR_NMI (4 << 8)
+#define APIC_LAPIC_ICR_INIT (5 << 8)
+#define APIC_LAPIC_ICR_STARTUP (6 << 8)
+#define APIC_LAPIC_ICR_PENDING (1 << 12) /* Delivery Status (xAPIC Only) */
+#define APIC_LAPIC_ICR_ASSERT (1 << 14)
+#define APIC_LAPIC_ICR_LEVEL (1 << 15)
+
+/*
+    In x2APIC mode, Local APIC registers are MSRs at 0x800 plus
+    the xAPIC offset divided by 16. The ICR becomes one 64-bit
+    MSR and the APIC ID widens to 32 bits.
+
+    Refer:
+    Intel SDM Vol. 3A, Section 11.12 (Extended XAPIC (x2APIC))
+*/
+
+#define APIC_X2APIC_MSR_BASE 0x800
+#define APIC_X2APIC_MSR_ICR 0x830
+#define APIC_X2APIC_MAXXAPICID 0xFE /* Highest ID an xAPIC can Address */
+
+#define APIC_BASE_MSR_X2APIC (1 << 10)
+#define APIC_BASE_MSR_ENABLE (1 << 11)
+
 namespace tacOS {
 namespace Drivers {
     namespace HAL {
@@ -32,7 +77,74 @@ namespace Drivers {
                 OK = 1
             };
 
+            static u32* LocalApicAddr;
+            static bool X2ApicMode;
+
+            /// @brief Reads a Local APIC Register
+            /// @param Register Register Offset from the Local APIC Base
+            static inline u32 ReadLocal(u32 Register)
+            {
+                if (X2ApicMode)
+                    return (u32)ASM::Cpu::ReadMsr(APIC_X2APIC_MSR_BASE + (Register >> 4));
+
+                return *((volatile u32*)((u8*)LocalApicAddr + Register));
+            }
+
+            /// @brief Writes to a Local APIC Register
+            /// @param Register Register Offset from the Local APIC Base
+            /// @param Value Value to be Written
+            static inline void WriteLocal(u32 Register, u32 Value)
+            {
+                if (X2ApicMode) {
+                    ASM::Cpu::WriteMsr(APIC_X2APIC_MSR_BASE + (Register >> 4), Value);
+                    return;
+                }
+
+                *((volatile u32*)((u8*)LocalApicAddr + Register)) = Value;
+            }
+
+            /// @brief Acknowledges the Interrupt currently In-Service
+            static inline void EndOfInterrupt()
+            {
+                WriteLocal(APIC_LAPIC_REG_EOI, 0);
+            }
+
+            /// @brief Returns the Local APIC ID of the Executing Processor
+            static inline u32 GetLocalApicId()
+            {
+                if (X2ApicMode)
+                    return ReadLocal(APIC_LAPIC_REG_ID);
+
+                return (LocalApicAddr) ? (ReadLocal(APIC_LAPIC_REG_ID) >> 24) : 0;
+            }
+
+            /// @brief Sets the Task Priority Class of the Executing Processor
+            /// @param Class Priority Class (Vector >> 4), Vectors at or below it are held
+            static inline void SetTaskPriority(u8 Class)
+            {
+                /*
+                    In 64-bit mode, CR8 is an architectural alias of
+                    TPR[7:4]. Writing it avoids an uncached MMIO store
+                    and is serializing only with respect to delivery.
+
+                    Refer:
+                    Intel SDM Vol. 3A, Section 11.8.6 (Task Priority in IA-32e Mode)
+                */
+
+                __asm__ volatile("mov %0, %%cr8" : : "r"((u64)Class) : "memory");
+            }
+
+            /// @brief Returns the Task Priority Class of the Executing Processor
+            static inline u8 GetTaskPriority()
+            {
+                u64 Class;
+                __asm__ volatile("mov %%cr8, %0" : "=r"(Class));
+                return (u8)Class;
+            }
+
             static Apic::Status Initialize();
+            static void EnableLocalApic();
+            static void SendIpi(u32 ApicId, u32 Command);
         };
     }
 }
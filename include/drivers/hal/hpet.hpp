@@ -0,0 +1,133 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DRIVERS_HAL_HPET_HPP
+#define DRIVERS_HAL_HPET_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/time/clockevt.hpp>
+#include <kernel/time/clocksrc.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+/*
+    HPET Register Offsets (64 bits wide).
+
+    Refer:
+    https://wiki.osdev.org/HPET
+    IA-PC HPET Specification 1.0a, Section 2.3
+*/
+
+#define HPET_REG_CAPABILITIES 0x000
+#define HPET_REG_CONFIG 0x010
+#define HPET_REG_ISR 0x020
+#define HPET_REG_COUNTER 0x0F0
+#define HPET_REG_TIMERCONFIG(N) (0x100 + (0x20 * (N)))
+#define HPET_REG_TIMERCOMPARATOR(N) (0x108 + (0x20 * (N)))
+#define HPET_REG_TIMERFSBROUTE(N) (0x110 + (0x20 * (N)))
+#define HPET_REGISTERS_SIZE 0x400
+
+#define HPET_CAP_COUNTERSIZE (1 << 13)
+#define HPET_CAP_TIMERSSHIFT 8
+#define HPET_CAP_TIMERSMASK 0x1F
+#define HPET_CAP_PERIODSHIFT 32 /* Femtoseconds per Tick */
+
+#define HPET_CONFIG_ENABLE (1 << 0)
+#define HPET_CONFIG_LEGACYROUTE (1 << 1)
+
+#define HPET_TIMER_LEVEL (1 << 1)
+#define HPET_TIMER_ENABLE (1 << 2)
+#define HPET_TIMER_PERIODIC (1 << 3)
+#define HPET_TIMER_PERIODICCAP (1 << 4)
+#define HPET_TIMER_64BITCAP (1 << 5)
+#define HPET_TIMER_VALUESET (1 << 6)
+#define HPET_TIMER_32BITMODE (1 << 8)
+#define HPET_TIMER_FSBENABLE (1 << 14)
+#define HPET_TIMER_FSBCAP (1 << 15)
+
+#define HPET_FEMTOSEC_PER_SEC 1000000000000000ULL
+#define HPET_MAXPERIOD_FS 100000000 /* 10 MHz Minimum Frequency */
+#define HPET_MAXTIMERS 32
+#define HPET_RATING 250
+#define HPET_EVENT_RATING 50 /* Below the LAPIC Timer, used if it Fails */
+#define HPET_MINDELTA_NS 5000
+
+namespace tacOS {
+namespace Drivers {
+    namespace HAL {
+        class Hpet {
+        public:
+            enum Status {
+                ERROR = 0,
+                OK = 1
+            };
+
+            /// @brief Comparator used as a Timer Event Device
+            struct Comparator {
+                ClockEvent::Device Event;
+                u32 Index;
+                u8 Vector;
+                bool InUse;
+                u64 Start; /* Counter when last Programmed */
+                u64 Mask; /* Comparator Width, 32 bits unless 64-bit Capable */
+            };
+
+            static volatile u64* Registers;
+            static u64 Frequency; /* Hz */
+            static u32 TimerCount;
+            static ClockSource::Source Clock;
+            static Comparator Comparators[HPET_MAXTIMERS];
+
+            /// @brief Checks if the HPET is Mapped and Counting
+            static inline bool Available()
+            {
+                return Registers != 0;
+            }
+
+            static inline u64 Read(u32 Register)
+            {
+                return Registers[Register / sizeof(u64)];
+            }
+
+            static inline void Write(u32 Register, u64 Value)
+            {
+                Registers[Register / sizeof(u64)] = Value;
+            }
+
+            static inline u64 ReadCounter()
+            {
+                return Read(HPET_REG_COUNTER);
+            }
+
+            static Status Initialize();
+            static Status InitializeCpu(u32 Cpu);
+
+        private:
+            static u64 ReadClock(ClockSource::Source* Src);
+            static void TimerInterrupt(u8 Vector, void* Context);
+            static void SetPeriodic(ClockEvent::Device* Dev, u64 PeriodNs);
+            static void SetOneShot(ClockEvent::Device* Dev, u64 DeltaNs);
+            static void Shutdown(ClockEvent::Device* Dev);
+            static u64 Elapsed(ClockEvent::Device* Dev);
+        };
+    }
+}
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DRIVERS_HAL_LAPICTIMER_HPP
+#define DRIVERS_HAL_LAPICTIMER_HPP
+
+#include <drivers/hal/apic.hpp>
+#include <kernel/smp/smp.hpp>
+#include <kernel/time/clockevt.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+/*
+    Local APIC Timer Registers.
+
+    Refer:
+    https://wiki.osdev.org/APIC_Timer
+    Intel SDM Vol. 3A, Section 11.5.4 (APIC Timer)
+*/
+
+#define APIC_LAPIC_REG_LVTTIMER 0x320
+#define APIC_LAPIC_REG_TIMERINITIAL 0x380
+#define APIC_LAPIC_REG_TIMERCURRENT 0x390
+#define APIC_LAPIC_REG_TIMERDIVIDE 0x3E0
+
+#define APIC_LAPIC_LVT_MASKED (1 << 16)
+#define APIC_LAPIC_TIMER_PERIODIC (1 << 17)
+#define APIC_LAPIC_TIMER_DIVIDE16 0x3
+
+#define LAPICTIMER_CALIBRATION_RUNS 3
+#define LAPICTIMER_CALIBRATION_HZ 100 /* 10ms Reference Window */
+#define LAPICTIMER_RATING 100
+#define LAPICTIMER_MINDELTA_NS 1000
+
+namespace tacOS {
+namespace Drivers {
+    namespace HAL {
+        class LapicTimer {
+        public:
+            /// @brief Timer State of a single Processor
+            struct CpuTimer {
+                ClockEvent::Device Event;
+                u32 InitialCount; /* Last Programmed Count */
+                u8 Vector;
+            };
+
+            static u64 Frequency; /* Ticks per Second, after the Divider */
+            static CpuTimer Timers[KERNEL_SMP_MAXCPUS];
+
+            static Apic::Status Initialize();
+            static Apic::Status InitializeCpu(u32 Cpu);
+
+        private:
+            static u64 Calibrate();
+            static void TimerInterrupt(u8 Vector, void* Context);
+            static void SetPeriodic(ClockEvent::Device* Dev, u64 PeriodNs);
+            static void SetOneShot(ClockEvent::Device* Dev, u64 DeltaNs);
+            static void Shutdown(ClockEvent::Device* Dev);
+            static u64 Elapsed(ClockEvent::Device* Dev);
+        };
+    }
+}
+}
+
+#endif
@@ -26,6 +26,8 @@ using namespace tacOS::Kernel;
 #define PIC8259_EOI 0x20 /* End of Interrupt Acknowledgement */
 #define PIC8259_ICW1_ICW4 0x01 /* ICW1 message: ICW4 Will Be Present */
 #define PIC8259_ICW4_8086 0x01 /* Set 8086 Mode */
+#define PIC8259_OCW3_READISR 0x0B /* Read In-Service Register */
+#define PIC8259_COMMAND_DELAY_US 2 /* Settle Time after an Initialization Command */
 
 /*
     Define PIC Controller Data and Input Ports
@@ -77,6 +79,9 @@ namespace Drivers {
             static void Initialize();
             static void Disable();
             static void EndOfInterrupt(u8 Code);
+            static bool IsSpurious(u8 InterruptCode);
+            static void MaskIrq(Irq Line);
+            static void UnmaskIrq(Irq Line);
             static void TranslateInterrupt(u8 InterruptCode);
         };
     }
@@ -0,0 +1,58 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DRIVERS_HAL_PIT8254_HPP
+#define DRIVERS_HAL_PIT8254_HPP
+
+#include <kernel/types.hpp>
+using namespace tacOS::Kernel;
+
+/*
+    Programmable Interval Timer (8254) Ports. Channel 2 is gated
+    through the Keyboard Controller's port 0x61 and can be polled
+    without an IRQ, making it a usable calibration reference.
+
+    Refer:
+    https://wiki.osdev.org/Programmable_Interval_Timer
+*/
+
+#define PIT8254_FREQUENCY 1193182 /* Hz */
+#define PIT8254_CHANNEL2_DATA 0x42
+#define PIT8254_COMMAND 0x43
+#define PIT8254_GATE_PORT 0x61
+
+#define PIT8254_GATE_CHANNEL2 (1 << 0)
+#define PIT8254_GATE_SPEAKER (1 << 1)
+#define PIT8254_GATE_OUTPUT2 (1 << 5)
+
+/* Channel 2, Access lobyte/hibyte, Mode 0 (Interrupt on Terminal Count) */
+#define PIT8254_CMD_CHANNEL2_ONESHOT 0xB0
+
+namespace tacOS {
+namespace Drivers {
+    namespace HAL {
+        class Pit8254 {
+        public:
+            static void StartCountdown(u16 Count);
+            static bool CountdownExpired();
+        };
+    }
+}
+}
+
+#endif
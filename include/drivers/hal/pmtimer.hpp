@@ -0,0 +1,63 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DRIVERS_HAL_PMTIMER_HPP
+#define DRIVERS_HAL_PMTIMER_HPP
+
+#include <kernel/time/clocksrc.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define PMTIMER_FREQUENCY 3579545 /* Hz */
+#define PMTIMER_MASK24 0xFFFFFFULL
+#define PMTIMER_MASK32 0xFFFFFFFFULL
+#define PMTIMER_RATING 200
+
+namespace tacOS {
+namespace Drivers {
+    namespace HAL {
+        /// @brief ACPI Power Management Timer
+        class PmTimer {
+        public:
+            enum Status {
+                ERROR = 0,
+                OK = 1
+            };
+
+            static u16 Port; /* Set if the Timer is in I/O Space */
+            static volatile u32* Address; /* Set if the Timer is Memory-Mapped */
+            static ClockSource::Source Clock;
+
+            /// @brief Checks if the Timer was found in the FADT
+            static inline bool Available()
+            {
+                return Clock.Read != 0;
+            }
+
+            static u32 ReadCounter();
+            static Status Initialize();
+
+        private:
+            static u64 ReadClock(ClockSource::Source* Src);
+        };
+    }
+}
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DRIVERS_HAL_TSC_HPP
+#define DRIVERS_HAL_TSC_HPP
+
+#include <kernel/time/clocksrc.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+/* CPUID Leaves and Bits */
+#define TSC_CPUID_LEAF_CRYSTAL 0x15 /* TSC / Core Crystal Clock Ratio */
+#define TSC_CPUID_LEAF_FREQUENCY 0x16 /* Processor Base Frequency (MHz) */
+#define TSC_CPUID_LEAF_POWER 0x80000007 /* Advanced Power Management */
+#define TSC_CPUID_INVARIANT (1 << 8) /* EDX of TSC_CPUID_LEAF_POWER */
+
+#define TSC_CALIBRATION_RUNS 3
+#define TSC_CALIBRATION_HZ 100 /* 10ms Reference Window */
+#define TSC_RATING_INVARIANT 300
+#define TSC_RATING_UNSTABLE 50 /* Stops or Changes Rate in Deep C-States */
+
+namespace tacOS {
+namespace Drivers {
+    namespace HAL {
+        class Tsc {
+        public:
+            enum Status {
+                ERROR = 0,
+                OK = 1
+            };
+
+            /// @brief Origin of the Calibrated Frequency
+            enum Calibration {
+                NONE = 0,
+                CPUID_CRYSTAL = 1,
+                CPUID_BASE = 2,
+                REFERENCE = 3 /* Measured against a Reference Clock */
+            };
+
+            static u64 Frequency; /* Hz */
+            static bool Invariant;
+            static Calibration Method;
+            static ClockSource::Source Clock;
+
+            static Status Initialize();
+            static bool IsInvariant();
+
+        private:
+            static u64 CalibrateCpuid();
+            static u64 CalibrateReference();
+            static u64 Read(ClockSource::Source* Src);
+        };
+    }
+}
+}
+
+#endif
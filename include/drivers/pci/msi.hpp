@@ -0,0 +1,142 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DRIVERS_PCI_MSI_HPP
+#define DRIVERS_PCI_MSI_HPP
+
+#include <drivers/pci/pcidef.hpp>
+#include <kernel/interrupts/intrdef.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+/* MSI Capability Layout (Offsets from Capability Start) */
+#define MSI_REG_CONTROL 0x02
+#define MSI_REG_ADDRLOW 0x04
+#define MSI_REG_ADDRHIGH 0x08 /* 64-bit Capable Functions Only */
+#define MSI_REG_DATA32 0x08
+#define MSI_REG_DATA64 0x0C
+#define MSI_REG_MASK32 0x0C
+#define MSI_REG_MASK64 0x10
+
+#define MSI_CONTROL_ENABLE (1 << 0)
+#define MSI_CONTROL_MMESHIFT 4
+#define MSI_CONTROL_MMEMASK (0x7 << MSI_CONTROL_MMESHIFT)
+#define MSI_CONTROL_64BIT (1 << 7)
+#define MSI_CONTROL_PERVECTORMASK (1 << 8)
+
+/* MSI-X Capability Layout (Offsets from Capability Start) */
+#define MSIX_REG_CONTROL 0x02
+#define MSIX_REG_TABLE 0x04
+#define MSIX_REG_PBA 0x08
+
+#define MSIX_CONTROL_TABLESIZE 0x07FF /* Encoded as N - 1 */
+#define MSIX_CONTROL_FUNCMASK (1 << 14)
+#define MSIX_CONTROL_ENABLE (1 << 15)
+#define MSIX_BIR_MASK 0x7
+
+/* MSI-X Table Entry Layout (16 Bytes, Dword Indices) */
+#define MSIX_ENTRY_SIZE 16
+#define MSIX_ENTRY_ADDRLOW 0
+#define MSIX_ENTRY_ADDRHIGH 1
+#define MSIX_ENTRY_DATA 2
+#define MSIX_ENTRY_CONTROL 3
+#define MSIX_ENTRY_CONTROL_MASKED (1 << 0)
+
+/* x86 Message Address/Data Format */
+#define MSI_ADDRESS_BASE 0xFEE00000
+#define MSI_ADDRESS_DESTSHIFT 12
+#define MSI_ADDRESS_MAXDESTID 0xFF /* 8-bit Destination ID, no Interrupt Remapping */
+#define MSI_DATA_EDGE_FIXED 0x0000 /* Fixed Delivery, Edge Triggered */
+
+namespace tacOS {
+namespace Drivers {
+    namespace PCI {
+        /// @brief Message Signaled Interrupts (MSI and MSI-X) Support
+        class Msi {
+        public:
+            enum Status {
+                ERROR = 0,
+                OK = 1
+            };
+
+            /// @brief Parsed MSI Capability of a Function
+            struct MsiInfo {
+                PciDef::Device Device;
+                u8 CapOffset;
+                bool Is64Bit;
+                bool PerVectorMask;
+                u32 Cpu; /* Processor owning the Vector */
+                u8 Vector;
+            };
+
+            /// @brief Vector an MSI-X Table Entry is Bound to
+            struct MsiXBinding {
+                u32 Cpu; /* Processor owning the Vector */
+                u8 Vector; /* 0 if Unbound */
+            };
+
+            /// @brief Parsed MSI-X Capability of a Function
+            struct MsiXInfo {
+                PciDef::Device Device;
+                u8 CapOffset;
+                u16 TableSize;
+                volatile u32* Table; /* MMIO Mapping of the Vector Table */
+                volatile u32* PendingBits; /* MMIO Mapping of the PBA */
+                MsiXBinding* Bindings; /* One per Table Entry, Recorded by BindMsiXEntry() */
+            };
+
+            /// @brief Composes a Message Address targeting a Local APIC
+            /// @param ApicId Destination, at most MSI_ADDRESS_MAXDESTID (See SelectTarget())
+            static inline u32 ComposeAddress(u32 ApicId)
+            {
+                return MSI_ADDRESS_BASE | (ApicId << MSI_ADDRESS_DESTSHIFT);
+            }
+
+            /// @brief Composes Message Data delivering a Vector
+            static inline u32 ComposeData(u8 Vector)
+            {
+                return MSI_DATA_EDGE_FIXED | Vector;
+            }
+
+            /* MSI Routines */
+            static Status ParseMsi(PciDef::Device Dev, MsiInfo* Info);
+            static Status EnableMsi(MsiInfo* Info, u32 Cpu, Interrupt::Handler Routine, void* Context);
+            static Status SetMsiAffinity(MsiInfo* Info, u32 Cpu);
+            static void DisableMsi(MsiInfo* Info);
+            static void MaskMsi(MsiInfo* Info);
+            static void UnmaskMsi(MsiInfo* Info);
+
+            /* MSI-X Routines */
+            static Status ParseMsiX(PciDef::Device Dev, MsiXInfo* Info);
+            static Status EnableMsiX(MsiXInfo* Info);
+            static void DisableMsiX(MsiXInfo* Info);
+            static Status BindMsiXEntry(MsiXInfo* Info, u16 Entry, u32 Cpu, Interrupt::Handler Routine, void* Context);
+            static void UnbindMsiXEntry(MsiXInfo* Info, u16 Entry);
+            static void MaskMsiXEntry(MsiXInfo* Info, u16 Entry);
+            static void UnmaskMsiXEntry(MsiXInfo* Info, u16 Entry);
+            static bool IsMsiXEntryPending(MsiXInfo* Info, u16 Entry);
+
+        private:
+            static Status SelectTarget(u32* Cpu);
+        };
+    }
+}
+}
+
+#endif
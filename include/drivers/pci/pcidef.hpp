@@ -0,0 +1,79 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DRIVERS_PCI_PCIDEF_HPP
+#define DRIVERS_PCI_PCIDEF_HPP
+
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+/* Configuration Space Access Mechanism #1 Ports */
+#define PCI_CONFIG_ADDRESS 0x0CF8
+#define PCI_CONFIG_DATA 0x0CFC
+#define PCI_CONFIG_ENABLE (1U << 31)
+
+/* Standard Configuration Space Header Registers */
+#define PCI_REG_VENDORID 0x00
+#define PCI_REG_DEVICEID 0x02
+#define PCI_REG_COMMAND 0x04
+#define PCI_REG_STATUS 0x06
+#define PCI_REG_HEADERTYPE 0x0E
+#define PCI_REG_BAR0 0x10
+#define PCI_REG_CAPPTR 0x34
+
+#define PCI_COMMAND_MEMORY (1 << 1)
+#define PCI_COMMAND_BUSMASTER (1 << 2)
+#define PCI_COMMAND_INTXDISABLE (1 << 10)
+#define PCI_STATUS_CAPLIST (1 << 4)
+
+#define PCI_BAR_IOSPACE (1 << 0)
+#define PCI_BAR_TYPEMASK 0x06
+#define PCI_BAR_TYPE64 0x04
+
+/* Capability IDs */
+#define PCI_CAP_ID_MSI 0x05
+#define PCI_CAP_ID_MSIX 0x11
+
+namespace tacOS {
+namespace Drivers {
+    namespace PCI {
+        /// @brief PCI Definitions and Configuration Space Routines
+        class PciDef {
+        public:
+            /// @brief Location of a PCI Function
+            struct Device {
+                u8 Bus;
+                u8 Slot;
+                u8 Function;
+            };
+
+            static u32 ConfigRead32(Device Dev, u8 Offset);
+            static u16 ConfigRead16(Device Dev, u8 Offset);
+            static u8 ConfigRead8(Device Dev, u8 Offset);
+            static void ConfigWrite32(Device Dev, u8 Offset, u32 Value);
+            static void ConfigWrite16(Device Dev, u8 Offset, u16 Value);
+
+            static u8 FindCapability(Device Dev, u8 CapabilityId);
+            static u64 GetBarAddress(Device Dev, u8 Bar);
+        };
+    }
+}
+}
+
+#endif
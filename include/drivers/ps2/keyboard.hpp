@@ -20,16 +20,31 @@
 #define DRIVERS_HAL_PS2KBD_HPP
 
 #include <drivers/hal/virtkbd.hpp>
+#include <kernel/interrupts/intrpoll.hpp>
 #include <kernel/types.hpp>
 
 using namespace tacOS::Kernel;
 
+#define PS2_DATA_PORT 0x60
+#define PS2_STATUS_PORT 0x64
+#define PS2_STATUS_OUTPUTFULL (1 << 0)
+
 namespace tacOS {
 namespace Drivers {
     namespace PS2 {
         class Keyboard {
         public:
-            static void KeyboardInterrupt(u8 ScanCode);
+            static InterruptPoll::PollContext PollCtx;
+
+            static void Initialize();
+            static void KeyboardInterrupt();
+            static void ProcessScanCode(u8 ScanCode);
+
+        private:
+            static u32 Poll(InterruptPoll::PollContext* Context, u32 Budget);
+            static bool HasPending(InterruptPoll::PollContext* Context);
+            static void DisableIrq(InterruptPoll::PollContext* Context);
+            static void EnableIrq(InterruptPoll::PollContext* Context);
         };
     }
 }
@@ -0,0 +1,85 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_GDTDEF_HPP
+#define KERNEL_GDTDEF_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+/* Segment Selectors, Code Selector Matches osloader.asm */
+#define GDT_SELECTOR_KERNELCODE 0x08
+#define GDT_SELECTOR_KERNELDATA 0x10
+#define GDT_SELECTOR_TSS 0x18
+#define GDT_ENTRIES 5 /* Null, Code, Data, TSS (Two Entries) */
+
+/* Interrupt Stack Table Indices (1-7, 0 Disables Switching) */
+#define GDT_IST_NMI 1
+#define GDT_IST_DOUBLEFAULT 2
+#define GDT_IST_MACHINECHECK 3
+#define GDT_IST_COUNT 3
+
+#define GDT_ISTSTACK_SIZE 8192
+#define GDT_IRQSTACK_SIZE 16384
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Global Descriptor Table and Task State Segment Management
+    class Gdt {
+    public:
+        /// @brief 64-bit Task State Segment
+        struct TaskStateSegment {
+            u32 Reserved0;
+            u64 Rsp[3]; /* Stacks for Privilege Level Changes */
+            u64 Reserved1;
+            u64 Ist[7]; /* Interrupt Stack Table */
+            u64 Reserved2;
+            u16 Reserved3;
+            u16 IoMapBase;
+        } __attribute__((packed));
+
+        struct GdtRegister {
+            u16 Limit;
+            u64 Base;
+        } __attribute__((packed));
+
+        /// @brief Descriptor Tables and Dedicated Stacks of a Processor
+        struct CpuTables {
+            u64 Entries[GDT_ENTRIES];
+            TaskStateSegment Tss;
+            u8 IstStacks[GDT_IST_COUNT][GDT_ISTSTACK_SIZE] __attribute__((aligned(16)));
+            u8 IrqStack[GDT_IRQSTACK_SIZE] __attribute__((aligned(16)));
+        };
+
+        static CpuTables* Tables[KERNEL_SMP_MAXCPUS];
+
+        static void Initialize(u32 Cpu, CpuTables* CpuTbl);
+        static void Load(u32 Cpu);
+
+        /// @brief Returns the Top of the Dedicated IRQ Stack of a Processor
+        static inline u64 GetIrqStackTop(u32 Cpu)
+        {
+            return (u64)&Tables[Cpu]->IrqStack[GDT_IRQSTACK_SIZE];
+        }
+    };
+}
+}
+
+#endif
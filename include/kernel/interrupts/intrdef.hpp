@@ -19,11 +19,26 @@
 #ifndef KERNEL_INTERRUPT_HPP
 #define KERNEL_INTERRUPT_HPP
 
+#include <kernel/smp/smp.hpp>
 #include <kernel/types.hpp>
 
 using namespace tacOS::Kernel;
 
-#define INTERRUPT_ISRCOUNT 50 /* Should match with isrdef.asm */
+#define INTERRUPT_ISRCOUNT 256 /* Should match with isrdef.asm */
+#define INTERRUPT_VECTORS 256
+
+/* Vectors handed out to MSI/MSI-X and other LAPIC Delivered Sources */
+#define INTERRUPT_DYNAMIC_MIN 0x30
+#define INTERRUPT_DYNAMIC_MAX 0xFE
+
+/* Device Not Available (#NM), Raised on Extended State use while CR0.TS is Set */
+#define INTERRUPT_DEVICENOTAVAILABLE 7
+
+/* Interrupt Gate, Present, DPL 0 (IF is Cleared on Entry) */
+#define INTERRUPT_GATE_ATTRIBUTES 0x8E
+
+/* Priority Class of a Vector, as compared by the Local APIC */
+#define INTERRUPT_CLASS(Vector) ((Vector) >> 4)
 
 namespace tacOS {
 namespace Kernel {
@@ -72,10 +87,65 @@ namespace Kernel {
             u64 Eflags;
         } __attribute__((packed));
 
+        /*
+            The Local APIC delivers a vector only if its class
+            (Vector >> 4) is above the Processor Priority, which is
+            the higher of the Task Priority and the class in service.
+            Vectors are therefore allocated by class, in ascending
+            order of urgency. Timer and IPI vectors sit above all
+            devices so that they preempt nestable device handlers.
+        */
+        enum PriorityClass {
+            PASSIVE = 0x0, /* All Vectors Delivered */
+            LEGACY = 0x2, /* 8259 PIC Vectors (0x20 - 0x2F) */
+            DEVICE_LOW = 0x3, /* Bulk Devices (0x30 - 0x6F) */
+            DEVICE = 0x7, /* Default Devices (0x70 - 0xAF) */
+            DEVICE_HIGH = 0xB, /* Latency Sensitive Devices (0xB0 - 0xDF) */
+            TIMER = 0xE, /* Local Timers (0xE0 - 0xEF) */
+            IPI = 0xF, /* Inter-Processor Interrupts (0xF0 - 0xFE) */
+            DISABLED = 0xF /* Blocks every Class but NMI/SMI/INIT */
+        };
+
+        /// @brief Routine invoked for a Bound Interrupt Vector
+        typedef void (*Handler)(u8 Vector, void* Context);
+
+        /// @brief Handler Binding of a single Vector
+        struct VectorEntry {
+            Handler Routine;
+            void* Context;
+            bool Allocated;
+            bool Nestable; /* Runs with IF Set, Higher Classes may Preempt */
+        };
+
+        /// @brief Vector Bindings of a single Processor
+        struct VectorTable {
+            VectorEntry Entries[INTERRUPT_VECTORS];
+        };
+
+        static VectorTable* VectorTables[KERNEL_SMP_MAXCPUS];
+        static u32 NestingDepth; /* Per-CPU */
+
         static void Register();
+        static void InitializeCpu(u32 Cpu);
         static void InitHWInterrupts();
         static void UnhandledException(int Code);
 
+        /* Define CPU-Local Vector Management */
+        static u8 AllocateVector(u32 Cpu, PriorityClass Class = DEVICE);
+        static void FreeVector(u32 Cpu, u8 Vector);
+        static bool BindHandler(u32 Cpu, u8 Vector, Handler Routine, void* Context, bool Nestable = false);
+        static void UnbindHandler(u32 Cpu, u8 Vector);
+
+        /// @brief Checks if the Executing Processor is servicing an Interrupt
+        static inline bool InInterrupt()
+        {
+            return PerCpu::Read(NestingDepth) != 0;
+        }
+
+        /* Define Task Priority (IRQL-Style) Management */
+        static u8 RaisePriority(PriorityClass Class);
+        static void LowerPriority(u8 Previous);
+
         /* Define Standard Kernel Interrupts */
         static void CpuException(u8 InterruptCode);
         static void KeyboardInterrupt(u8 KeyCode);
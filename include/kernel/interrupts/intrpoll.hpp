@@ -0,0 +1,90 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_INTRPOLL_HPP
+#define KERNEL_INTRPOLL_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_INTRPOLL_BUDGET 256 /* Events per Poll Round across all Devices */
+#define KERNEL_INTRPOLL_WEIGHT 64 /* Default Events per Device per Poll */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Adaptive Interrupt/Polling Hybrid for High-Rate Devices
+    class InterruptPoll {
+    public:
+        struct PollContext;
+
+        /// @brief Processes up to Budget Events, Returns the number Processed
+        typedef u32 (*PollRoutine)(PollContext* Context, u32 Budget);
+
+        /// @brief Masks or Unmasks the Device Interrupt
+        typedef void (*IrqControl)(PollContext* Context);
+
+        /// @brief Checks for Events that arrived while the Interrupt was Masked
+        typedef bool (*PendingCheck)(PollContext* Context);
+
+        /// @brief Polling State
+        enum State {
+            IDLE = 0, /* Interrupt Enabled, Waiting for Events */
+            SCHEDULED = 1 /* Interrupt Masked, Queued for Polling */
+        };
+
+        /// @brief Per-Device Polling Context, Embedded in the Driver
+        struct PollContext {
+            PollContext* Next;
+            PollRoutine Poll;
+            IrqControl DisableIrq;
+            IrqControl EnableIrq;
+            PendingCheck HasPending; /* Optional */
+            void* Device;
+            u32 Weight;
+            volatile u32 PollState;
+
+            /* Statistics */
+            u64 Interrupts;
+            u64 Polls;
+            u64 Events;
+        };
+
+        /// @brief Per-CPU list of Devices being Polled
+        struct PollList {
+            PollContext* Head;
+            PollContext* Tail;
+        };
+
+        static PollList Lists[KERNEL_SMP_MAXCPUS];
+
+        static void Initialize();
+        static void Register(PollContext* Context, PollRoutine Poll, IrqControl DisableIrq,
+            IrqControl EnableIrq, void* Device, u32 Weight = KERNEL_INTRPOLL_WEIGHT);
+        static bool Schedule(PollContext* Context);
+
+    private:
+        static void Enqueue(PollList* List, PollContext* Context);
+        static void Complete(PollContext* Context);
+        static void Run();
+    };
+}
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_INTRSTAT_HPP
+#define KERNEL_INTRSTAT_HPP
+
+#include <kernel/interrupts/intrdef.hpp>
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define INTRSTAT_HISTBUCKETS 32 /* Bucket N counts Handlers taking [2^N, 2^(N+1)) Cycles */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Per-CPU, Per-Vector Interrupt Rate and Latency Statistics
+    class InterruptStats {
+    public:
+        /// @brief Statistics of a single Vector
+        struct VectorStats {
+            u64 Count;
+            u64 Spurious;
+            u64 TotalCycles;
+            u64 MaxCycles;
+            u32 Histogram[INTRSTAT_HISTBUCKETS];
+        };
+
+        /// @brief Statistics of a single Processor
+        struct CpuStats {
+            VectorStats Vectors[INTERRUPT_VECTORS];
+        };
+
+        static CpuStats* Stats[KERNEL_SMP_MAXCPUS];
+
+        /// @brief Accounts a Handled Interrupt
+        /// @param Vector Interrupt Vector
+        /// @param Cycles Cycles spent in the Handler
+        static inline void Record(u8 Vector, u64 Cycles)
+        {
+            /*
+                Called from the interrupt path with interrupts disabled
+                on the local processor, so the per-CPU counters need no
+                locks or atomics.
+            */
+
+            CpuStats* Cpu = Stats[Smp::CurrentCpu()];
+            if (!Cpu)
+                return;
+
+            VectorStats* Entry = &Cpu->Vectors[Vector];
+            Entry->Count++;
+            Entry->TotalCycles += Cycles;
+            if (Cycles > Entry->MaxCycles)
+                Entry->MaxCycles = Cycles;
+
+            /* Bucket is the Index of the Highest Set Bit (log2) */
+            u32 Bucket = Cycles ? (63 - __builtin_clzll(Cycles)) : 0;
+            if (Bucket >= INTRSTAT_HISTBUCKETS)
+                Bucket = INTRSTAT_HISTBUCKETS - 1;
+
+            Entry->Histogram[Bucket]++;
+        }
+
+        /// @brief Accounts a Spurious Interrupt
+        /// @param Vector Interrupt Vector
+        static inline void RecordSpurious(u8 Vector)
+        {
+            CpuStats* Cpu = Stats[Smp::CurrentCpu()];
+            if (Cpu)
+                Cpu->Vectors[Vector].Spurious++;
+        }
+
+        static void Reset(u32 Cpu);
+        static void Dump();
+        static void DumpCpus();
+        static void DumpHistogram(u32 Cpu, u8 Vector);
+    };
+}
+}
+
+#endif
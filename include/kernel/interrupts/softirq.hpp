@@ -0,0 +1,95 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_SOFTIRQ_HPP
+#define KERNEL_SOFTIRQ_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_SOFTIRQ_MAXRESTART 8 /* Rounds per Run() before deferring */
+#define KERNEL_SOFTIRQ_TASKLETBUDGET 16 /* Tasklets per Round */
+
+/* Tasklet State Bits */
+#define KERNEL_SOFTIRQ_TASKLET_SCHEDULED (1 << 0) /* Queued on some Processor */
+#define KERNEL_SOFTIRQ_TASKLET_RUNNING (1 << 1) /* Routine Executing on some Processor */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Deferred Interrupt Work (Bottom Halves)
+    class SoftIrq {
+    public:
+        /// @brief Bottom Half Types, Lower values run First
+        enum Type {
+            HI = 0,
+            TIMER = 1,
+            POLL = 2,
+            BLOCK = 3,
+            NET = 4,
+            TASKLET = 5,
+            RCU = 6,
+            MAX = 7
+        };
+
+        /// @brief Routine run for a Raised Bottom Half Type
+        typedef void (*Action)();
+
+        /// @brief Tasklet, a Bottom Half that never runs concurrently with itself
+        struct Tasklet {
+            Tasklet* Next;
+            void (*Routine)(void* Context);
+            void* Context;
+            volatile u32 State; /* KERNEL_SOFTIRQ_TASKLET_* */
+        };
+
+        /// @brief Per-CPU Bottom Half State
+        struct CpuQueue {
+            volatile u32 Pending; /* Bitmap of Raised Types */
+            bool Running; /* Prevents Re-entry from Nested Interrupts */
+
+            /* Tasklet List */
+            Tasklet* TaskletHead;
+            Tasklet** TaskletTail;
+        };
+
+        static CpuQueue Queues[KERNEL_SMP_MAXCPUS];
+
+        /// @brief Checks if Bottom Halves are Pending on this Processor
+        static inline bool IsPending()
+        {
+            return Queues[Smp::CurrentCpu()].Pending;
+        }
+
+        static void Initialize();
+        static void RegisterAction(Type SoftIrqType, Action Routine);
+        static void Raise(Type SoftIrqType);
+        static void Run();
+
+        static void ScheduleTasklet(Tasklet* Task);
+
+    private:
+        static Action Actions[Type::MAX];
+        static void QueueTasklet(CpuQueue* Queue, Tasklet* Task);
+        static void RunTasklets();
+    };
+}
+}
+
+#endif
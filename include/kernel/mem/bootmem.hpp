@@ -19,8 +19,10 @@
 #ifndef KERNEL_BOOTMEM_HPP
 #define KERNEL_BOOTMEM_HPP
 
+#include <kernel/mem/numa.hpp>
 #include <kernel/multiboot/mbpvdr.hpp>
 #include <kernel/types.hpp>
+#include <tools/kernelrtl/spinlock.hpp>
 
 #define KERNEL_BOOTMEM_PMMGR_BLOCKALLOCLIMIT 512 /* Max 2MB Bitmap Based Alloc */
 #define KERNEL_BOOTMEM_PMMGR_BLOCKSPERBYTE 8
@@ -74,9 +76,15 @@ namespace Kernel {
         static VirtualAddress* VirtAllocateBlock(u64 Size = 1);
         static void VirtFreeBlock(VirtualAddress* AllocatedBlock, u64 Size = 1);
         static void PhysicalMemoryMapToOffset(PhysicalAddress BaseAddress, u64 Offset);
+        static void InitializeNodes();
 
     private:
+        static Tools::KernelRTL::TicketLock Lock; /* Guards the Bitmap and the Page Tables */
+
         static u64 GetPhysicalMemoryMapFreeIndex(u64 Blocks = 1);
+        static u64 SearchPhysicalMemoryMap(u64 Blocks, u64 FirstFrame, u64 EndFrame);
+        static void GetRangeFrames(Numa::MemoryRange* Range, u64* FirstFrame, u64* EndFrame);
+        static void AccountNodeBlocks(u64 Frame, u64 Size, bool Freed);
         static void InitPhysicalMemory(MBootDef::MemoryMap* MemoryMap);
         static void InitVirtualMemory(MBootDef::MemoryMap* MemoryMap);
         static PhysicalAddress* PhysicalMemoryAllocateBlock(u64 Size = 1);
@@ -0,0 +1,87 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_NUMA_HPP
+#define KERNEL_NUMA_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_NUMA_MAXNODES 8
+#define KERNEL_NUMA_MAXRANGES 32 /* Memory Affinity Ranges */
+#define KERNEL_NUMA_NONODE 0xFFFFFFFF
+#define KERNEL_NUMA_LOCALDISTANCE 10 /* SLIT Distances are Relative to this */
+#define KERNEL_NUMA_REMOTEDISTANCE 20 /* Assumed without a SLIT */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Non-Uniform Memory Access Nodes, from the ACPI SRAT and SLIT
+    class Numa {
+    public:
+        /// @brief Physical Memory Range of a Node
+        struct MemoryRange {
+            u64 Base;
+            u64 Length;
+            u32 Node;
+        };
+
+        /// @brief Proximity Domain with Memory or Processors
+        struct Node {
+            u32 Domain; /* ACPI Proximity Domain */
+            u64 TotalBlocks;
+            u64 FreeBlocks; /* Kept by BootMem, under its Lock */
+            u32 Fallback[KERNEL_NUMA_MAXNODES]; /* Nodes by Distance, itself First */
+        };
+
+        static Node Nodes[KERNEL_NUMA_MAXNODES];
+        static u32 NodeCount;
+        static MemoryRange Ranges[KERNEL_NUMA_MAXRANGES];
+        static u32 RangeCount;
+
+        /// @brief Returns the Node of the Executing Processor
+        static inline u32 CurrentNode()
+        {
+            return CpuNodes[Smp::CurrentCpu()];
+        }
+
+        /// @brief Returns the Node of a Processor
+        static inline u32 NodeOfCpu(u32 Cpu)
+        {
+            return CpuNodes[Cpu];
+        }
+
+        static void Initialize();
+        static u32 NodeOfAddress(u64 PhysicalAddress);
+        static u8 Distance(u32 From, u32 To);
+        static void Dump();
+
+    private:
+        static u32 CpuNodes[KERNEL_SMP_MAXCPUS];
+        static u8 Distances[KERNEL_NUMA_MAXNODES][KERNEL_NUMA_MAXNODES];
+
+        static u32 GetNode(u32 Domain);
+        static void AssignCpu(u32 ApicId, u32 Domain);
+        static void ParseSlit();
+        static void BuildFallback(u32 From);
+    };
+}
+}
+
+#endif
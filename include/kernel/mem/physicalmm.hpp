@@ -21,6 +21,7 @@
 
 #include <kernel/types.hpp>
 #include <kernel/multiboot/mbpvdr.hpp>
+#include <tools/kernelrtl/spinlock.hpp>
 
 #define KERNEL_PHYSICALMM_BLOCKSIZE 4096
 #define KERNEL_PHYSICALMM_BLOCKALIGN KERNEL_PHYSICALMM_BLOCKSIZE
@@ -49,6 +50,9 @@ namespace Kernel {
         static PhysicalAddress* AllocateBlock();
         static void FreeBlock(PhysicalAddress* BaseAddress);
         static MemoryStats GetMemoryStatistics();
+
+    private:
+        static Tools::KernelRTL::QueuedSpinLock Lock; /* Guards the Stack and Counters */
     };
 }
 }
@@ -0,0 +1,83 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_TLB_HPP
+#define KERNEL_TLB_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_TLB_BATCHSIZE 32 /* Pages Flushed with INVLPG, a Full Flush Beyond */
+#define KERNEL_TLB_MASKWORDS (KERNEL_SMP_MAXCPUS / 64)
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Batched TLB Shootdown for the Kernel Address Space
+    class Tlb {
+    public:
+        typedef void (*ReclaimRoutine)(void* Context);
+
+        /// @brief Invalidations of a single Shootdown
+        struct Batch {
+            u64 Addresses[KERNEL_TLB_BATCHSIZE];
+            u32 Count;
+            bool Full; /* Overflowed, the Whole TLB is Flushed */
+        };
+
+        /// @brief Shootdown State of a Processor
+        struct CpuShootdown {
+            Batch Pending; /* Accumulated by this Processor, not yet Sent */
+            Batch Request; /* Sent, Read by Targets till Remaining is 0 */
+            volatile u32 Remaining;
+            ReclaimRoutine Reclaim;
+            void* ReclaimContext;
+            u64 Initiators[KERNEL_TLB_MASKWORDS]; /* Processors whose Request this one owes a Flush */
+            u64 LazyGeneration; /* Generation when it Stopped Receiving Shootdowns */
+            u8 Vector;
+            u64 Shootdowns; /* Requests Sent */
+            u64 IpisSent;
+            u64 FullFlushes;
+        } __attribute__((aligned(64)));
+
+        static CpuShootdown Cpus[KERNEL_SMP_MAXCPUS];
+
+        static void Initialize();
+        static void InitializeCpu(u32 Cpu);
+        static void Invalidate(u64 Address);
+        static void InvalidateAll();
+        static void Flush();
+        static void FlushDeferred(ReclaimRoutine Reclaim, void* Context);
+        static void EnterLazy();
+        static void ExitLazy();
+        static void ProcessPending();
+
+    private:
+        static u64 ActiveMask[KERNEL_TLB_MASKWORDS]; /* Processors that may Cache Kernel Translations */
+        static u64 Generation; /* Shootdowns Sent, System-Wide */
+
+        static void Send(ReclaimRoutine Reclaim, void* Context, bool Wait);
+        static void FlushLocal(Batch* Invalidations);
+        static void ProcessPending(u32 Cpu);
+        static void ShootdownInterrupt(u8 Vector, void* Context);
+    };
+}
+}
+
+#endif
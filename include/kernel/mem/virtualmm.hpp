@@ -139,6 +139,7 @@ namespace Kernel {
         }
 
         static VirtualAddress* HardwareRemap(PhysicalMemory::PhysicalAddress* BaseAddress);
+        static VirtualAddress* HardwareRemap(PhysicalMemory::PhysicalAddress* BaseAddress, u64 Length);
         static VirtualAddress* MapPhysicalFrame(PhysicalMemory::PhysicalAddress* BaseAddress);
         static VirtualAddress* AllocateBlock(PML4Table* PML4TablePtr);
         static void Intialize();
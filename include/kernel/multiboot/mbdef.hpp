@@ -94,7 +94,7 @@ namespace Kernel {
         struct BootCMDLine
         {
             TagHeader Header;
-            char* CmdLine;
+            char CmdLine[1]; /* Null Terminated, Inline in the Tag */
         };
 
         /// @brief Modules Structure
@@ -32,9 +32,11 @@ namespace Kernel {
         static MBootDef::MultibootInfo* MBootInfoPtr;
         static MBootDef::MemoryMap* MemoryMapPtr;
         static MBootDef::MemoryInfo* MemoryInfoPtr;
+        static const char* CommandLine;
 
         static int Initialize(u64 MultibootInfoPtrAddress);
         static void ProcessMemoryInfo(MBootDef::MemoryInfo* MemoryInfo);
+        static const char* GetParameter(const char* Name);
     };
 }
 }
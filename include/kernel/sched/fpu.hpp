@@ -0,0 +1,69 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_FPU_HPP
+#define KERNEL_FPU_HPP
+
+#include <kernel/sched/sched.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_FPU_XCR0_X87 (1 << 0)
+#define KERNEL_FPU_XCR0_SSE (1 << 1)
+#define KERNEL_FPU_XCR0_AVX (1 << 2)
+#define KERNEL_FPU_XCOMP_COMPACTED (1ULL << 63) /* XCOMP_BV, Required by XRSTORS */
+
+#define KERNEL_FPU_FXSAVE_SIZE 512
+#define KERNEL_FPU_AREA_ALIGN 64
+#define KERNEL_FPU_DEFAULT_FCW 0x037F /* All x87 Exceptions Masked */
+#define KERNEL_FPU_DEFAULT_MXCSR 0x1F80 /* All SIMD Exceptions Masked */
+#define KERNEL_FPU_NOCPU 0xFFFFFFFF
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Lazy Extended (x87/SSE/AVX) State Management
+    class Fpu {
+    public:
+        enum SaveMethod {
+            FXSAVE = 0,
+            XSAVE = 1,
+            XSAVEOPT = 2, /* Skips Components not Modified since XRSTOR */
+            XSAVES = 3 /* Compacted, with the XSAVEOPT Optimizations */
+        };
+
+        static SaveMethod Method;
+        static u64 Features; /* XCR0, 0 if XSAVE is Unsupported */
+        static u32 StateSize;
+
+        static void Initialize();
+        static void InitializeCpu();
+        static void InitializeThread(Scheduler::Thread* Thd);
+        static void Switch(Scheduler::Thread* Prev, Scheduler::Thread* Next, u32 Cpu);
+        static void DeviceNotAvailable();
+
+    private:
+        static Scheduler::Thread* Owner; /* Per-CPU */
+
+        static void Save(u8* Area);
+        static void Restore(u8* Area);
+    };
+}
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_PREEMPT_HPP
+#define KERNEL_PREEMPT_HPP
+
+#include <kernel/smp/percpu.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Preemption Nesting of each Processor, Kept apart from the Scheduler for the Spinlocks
+    class Preempt {
+    public:
+        /// @brief Holds off Preemption (but not Interrupts) on the Executing Processor
+        static inline void Disable()
+        {
+            PerCpu::Add(Count, 1U);
+        }
+
+        /// @brief Allows Preemption again, Nests with Disable()
+        static inline void Enable()
+        {
+            PerCpu::Add(Count, (u32)-1);
+        }
+
+        /// @brief Checks if Preemption is Held off on the Executing Processor
+        static inline bool Disabled()
+        {
+            return PerCpu::Read(Count) != 0;
+        }
+
+    private:
+        static u32 Count; /* Per-CPU */
+    };
+}
+}
+
+#endif
@@ -0,0 +1,167 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_SCHED_HPP
+#define KERNEL_SCHED_HPP
+
+#include <kernel/sched/preempt.hpp>
+#include <kernel/smp/percpu.hpp>
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+#include <tools/kernelrtl/spinlock.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_SCHED_PRIORITIES 32 /* 0 is the Highest, One Bitmap Word */
+#define KERNEL_SCHED_DEFAULTPRIORITY 16
+#define KERNEL_SCHED_TIMESLICE 4 /* Ticks a Thread runs before Round-Robin */
+#define KERNEL_SCHED_BALANCETICKS 25 /* Ticks between Load Balancing Passes */
+#define KERNEL_SCHED_REMOTEBALANCE 4 /* Passes per one that Balances beyond the LLC */
+#define KERNEL_SCHED_STACKPAGES 4
+#define KERNEL_SCHED_ANYCPU 0xFFFFFFFF /* Thread isn't Bound to a Processor */
+#define KERNEL_SCHED_MASKWORDS (KERNEL_SMP_MAXCPUS / 64)
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Preemptive Kernel Thread Scheduler
+    class Scheduler {
+    public:
+        typedef void (*ThreadRoutine)(void* Context);
+
+        enum ThreadState {
+            READY = 0,
+            RUNNING = 1,
+            BLOCKED = 2,
+            DEAD = 3
+        };
+
+        /// @brief Kernel Thread, Stored at the Base of its Stack, followed by its Extended State
+        struct Thread {
+            u64 StackPointer; /* Saved RSP while Switched Out */
+            Thread* Next; /* Run List Links */
+            Thread* Prev;
+            volatile ThreadState State;
+            bool Active; /* Running or Queued, Cleared once a Blocked Thread is Switched Out */
+            u8 Priority;
+            u32 Cpu; /* Run Queue it's on, or last ran on */
+            bool Bound; /* Affinity is a Single Processor */
+            u64 Affinity[KERNEL_SCHED_MASKWORDS]; /* Processors it may Run on */
+            u32 Slice; /* Ticks left of its Time Slice */
+            u64 Id;
+            const char* Name;
+            ThreadRoutine Routine;
+            void* Context;
+            u8* ExtendedState; /* x87/SSE/AVX Save Area, see Fpu */
+            u32 ExtendedCpu; /* Processor its Extended State was last Loaded on */
+            void* Worker; /* Workqueue Worker it Runs, Told when it Blocks */
+        };
+
+        /// @brief Per-CPU Run Queue
+        struct RunQueue {
+            Tools::KernelRTL::TicketLock Lock; /* Taken with Interrupts Disabled */
+            u32 Bitmap = 0; /* Bit N is Set if Heads[N] is Non-Empty */
+            u32 Queued = 0; /* Waiting Threads, excluding Current */
+            Thread* Heads[KERNEL_SCHED_PRIORITIES] = {};
+            Thread* Tails[KERNEL_SCHED_PRIORITIES] = {};
+            Thread* Current = 0;
+            Thread* Idle = 0; /* Boot Context of the Processor, Never Queued */
+            Thread* Dead = 0; /* Exited Thread, Freed after Switching Away */
+            Thread* Migrating = 0; /* Left its Affinity, Woken elsewhere after Switching Away */
+            volatile bool NeedResched = false;
+            u8 ReschedVector = 0; /* IPI Vector that Kicks this Processor */
+            u32 BalanceTicks = 0;
+            u32 BalancePasses = 0;
+            u64 Switches = 0;
+        } __attribute__((aligned(64)));
+
+        static RunQueue RunQueues[KERNEL_SMP_MAXCPUS];
+
+        /// @brief Returns the Thread Running on the Executing Processor
+        static inline Thread* CurrentThread()
+        {
+            return PerCpu::Read(Running);
+        }
+
+        /// @brief Checks if a Thread's Affinity allows a Processor
+        static inline bool AllowedOn(Thread* Thd, u32 Cpu)
+        {
+            return Thd->Affinity[Cpu / 64] & (1ULL << (Cpu % 64));
+        }
+
+        /// @brief Checks if the Executing Processor should Reschedule
+        static inline bool NeedsResched()
+        {
+            RunQueue* Rq = &RunQueues[Smp::CurrentCpu()];
+            return Rq->NeedResched || Rq->Queued;
+        }
+
+        /// @brief Holds off Preemption (but not Interrupts) on the Executing Processor
+        static inline void PreemptDisable()
+        {
+            Preempt::Disable();
+        }
+
+        /// @brief Allows Preemption again, Nests with PreemptDisable()
+        static inline void PreemptEnable()
+        {
+            Preempt::Enable();
+        }
+
+        /// @brief Checks if Preemption is Held off on the Executing Processor
+        static inline bool PreemptDisabled()
+        {
+            return Preempt::Disabled();
+        }
+
+        static void Initialize();
+        static void InitializeCpu(u32 Cpu);
+        static Thread* CreateThread(const char* Name, ThreadRoutine Routine, void* Context, u8 Priority = KERNEL_SCHED_DEFAULTPRIORITY, u32 BoundCpu = KERNEL_SCHED_ANYCPU);
+        static void Yield();
+        static bool CanBlock();
+        static void PrepareToBlock();
+        static void CancelBlock();
+        static void Block();
+        static void Wake(Thread* Thd);
+        static bool SetAffinity(Thread* Thd, const u64* Mask);
+        static bool CanStopTick(u32 Cpu);
+        [[noreturn]] static void Exit();
+        static void Tick(u32 Cpu);
+        static void PreemptIrq();
+
+    private:
+        static Thread* Running; /* Per-CPU */
+
+        static void Schedule(bool Preempted = false);
+        static void FinishSwitch();
+        static void Enqueue(RunQueue* Rq, Thread* Thd);
+        static Thread* Dequeue(RunQueue* Rq);
+        static void Remove(RunQueue* Rq, Thread* Thd);
+        static Thread* Steal(u32 Cpu);
+        static Thread* StealFrom(u32 Cpu, u32 Victim);
+        static u32 FindBusiest(u32 Cpu, u32 Domain, u32 Minimum);
+        static void Balance(u32 Cpu);
+        static u32 SelectCpu(Thread* Thd);
+        static RunQueue* LockQueueOf(Thread* Thd);
+        static void Kick(u32 Cpu);
+        static void ReschedInterrupt(u8 Vector, void* Context);
+        [[noreturn]] static void ThreadMain(Thread* Thd);
+    };
+}
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_WORKQUEUE_HPP
+#define KERNEL_WORKQUEUE_HPP
+
+#include <kernel/sched/sched.hpp>
+#include <kernel/smp/smp.hpp>
+#include <kernel/time/timerwheel.hpp>
+#include <kernel/types.hpp>
+#include <tools/kernelrtl/spinlock.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_WORKQUEUE_MAXWORKERS 8 /* Threads per Pool */
+#define KERNEL_WORKQUEUE_UNBOUND KERNEL_SMP_MAXCPUS /* Index of the Unbound Pool */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Thread Pools running Deferred Work in Process Context
+    class Workqueue {
+    public:
+        typedef void (*WorkRoutine)(void* Context);
+
+        struct Pool;
+
+        /// @brief Work Item, Owned by the Caller
+        struct Work {
+            Work* Next;
+            WorkRoutine Routine;
+            void* Context;
+            Pool* Owner; /* Pool it was last Queued on */
+            volatile bool Pending; /* Queued, Cleared just before it Runs */
+        };
+
+        /// @brief Work Item Queued once a Timer Expires
+        struct DelayedWork {
+            Work Wk;
+            TimerWheel::Timer Tmr;
+            u32 Pool; /* Pool Index it's Queued on */
+        };
+
+        /// @brief Thread of a Pool
+        struct Worker {
+            Scheduler::Thread* Thd;
+            Pool* Owner;
+            Worker* NextIdle;
+            Work* Current;
+            bool Idle; /* Waiting for Work, on the Idle List */
+            bool Sleeping; /* Blocked inside a Work Item */
+        };
+
+        /// @brief Workers and Work of a Processor, or the Unbound Pool
+        struct Pool {
+            Tools::KernelRTL::TicketLock Lock; /* Taken with Interrupts Disabled */
+            Work* Head = 0;
+            Work* Tail = 0;
+            Worker* IdleList = 0;
+            u32 Running = 0; /* Workers not Idle and not Blocked */
+            u32 WorkerCount = 0;
+            u32 Cpu = 0; /* KERNEL_SCHED_ANYCPU for the Unbound Pool */
+            bool Ready = false;
+            u64 Processed = 0;
+            Worker Workers[KERNEL_WORKQUEUE_MAXWORKERS] = {};
+        } __attribute__((aligned(64)));
+
+        static Pool Pools[KERNEL_SMP_MAXCPUS + 1];
+
+        static void Initialize();
+        static void InitializeCpu(u32 Cpu);
+        static void InitializeWork(Work* Wk, WorkRoutine Routine, void* Context);
+        static bool Queue(Work* Wk);
+        static bool QueueOn(u32 Cpu, Work* Wk);
+        static bool QueueUnbound(Work* Wk);
+        static bool QueueDelayed(DelayedWork* Dw, u64 DelayNs);
+        static bool Cancel(Work* Wk);
+        static bool CancelDelayed(DelayedWork* Dw);
+        static void WorkerSleeping(Scheduler::Thread* Thd);
+        static void WorkerRunning(Scheduler::Thread* Thd);
+
+    private:
+        static void InitializePool(u32 Index, u32 Cpu);
+        static bool Insert(Pool* Target, Work* Wk);
+        static void WakeWorker(Pool* Target);
+        static Worker* CreateWorker(Pool* Target);
+        static void WorkerMain(void* Context);
+        static void DelayedTimer(void* Context);
+        static void CancelTimer(void* Context);
+    };
+}
+}
+
+#endif
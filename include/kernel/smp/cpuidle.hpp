@@ -0,0 +1,80 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_CPUIDLE_HPP
+#define KERNEL_CPUIDLE_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_CPUIDLE_MAXSTATES 7 /* C1 - C7, as Enumerated by CPUID Leaf 5 */
+#define KERNEL_CPUIDLE_MWAIT_BREAKONMASKED (1 << 0) /* MWAIT ECX, Masked Interrupts End the Wait */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Idle Driver, MONITOR/MWAIT with C-State Selection, HLT Fallback
+    class CpuIdle {
+    public:
+        /// @brief Processor Idle State
+        struct CState {
+            const char* Name;
+            u32 Hint; /* MWAIT EAX, Target C-State - 1 in Bits 7:4 */
+            u32 ExitLatencyUs;
+            u32 TargetResidencyUs; /* Shortest Idle Period worth Entering it for */
+        };
+
+        enum IdleMode : u8 {
+            RUNNING = 0,
+            HALTED = 1, /* In HLT, Woken by an Interrupt */
+            POLLING = 2 /* In MWAIT, Woken by a Write to Wakeup */
+        };
+
+        /// @brief Idle State and Statistics of a Processor
+        struct CpuState {
+            volatile u32 Wakeup; /* Monitored by MWAIT */
+            volatile IdleMode Mode;
+            u64 WakeRequest; /* TSC of the First Remote Wake, 0 if None */
+            u64 Entries[KERNEL_CPUIDLE_MAXSTATES];
+            u64 ResidencyCycles[KERNEL_CPUIDLE_MAXSTATES];
+            u64 Wakeups; /* Remote Wakes, with Latency Measured */
+            u64 MemoryWakeups; /* Remote Wakes that needed no IPI */
+            u64 WakeLatencyCycles;
+            u64 MaxWakeLatencyCycles;
+        } __attribute__((aligned(64)));
+
+        static CState States[KERNEL_CPUIDLE_MAXSTATES];
+        static u32 StateCount;
+        static bool MwaitSupported;
+        static CpuState Cpus[KERNEL_SMP_MAXCPUS];
+
+        static void Initialize();
+        static void Enter();
+        static bool Wake(u32 Cpu);
+        static void Dump();
+
+    private:
+        static bool BreakOnMasked;
+
+        static u32 SelectState(u64 ExpectedNs);
+    };
+}
+}
+
+#endif
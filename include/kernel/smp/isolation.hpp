@@ -0,0 +1,67 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_ISOLATION_HPP
+#define KERNEL_ISOLATION_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_ISOLATION_MASKWORDS (KERNEL_SMP_MAXCPUS / 64)
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Processors Reserved for Latency-Critical Threads (isolcpus=, nohz_full)
+    class Isolation {
+    public:
+        static u64 Isolated[KERNEL_ISOLATION_MASKWORDS];
+        static u64 NoHzFull[KERNEL_ISOLATION_MASKWORDS]; /* Isolated, Tick Stopped under a Single Thread */
+        static u64 Housekeeping[KERNEL_ISOLATION_MASKWORDS]; /* Registered, not Isolated and not Failed to Start */
+
+        /// @brief Checks if a Processor is Isolated
+        static inline bool IsIsolated(u32 Cpu)
+        {
+            return Isolated[Cpu / 64] & (1ULL << (Cpu % 64));
+        }
+
+        /// @brief Checks if a Processor Serves Interrupts and Unbound Threads
+        static inline bool IsHousekeeping(u32 Cpu)
+        {
+            return Housekeeping[Cpu / 64] & (1ULL << (Cpu % 64));
+        }
+
+        /// @brief Checks if a Processor may Stop its Tick while Busy
+        static inline bool IsNoHzFull(u32 Cpu)
+        {
+            return NoHzFull[Cpu / 64] & (1ULL << (Cpu % 64));
+        }
+
+        static void Initialize();
+        static u32 IrqCpu(u32 Cpu);
+        static void RemoveCpu(u32 Cpu);
+        static void Dump();
+
+    private:
+        static bool ParseCpuList(const char* List, u64* Mask);
+    };
+}
+}
+
+#endif
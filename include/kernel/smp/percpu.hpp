@@ -0,0 +1,119 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_PERCPU_HPP
+#define KERNEL_PERCPU_HPP
+
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+/* Places a Variable in the Per-CPU Template, Replicated for every Processor */
+#define KERNEL_PERCPU __attribute__((section(".percpu")))
+
+/* Bounds of the Per-CPU Template and the Bootstrap Processor's Copy (linker.ld) */
+extern "C" u8 PERCPU_START[];
+extern "C" u8 PERCPU_END[];
+extern "C" u8 PERCPU_BOOT[];
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Per-CPU Variables, Addressed through the GS Base
+    class PerCpu {
+    public:
+        /*
+            Per-CPU variables are defined once, with KERNEL_PERCPU, in
+            the .percpu section. Every processor gets its own copy of
+            that section, and its GS base holds the distance from the
+            section to its copy. Adding the GS base to the address of
+            a variable yields the executing processor's instance, so
+            an access is a single gs-prefixed instruction. There's no
+            CPU index lookup, lock or atomic, and copies don't share
+            cache lines, so hot counters don't bounce between cores.
+
+            The accessors are only atomic with respect to interrupts
+            on the same processor. A sequence of them is not, callers
+            that need that disable interrupts around it.
+
+            The template itself is never used after boot. It holds the
+            initial values each copy starts from.
+
+            Refer:
+            https://lwn.net/Articles/22911/
+            https://docs.kernel.org/core-api/this_cpu_ops.html
+        */
+
+        static u64 Offsets[]; /* Copy Address minus PERCPU_START, by CPU */
+
+        /// @brief Reads the Executing Processor's Instance of a Variable
+        /// @param Var Per-CPU Variable (KERNEL_PERCPU)
+        template <typename T>
+        static inline T Read(const T& Var)
+        {
+            T Value;
+            __asm__ volatile("mov %%gs:%1, %0" : "=r"(Value) : "m"(Var));
+            return Value;
+        }
+
+        /// @brief Writes the Executing Processor's Instance of a Variable
+        /// @param Var Per-CPU Variable (KERNEL_PERCPU)
+        /// @param Value Value to be Written
+        template <typename T>
+        static inline void Write(T& Var, T Value)
+        {
+            __asm__ volatile("mov %1, %%gs:%0" : "=m"(Var) : "r"(Value) : "memory");
+        }
+
+        /// @brief Adds to the Executing Processor's Instance of a Variable
+        /// @param Var Per-CPU Variable (KERNEL_PERCPU)
+        /// @param Delta Value to be Added (Wraps on Negative Deltas)
+        template <typename T>
+        static inline void Add(T& Var, T Delta)
+        {
+            __asm__ volatile("add %1, %%gs:%0" : "+m"(Var) : "r"(Delta) : "memory");
+        }
+
+        /// @brief Returns the Executing Processor's Instance of a Variable
+        /// @param Var Per-CPU Variable (KERNEL_PERCPU)
+        template <typename T>
+        static inline T* Local(T& Var)
+        {
+            return (T*)((u8*)&Var + Read(Offset));
+        }
+
+        /// @brief Returns another Processor's Instance of a Variable
+        /// @param Var Per-CPU Variable (KERNEL_PERCPU)
+        /// @param Cpu Logical CPU Index
+        template <typename T>
+        static inline T* Remote(T& Var, u32 Cpu)
+        {
+            return (T*)((u8*)&Var + Offsets[Cpu]);
+        }
+
+        static void InitializeBootCpu();
+        static bool Allocate(u32 Cpu);
+        static void Free(u32 Cpu);
+        static void Load(u32 Cpu);
+
+    private:
+        static u64 Offset; /* Per-CPU, the Executing Processor's Offsets[] Entry */
+    };
+}
+}
+
+#endif
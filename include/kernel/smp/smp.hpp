@@ -0,0 +1,79 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_SMP_HPP
+#define KERNEL_SMP_HPP
+
+#include <kernel/smp/percpu.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_SMP_MAXCPUS 256 /* Upper Bound for Per-CPU Tables */
+#define KERNEL_SMP_BOOTCPU 0 /* Logical Index of the Bootstrap Processor */
+#define KERNEL_SMP_TRAMPOLINE 0x8000 /* Physical Page the APs Start in, Below 1MB */
+#define KERNEL_SMP_STACKPAGES 4 /* Initial Stack of an Application Processor */
+#define KERNEL_SMP_INITDELAYUS 10000 /* INIT to Startup IPI */
+#define KERNEL_SMP_SIPIDELAYUS 200 /* Between Startup IPIs */
+#define KERNEL_SMP_ONLINETIMEOUTUS 100000 /* Startup IPI to Online */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Symmetric Multiprocessing Support Routines
+    class Smp {
+    public:
+        /// @brief Registry Entry of a Processor
+        struct CpuInfo {
+            u32 ApicId;
+            u32 AcpiId;
+            volatile bool Online;
+        };
+
+        static CpuInfo* Cpus;
+        static u32 CpuCount;
+        static volatile u32 OnlineCount;
+
+        /// @brief Returns the Logical Index of the Executing Processor
+        static inline u32 CurrentCpu()
+        {
+            /*
+                The index is a per-CPU variable, one GS-relative load.
+                Logical CPU indices are dense (0..N-1), unlike APIC IDs,
+                so they can index per-CPU tables directly.
+            */
+
+            return PerCpu::Read(CpuIndex);
+        }
+
+        static void InitializeBootCpu();
+        static void Initialize();
+        static void StartApplicationProcessors();
+        static u32 GetApicId(u32 Cpu);
+        [[noreturn]] static void Idle();
+
+    private:
+        static u32 CpuIndex; /* Per-CPU */
+
+        static void RegisterCpu(u32 ApicId, u32 AcpiId);
+        static bool StartCpu(u32 Cpu);
+        [[noreturn]] static void ApplicationProcessorMain(u64 Cpu);
+    };
+}
+}
+
+#endif
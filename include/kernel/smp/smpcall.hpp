@@ -0,0 +1,72 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_SMPCALL_HPP
+#define KERNEL_SMPCALL_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+#include <tools/kernelrtl/lockfree.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_SMPCALL_MASKWORDS (KERNEL_SMP_MAXCPUS / 64)
+#define KERNEL_SMPCALL_MANYBATCH 16 /* Requests CallMany() keeps in Flight, on the Caller's Stack */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Runs Functions on other Processors
+    class SmpCall {
+    public:
+        typedef void (*CallRoutine)(void* Context);
+
+        /// @brief Remote Call, Owned by the Caller
+        struct Request {
+            Tools::KernelRTL::MpscNode Node; /* First, Nodes are Cast back to Requests */
+            CallRoutine Routine;
+            void* Context;
+            volatile bool Busy; /* Queued or Running, not to be Reused */
+        };
+
+        /// @brief Call Queue of a Processor
+        struct CpuQueue {
+            Tools::KernelRTL::MpscQueue Pending;
+            u8 Vector;
+            u64 Calls; /* Requests Run */
+            u64 Interrupts; /* Batches Drained, Calls / Interrupts is the Batching */
+        } __attribute__((aligned(64)));
+
+        static CpuQueue Queues[KERNEL_SMP_MAXCPUS];
+
+        static void Initialize();
+        static void InitializeCpu(u32 Cpu);
+        static bool Queue(u32 Cpu, Request* Req);
+        static bool Call(u32 Cpu, CallRoutine Routine, void* Context);
+        static void CallMany(const u64* Mask, CallRoutine Routine, void* Context);
+        static void CallAll(CallRoutine Routine, void* Context);
+        static void ProcessPending();
+
+    private:
+        static bool Submit(u32 Cpu, Request* Req);
+        static void Wait(Request* Req);
+        static void CallInterrupt(u8 Vector, void* Context);
+    };
+}
+}
+
+#endif
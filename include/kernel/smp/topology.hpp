@@ -0,0 +1,85 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_TOPOLOGY_HPP
+#define KERNEL_TOPOLOGY_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+#include <tools/kernelrtl/spinlock.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_TOPOLOGY_MASKWORDS (KERNEL_SMP_MAXCPUS / 64)
+#define KERNEL_TOPOLOGY_NOLLC 0xFFFFFFFF /* Caches not Enumerated */
+
+/* CPUID Leaf 0x0B/0x1F Level Types (ECX[15:8]) */
+#define KERNEL_TOPOLOGY_LEVEL_INVALID 0
+#define KERNEL_TOPOLOGY_LEVEL_SMT 1
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Processor Topology (Threads, Cores, Caches and Packages)
+    class Topology {
+    public:
+        /// @brief Scheduling Domains, Nearest First
+        enum Level {
+            SMT = 0, /* Hardware Threads of a Core */
+            LLC = 1, /* Cores sharing the Last Level Cache */
+            PACKAGE = 2,
+            SYSTEM = 3,
+            LEVELS = 4
+        };
+
+        /// @brief Position of a Processor in the Topology Tree
+        struct CpuTopology {
+            u32 X2ApicId;
+            u32 Thread; /* Within its Core */
+            u32 Core; /* Within its Package */
+            u32 Package;
+            u32 LlcId; /* APIC ID without the Bits below the LLC */
+            bool Known; /* Enumerated, its Masks are Valid */
+            u64 Siblings[LEVELS][KERNEL_TOPOLOGY_MASKWORDS]; /* Processors Sharing each Level, itself Included */
+        } __attribute__((aligned(64)));
+
+        static CpuTopology Cpus[KERNEL_SMP_MAXCPUS];
+
+        /// @brief Checks if two Processors Share a Level
+        static inline bool Shares(u32 Cpu, u32 Other, Level Domain)
+        {
+            return Cpus[Cpu].Siblings[Domain][Other / 64] & (1ULL << (Other % 64));
+        }
+
+        static void Initialize();
+        static void InitializeCpu(u32 Cpu);
+        static Level Distance(u32 Cpu, u32 Other);
+        static void Dump();
+
+    private:
+        static Tools::KernelRTL::TicketLock Lock;
+        static u32 SmtShift; /* APIC ID Bits of the Thread */
+        static u32 PackageShift; /* APIC ID Bits below the Package */
+        static u32 LlcShift; /* APIC ID Bits below the LLC */
+
+        static u32 Enumerate();
+        static u32 EnumerateLlc();
+    };
+}
+}
+
+#endif
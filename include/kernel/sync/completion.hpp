@@ -0,0 +1,69 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_COMPLETION_HPP
+#define KERNEL_COMPLETION_HPP
+
+#include <kernel/sync/waitqueue.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_COMPLETION_ALL 0xFFFFFFFF /* CompleteAll(), every Wait() Returns */
+#define KERNEL_COMPLETION_TESTROUNDS 100000 /* Round Trips of the KERNEL_SYNC_SELFTEST Ping-Pong */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief One-Shot Event, Wait() Sleeps till another Context Signals it
+    class Completion {
+    public:
+        constexpr Completion(Tools::KernelRTL::LockClass* Class = 0)
+            : Done(0)
+            , Waiters(Class)
+        {
+        }
+
+        /// @brief Checks if Signalled, without Consuming it
+        inline bool IsDone()
+        {
+            return __atomic_load_n(&Done, __ATOMIC_ACQUIRE) != 0;
+        }
+
+        void Complete();
+        void CompleteAll();
+        void Wait();
+        bool TryWait();
+        void Reinitialize();
+
+#ifdef KERNEL_SYNC_SELFTEST
+        static void SelfTest();
+#endif
+
+    private:
+        u32 Done; /* Pending Signals, Guarded by the Waiters' Lock */
+        WaitQueue Waiters;
+
+#ifdef KERNEL_SYNC_SELFTEST
+        static void TestPing(void* Context);
+        static void TestPong(void* Context);
+#endif
+    };
+}
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_MUTEX_HPP
+#define KERNEL_MUTEX_HPP
+
+#include <kernel/sched/sched.hpp>
+#include <kernel/smp/smp.hpp>
+#include <kernel/sync/waitqueue.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_MUTEX_WAITERS 1ULL /* Owner Bit, Unlock() must Wake a Waiter */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Sleeping Lock, Spins while its Owner Runs on another Processor
+    class Mutex {
+    public:
+        constexpr Mutex(Tools::KernelRTL::LockClass* Class = 0)
+            : Owner(0)
+            , OwnerCpu(0)
+            , Waiters(Class)
+        {
+        }
+
+        /// @brief Acquires the Mutex, Sleeping till it's Free. Not in Interrupts
+        inline void Lock()
+        {
+            if (!TryLock())
+                LockSlow();
+        }
+
+        /// @brief Acquires the Mutex only if it's Free
+        /// @return True if Acquired, False otherwise
+        inline bool TryLock()
+        {
+            u64 Expected = 0;
+            if (!__atomic_compare_exchange_n(&Owner, &Expected, (u64)Scheduler::CurrentThread(), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                return false;
+
+            OwnerCpu = Smp::CurrentCpu();
+            return true;
+        }
+
+        /// @brief Releases the Mutex, Waking a Waiter if there's one
+        inline void Unlock()
+        {
+            u64 Expected = (u64)Scheduler::CurrentThread();
+            if (!__atomic_compare_exchange_n(&Owner, &Expected, 0, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+                UnlockSlow();
+        }
+
+        /// @brief Checks if the Mutex is Held
+        inline bool IsLocked()
+        {
+            return __atomic_load_n(&Owner, __ATOMIC_RELAXED) != 0;
+        }
+
+        /// @brief Returns the Owning Thread, 0 if Free
+        inline Scheduler::Thread* GetOwner()
+        {
+            return (Scheduler::Thread*)(__atomic_load_n(&Owner, __ATOMIC_RELAXED) & ~KERNEL_MUTEX_WAITERS);
+        }
+
+    private:
+        u64 Owner; /* Owning Thread (Stack Aligned) | KERNEL_MUTEX_WAITERS */
+        volatile u32 OwnerCpu; /* Processor it was Acquired on, a Hint for Spinning */
+        WaitQueue Waiters;
+
+        void LockSlow();
+        void UnlockSlow();
+        bool SpinOnOwner();
+    };
+}
+}
+
+#endif
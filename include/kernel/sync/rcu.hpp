@@ -0,0 +1,128 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_RCU_HPP
+#define KERNEL_RCU_HPP
+
+#include <kernel/sched/sched.hpp>
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+#include <tools/kernelrtl/spinlock.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_RCU_MASKWORDS (KERNEL_SMP_MAXCPUS / 64)
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Read-Copy-Update, Quiescent-State Based
+    class Rcu {
+    public:
+        /// @brief Deferred Reclamation Request, Embedded in the Object to be Freed
+        struct Head {
+            Head* Next;
+            void (*Routine)(Head* Hd);
+        };
+
+        /// @brief Marks the Start of a Read-Side Critical Section
+        static inline void ReadLock()
+        {
+            /*
+                A reader only has to keep its processor from passing
+                a quiescent state. Without preemption, that holds
+                till it blocks, so this compiles to nothing. Else
+                preemption is held off, a non-atomic per-CPU add.
+            */
+
+#ifndef KERNEL_SCHED_NOPREEMPT
+            Scheduler::PreemptDisable();
+#endif
+        }
+
+        /// @brief Marks the End of a Read-Side Critical Section
+        static inline void ReadUnlock()
+        {
+#ifndef KERNEL_SCHED_NOPREEMPT
+            Scheduler::PreemptEnable();
+#endif
+        }
+
+        /// @brief Loads an RCU Protected Pointer, inside a Read-Side Critical Section
+        template <typename T>
+        static inline T Dereference(T& Pointer)
+        {
+            /* A plain load on x86, ordered against the Publisher's Stores */
+            return __atomic_load_n(&Pointer, __ATOMIC_CONSUME);
+        }
+
+        /// @brief Publishes an RCU Protected Pointer, after its Target is Initialized
+        template <typename T>
+        static inline void Assign(T& Pointer, T Value)
+        {
+            __atomic_store_n(&Pointer, Value, __ATOMIC_RELEASE);
+        }
+
+        static void Initialize();
+        static void InitializeCpu(u32 Cpu);
+        static void Call(Head* Hd, void (*Routine)(Head* Hd));
+        static void Synchronize();
+        static void QuiescentState();
+        static void NoteContextSwitch(u32 Cpu);
+        static void Tick(u32 Cpu);
+        static void EnterIdle();
+        static void ExitIdle();
+        static void IrqEnter();
+        static bool NeedsCpu(u32 Cpu);
+
+    private:
+        /// @brief Grace Period and Callback State of a Processor
+        struct CpuData {
+            u64 NoticedGp; /* Grace Period this Processor last Saw Start */
+            volatile bool Quiescent; /* Passed a Quiescent State since Noticing */
+            volatile bool Extended; /* Idle, Skipped by Grace Periods */
+            bool IdleLoop;
+
+            /* Callbacks, Segmented by the Grace Period they Wait for */
+            Head* Next; /* Registered, no Grace Period Assigned yet */
+            Head** NextTail;
+            Head* Waiting; /* Invoked once WaitingGp Completes */
+            Head** WaitingTail;
+            u64 WaitingGp;
+            Head* Done; /* Ready, Invoked by the RCU SoftIrq */
+            Head** DoneTail;
+
+            u64 Invoked;
+        } __attribute__((aligned(64)));
+
+        static CpuData Cpus[KERNEL_SMP_MAXCPUS];
+        static Tools::KernelRTL::TicketLock Lock; /* Guards Grace Period State, never Readers */
+        static volatile u64 GpNumber; /* Last Grace Period Started */
+        static volatile u64 Completed; /* Last Grace Period Completed */
+        static u64 Requested; /* Last Grace Period Needed by a Callback */
+        static u64 OnlineMask[KERNEL_RCU_MASKWORDS];
+        static u64 PendingMask[KERNEL_RCU_MASKWORDS]; /* Processors yet to Report */
+
+        static void Process(u32 Cpu, bool Quiescent);
+        static u64 RequestGracePeriod();
+        static void StartGracePeriod();
+        static void InvokeCallbacks();
+    };
+}
+}
+
+#endif
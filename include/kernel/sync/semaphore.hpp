@@ -0,0 +1,67 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_SEMAPHORE_HPP
+#define KERNEL_SEMAPHORE_HPP
+
+#include <kernel/sync/waitqueue.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Counting Semaphore, Down() Sleeps while the Count is Zero
+    class Semaphore {
+    public:
+        constexpr Semaphore(u64 Count = 0, Tools::KernelRTL::LockClass* Class = 0)
+            : Count(Count)
+            , Waiters(Class)
+        {
+        }
+
+        /// @brief Takes a Unit only if one is Available
+        /// @return True if Taken, False otherwise
+        inline bool TryDown()
+        {
+            u64 Current = __atomic_load_n(&Count, __ATOMIC_RELAXED);
+            while (Current) {
+                if (__atomic_compare_exchange_n(&Count, &Current, Current - 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                    return true;
+            }
+
+            return false;
+        }
+
+        /// @brief Returns the Available Units
+        inline u64 GetCount()
+        {
+            return __atomic_load_n(&Count, __ATOMIC_RELAXED);
+        }
+
+        void Down();
+        void Up();
+
+    private:
+        u64 Count;
+        WaitQueue Waiters;
+    };
+}
+}
+
+#endif
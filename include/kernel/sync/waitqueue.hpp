@@ -0,0 +1,93 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_WAITQUEUE_HPP
+#define KERNEL_WAITQUEUE_HPP
+
+#include <kernel/sched/sched.hpp>
+#include <kernel/types.hpp>
+#include <tools/kernelrtl/spinlock.hpp>
+
+using namespace tacOS::Kernel;
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Threads Sleeping till a Condition becomes True
+    class WaitQueue {
+    public:
+        /// @brief Waiting Thread, on the Waiter's Stack
+        struct Entry {
+            Scheduler::Thread* Thd;
+            Entry* Next;
+            Entry* Prev;
+            bool Exclusive; /* Woken One at a Time by WakeOne() */
+            bool Queued; /* Cleared by the Waker, which Unlinks it */
+        };
+
+        Tools::KernelRTL::TicketLock Lock; /* Guards the Entries, Taken with Interrupts Disabled */
+
+        constexpr WaitQueue(Tools::KernelRTL::LockClass* Class = 0)
+            : Lock(Class)
+            , Head(0)
+            , Tail(0)
+        {
+        }
+
+        /// @brief Sleeps till a Condition is True, the Caller must be able to Block
+        /// @param Cond Callable returning bool, Evaluated after each Wakeup
+        template <typename Condition>
+        void Wait(Condition Cond)
+        {
+            Entry Wait = {};
+            for (;;) {
+                /* Queued and Marked Blocked first, a Wake() after the Check isn't Lost */
+                PrepareToWait(&Wait);
+                if (Cond())
+                    break;
+
+                Scheduler::Block();
+            }
+
+            FinishWait(&Wait);
+        }
+
+        /// @brief Checks if any Thread is Waiting, without the Lock
+        inline bool IsEmpty()
+        {
+            return __atomic_load_n(&Head, __ATOMIC_ACQUIRE) == 0;
+        }
+
+        void PrepareToWait(Entry* Wait, bool Exclusive = true);
+        void FinishWait(Entry* Wait);
+        bool WakeOne();
+        u32 WakeAll();
+        bool WakeOneLocked();
+        u32 WakeAllLocked();
+
+    private:
+        Entry* Head;
+        Entry* Tail;
+
+        void Add(Entry* Wait);
+        void Remove(Entry* Wait);
+        u32 WakeLocked(bool All);
+    };
+}
+}
+
+#endif
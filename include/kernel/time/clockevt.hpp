@@ -0,0 +1,86 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_CLOCKEVT_HPP
+#define KERNEL_CLOCKEVT_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_CLOCKEVT_PERIODIC (1 << 0)
+#define KERNEL_CLOCKEVT_ONESHOT (1 << 1)
+#define KERNEL_NSEC_PER_SEC 1000000000ULL
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Timer Event Devices (Programmable Interrupt Sources)
+    class ClockEvent {
+    public:
+        /// @brief A Device raising Interrupts on a Processor after a Delay
+        struct Device {
+            const char* Name;
+            u32 Features; /* KERNEL_CLOCKEVT_* */
+            u32 Rating; /* Higher is Preferred */
+            u32 Cpu; /* Processor receiving the Events */
+
+            u64 MinDeltaNs;
+            u64 MaxDeltaNs;
+
+            /* Fixed-Point (32.32) Conversion Factors */
+            u64 NsToTicksMult;
+            u64 TicksToNsMult;
+
+            void (*SetPeriodic)(Device* Dev, u64 PeriodNs);
+            void (*SetOneShot)(Device* Dev, u64 DeltaNs);
+            void (*Shutdown)(Device* Dev);
+            u64 (*Elapsed)(Device* Dev); /* Nanoseconds since last Programmed */
+
+            /* Invoked in Interrupt Context, Installed by the Tick Layer */
+            void (*EventHandler)(Device* Dev);
+            void* Context;
+        };
+
+        static Device* Devices[KERNEL_SMP_MAXCPUS];
+
+        /// @brief Computes 32.32 Conversion Factors from a Frequency
+        /// @param Dev Device to Update
+        /// @param Frequency Ticks per Second (below 2^32)
+        static inline void SetFrequency(Device* Dev, u64 Frequency)
+        {
+            Dev->NsToTicksMult = (Frequency << 32) / KERNEL_NSEC_PER_SEC;
+            Dev->TicksToNsMult = (KERNEL_NSEC_PER_SEC << 32) / Frequency;
+        }
+
+        static inline u64 NsToTicks(Device* Dev, u64 Ns)
+        {
+            return (u64)(((unsigned __int128)Ns * Dev->NsToTicksMult) >> 32);
+        }
+
+        static inline u64 TicksToNs(Device* Dev, u64 Ticks)
+        {
+            return (u64)(((unsigned __int128)Ticks * Dev->TicksToNsMult) >> 32);
+        }
+
+        static bool Register(Device* Dev);
+    };
+}
+}
+
+#endif
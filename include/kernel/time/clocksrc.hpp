@@ -0,0 +1,72 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_CLOCKSRC_HPP
+#define KERNEL_CLOCKSRC_HPP
+
+#include <kernel/time/clockevt.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_CLOCKSRC_SHIFT 32
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Free-Running Counters used as the System Clock
+    class ClockSource {
+    public:
+        /// @brief A Readable Counter of Known Frequency
+        struct Source {
+            const char* Name;
+            u32 Rating; /* Higher is Preferred */
+            u64 (*Read)(Source* Src);
+            u64 Mask; /* Counter Width, Deltas are Masked */
+            u64 Frequency; /* Hz */
+
+            /* Nanoseconds = (Cycles * Mult) >> KERNEL_CLOCKSRC_SHIFT */
+            u64 Mult;
+
+            /* Longest Interval before the Counter Wraps (Halved) */
+            u64 MaxIdleNs;
+            void* Context;
+        };
+
+        static Source* Current;
+
+        /// @brief Converts Counter Cycles to Nanoseconds without a Division
+        static inline u64 CyclesToNs(Source* Src, u64 Cycles)
+        {
+            return (u64)(((unsigned __int128)Cycles * Src->Mult) >> KERNEL_CLOCKSRC_SHIFT);
+        }
+
+        static void SetFrequency(Source* Src, u64 Frequency);
+        static bool Register(Source* Src);
+        static u64 Now();
+        static void Accumulate();
+
+    private:
+        /* Clock at the last Accumulation, Published under Sequence */
+        static volatile u32 Sequence;
+        static u64 BaseCycles;
+        static u64 BaseNs;
+    };
+}
+}
+
+#endif
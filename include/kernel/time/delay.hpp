@@ -0,0 +1,76 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_DELAY_HPP
+#define KERNEL_DELAY_HPP
+
+#include <asm/cpu.hpp>
+#include <asm/io.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_DELAY_SHIFT 32
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Calibrated Busy-Wait Delays
+    class Delay {
+    public:
+        /* TSC Cycles per Nanosecond, 32.32 Fixed-Point (0 until Calibrated) */
+        static u64 CyclesPerNs;
+
+        static void Calibrate(u64 TscFrequency);
+
+        /// @brief Spins for at least the given Nanoseconds
+        /// @param Ns Nanoseconds to Wait
+        static inline void Nanoseconds(u64 Ns)
+        {
+            /*
+                The TSC is read directly, without going through the
+                clock source. It never traps under virtualization,
+                unlike the port 0x80 write it replaces. PAUSE keeps
+                the spin from starving an SMT sibling.
+            */
+
+            if (!CyclesPerNs) {
+                /* Before Calibration, Fall Back to ~1us Port Writes */
+                for (u64 Us = 0; Us < (Ns + 999) / 1000; Us++)
+                    tacOS::ASM::IO::wait();
+
+                return;
+            }
+
+            u64 Cycles = (u64)(((unsigned __int128)Ns * CyclesPerNs) >> KERNEL_DELAY_SHIFT) + 1;
+            u64 Start = tacOS::ASM::Cpu::ReadTsc();
+
+            while (tacOS::ASM::Cpu::ReadTsc() - Start < Cycles)
+                tacOS::ASM::Cpu::Pause();
+        }
+
+        /// @brief Spins for at least the given Microseconds
+        /// @param Us Microseconds to Wait
+        static inline void Microseconds(u64 Us)
+        {
+            Nanoseconds(Us * 1000);
+        }
+    };
+}
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_TICK_HPP
+#define KERNEL_TICK_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/time/clockevt.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNEL_TICK_HZ 250
+#define KERNEL_TICK_PERIODNS (KERNEL_NSEC_PER_SEC / KERNEL_TICK_HZ)
+#define KERNEL_TICK_NOEVENT (~0ULL)
+#define KERNEL_TICK_MAXDEFERNS KERNEL_NSEC_PER_SEC /* Residual Tick of a NOHZ Full Processor */
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Periodic Tick, Tickless Idle and High-Resolution Timers
+    class Tick {
+    public:
+        typedef void (*TimerRoutine)(void* Context);
+
+        /// @brief High-Resolution One-Shot Timer, Fires on the Processor that Armed it
+        struct HrTimer {
+            HrTimer* Next;
+            u64 Expires; /* Nanoseconds, Processor Clock */
+            TimerRoutine Routine;
+            void* Context;
+            u32 Cpu;
+            bool Pending;
+        };
+
+        /// @brief Per-CPU Tick State
+        struct CpuTick {
+            ClockEvent::Device* Device;
+            u64 Base; /* Clock when the Device was last Programmed */
+            u64 Now; /* Base + Elapsed, Nanoseconds */
+            u64 NextTick; /* Deadline of the next Periodic Tick */
+            u64 NextEvent; /* Deadline the Device is Programmed for */
+            u64 SkippedTicks; /* Ticks not taken while Idle */
+            bool Periodic; /* Device has no One-Shot Mode */
+            bool Stopped; /* Tick Stopped while Idle */
+            bool FullStop; /* Stopped while Running a Single Thread (NOHZ Full) */
+            HrTimer* HrTimers; /* Sorted by Expires */
+        };
+
+        static volatile u64 Jiffies;
+        static CpuTick Ticks[KERNEL_SMP_MAXCPUS];
+
+        static void Initialize();
+        static void InstallDevice(ClockEvent::Device* Dev);
+        static u64 Now();
+
+        static void ArmHrTimer(HrTimer* Tmr, u64 DelayNs, TimerRoutine Routine, void* Context);
+        static bool CancelHrTimer(HrTimer* Tmr);
+
+        static void EnterIdle();
+        static void ExitIdle();
+        static void Restart();
+        static u64 ExpectedIdleNs();
+
+    private:
+        static void Update(CpuTick* Tck);
+        static u64 AdvanceTicks(CpuTick* Tck);
+        static void Program(CpuTick* Tck);
+        static void HandleEvent(ClockEvent::Device* Dev);
+        static void RunTimers();
+    };
+}
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef KERNEL_TIMERWHEEL_HPP
+#define KERNEL_TIMERWHEEL_HPP
+
+#include <kernel/smp/smp.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+/*
+    Wheel Geometry. The root level resolves single jiffies, each
+    outer level covers 64 slots of the level below it. Together
+    they reach 2^32 jiffies (~198 days at 250 Hz), later timers
+    are clamped to the last slot.
+*/
+
+#define TIMERWHEEL_ROOTBITS 8
+#define TIMERWHEEL_LEVELBITS 6
+#define TIMERWHEEL_ROOTSIZE (1 << TIMERWHEEL_ROOTBITS)
+#define TIMERWHEEL_LEVELSIZE (1 << TIMERWHEEL_LEVELBITS)
+#define TIMERWHEEL_ROOTMASK (TIMERWHEEL_ROOTSIZE - 1)
+#define TIMERWHEEL_LEVELMASK (TIMERWHEEL_LEVELSIZE - 1)
+#define TIMERWHEEL_LEVELS 4 /* Outer Levels */
+#define TIMERWHEEL_MAXDELTA 0xFFFFFFFFULL
+#define TIMERWHEEL_NOEXPIRY (~0ULL)
+
+/* Shift of an Outer Level's Slot Index within a Jiffy Count */
+#define TIMERWHEEL_LEVELSHIFT(Level) (TIMERWHEEL_ROOTBITS + ((Level) * TIMERWHEEL_LEVELBITS))
+
+namespace tacOS {
+namespace Kernel {
+    /// @brief Per-CPU Hierarchical Timing Wheel (Jiffy Resolution)
+    class TimerWheel {
+    public:
+        typedef void (*TimerRoutine)(void* Context);
+
+        enum State {
+            IDLE = 0,
+            QUEUED = 1, /* Linked into the Wheel of Cpu */
+            REMOTE = 2 /* Migrating, Queued at the next Run of Cpu */
+        };
+
+        /// @brief Timer linked into a Wheel Slot
+        struct Timer {
+            Timer* Next;
+            Timer** Prev; /* Link pointing at this Timer, for O(1) Removal */
+            u64 Expires; /* Jiffies */
+            TimerRoutine Routine;
+            void* Context;
+            u32 Cpu;
+            volatile u32 TimerState;
+        };
+
+        /// @brief Wheel of a single Processor
+        struct Base {
+            u64 Clock; /* Next Jiffy to be Processed */
+            u64 Pending; /* Timers in the Wheel */
+            Timer* volatile Remote; /* Migrated Timers, Pushed by other Processors */
+            Timer* Root[TIMERWHEEL_ROOTSIZE];
+            Timer* Levels[TIMERWHEEL_LEVELS][TIMERWHEEL_LEVELSIZE];
+        };
+
+        static Base Bases[KERNEL_SMP_MAXCPUS];
+
+        static void Initialize();
+        static void Arm(Timer* Tmr, u64 DelayNs, TimerRoutine Routine, void* Context);
+        static bool Cancel(Timer* Tmr);
+        static bool Migrate(Timer* Tmr, u32 Cpu, u64 DelayNs, TimerRoutine Routine, void* Context);
+
+        static bool HasExpired(u32 Cpu, u64 Jiffies);
+        static u64 NextExpiry(u32 Cpu);
+        static void Run(u32 CpuIndex, u64 Jiffies);
+
+    private:
+        static void Enqueue(Base* Wheel, Timer* Tmr);
+        static void Unlink(Timer* Tmr);
+        static bool Cascade(Base* Wheel, u32 Level);
+        static void DrainRemote(Base* Wheel);
+        static u64 GetExpires(u64 DelayNs);
+    };
+}
+}
+
+#endif
@@ -20,7 +20,9 @@
 #define TOOLS_REPLIB_HPP
 
 /* Include All Replacement Library Headers */
+#include <tools/kernelrtl/lockfree.hpp>
 #include <tools/kernelrtl/printf.hpp>
+#include <tools/kernelrtl/spinlock.hpp>
 #include <tools/kernelrtl/strings.hpp>
 
 #endif
\ No newline at end of file
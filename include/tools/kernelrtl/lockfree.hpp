@@ -0,0 +1,175 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TOOLS_REPLIB_LOCKFREE_HPP
+#define TOOLS_REPLIB_LOCKFREE_HPP
+
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+#define KERNELRTL_CACHELINE 64
+
+namespace tacOS {
+namespace Tools {
+    namespace KernelRTL {
+        /// @brief Link of an MpscQueue, Embedded in the Queued Object
+        struct MpscNode {
+            MpscNode* Next;
+        };
+
+        /// @brief Intrusive Lock-Free Multi-Producer Single-Consumer Queue
+        class MpscQueue {
+        public:
+            /*
+                Producers push onto a singly linked stack with one
+                compare-exchange, the consumer detaches the whole
+                stack with one exchange and reverses it into push
+                order. As nodes are never popped one at a time while
+                producers run, there is no ABA problem and no node is
+                ever seen half-linked.
+
+                Push() reports whether the queue was empty: only that
+                producer has to notify the consumer (e.g. with an IPI),
+                later ones are picked up by the same PopAll().
+
+                The head sits alone on its cache line, so producers
+                contending on it don't disturb neighbouring data.
+                Like SpscRing, it's empty when zeroed (a static, or
+                embedded in per-CPU tables) and has no constructor.
+
+                Refer:
+                https://www.kernel.org/doc/html/latest/core-api/kernel-api.html (Lock-less NULL terminated single linked list)
+                https://www.1024cores.net/home/lock-free-algorithms/queues
+            */
+
+            /// @brief Appends a Node, from any Processor or Context
+            /// @param Node Node to be Queued, Owned by the Queue till Popped
+            /// @return True if the Queue was Empty, the Consumer has to be Notified
+            inline bool Push(MpscNode* Node)
+            {
+                MpscNode* First = __atomic_load_n(&Head, __ATOMIC_RELAXED);
+                do {
+                    Node->Next = First;
+                } while (!__atomic_compare_exchange_n(&Head, &First, Node, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+                return First == 0;
+            }
+
+            /// @brief Detaches every Queued Node, Consumer Only
+            /// @return Nodes in Push Order, 0 if Empty
+            inline MpscNode* PopAll()
+            {
+                MpscNode* List = __atomic_exchange_n(&Head, (MpscNode*)0, __ATOMIC_ACQUIRE);
+                MpscNode* Ordered = 0;
+
+                while (List) {
+                    MpscNode* Next = List->Next;
+                    List->Next = Ordered;
+                    Ordered = List;
+                    List = Next;
+                }
+
+                return Ordered;
+            }
+
+            /// @brief Checks if Nodes are Queued
+            inline bool IsEmpty()
+            {
+                return __atomic_load_n(&Head, __ATOMIC_RELAXED) == 0;
+            }
+
+        private:
+            MpscNode* Head;
+        } __attribute__((aligned(KERNELRTL_CACHELINE)));
+
+        /// @brief Bounded Lock-Free Single-Producer Single-Consumer Ring
+        /// @tparam T Element Type, Copied in and out
+        /// @tparam Capacity Number of Slots, a Power of Two
+        template <typename T, u32 Capacity>
+        class SpscRing {
+            static_assert(Capacity && !(Capacity & (Capacity - 1)), "SpscRing Capacity must be a Power of Two");
+
+        public:
+            /*
+                Each side owns one index and only reads the other's.
+                Indices run freely and are masked on access, so a
+                full ring is Tail - Head == Capacity. Each side keeps
+                a cached copy of the other's index and reloads it only
+                when the ring looks full (or empty), so the shared
+                lines move between cores once per lap, not per item.
+                A zeroed ring is empty.
+
+                Refer:
+                https://www.kernel.org/doc/html/latest/core-api/circular-buffers.html
+            */
+
+            /// @brief Appends an Item, Producer Only
+            /// @return False if the Ring is Full
+            inline bool Push(const T& Item)
+            {
+                u32 Tail = Producer.Index;
+                if (Tail - Producer.Cached == Capacity) {
+                    Producer.Cached = __atomic_load_n(&Consumer.Index, __ATOMIC_ACQUIRE);
+                    if (Tail - Producer.Cached == Capacity)
+                        return false;
+                }
+
+                Slots[Tail & (Capacity - 1)] = Item;
+                __atomic_store_n(&Producer.Index, Tail + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+
+            /// @brief Removes the Oldest Item, Consumer Only
+            /// @return False if the Ring is Empty
+            inline bool Pop(T* Item)
+            {
+                u32 Head = Consumer.Index;
+                if (Head == Consumer.Cached) {
+                    Consumer.Cached = __atomic_load_n(&Producer.Index, __ATOMIC_ACQUIRE);
+                    if (Head == Consumer.Cached)
+                        return false;
+                }
+
+                *Item = Slots[Head & (Capacity - 1)];
+                __atomic_store_n(&Consumer.Index, Head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+
+            /// @brief Checks if Items are Queued, from either Side
+            inline bool IsEmpty()
+            {
+                return __atomic_load_n(&Producer.Index, __ATOMIC_ACQUIRE) == __atomic_load_n(&Consumer.Index, __ATOMIC_ACQUIRE);
+            }
+
+        private:
+            /// @brief Index owned by one Side, with its Copy of the Other's
+            struct SideIndex {
+                u32 Index;
+                u32 Cached;
+            } __attribute__((aligned(KERNELRTL_CACHELINE)));
+
+            SideIndex Producer; /* Tail */
+            SideIndex Consumer; /* Head */
+            T Slots[Capacity] __attribute__((aligned(KERNELRTL_CACHELINE)));
+        };
+    }
+}
+}
+
+#endif
@@ -0,0 +1,449 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TOOLS_REPLIB_SPINLOCK_HPP
+#define TOOLS_REPLIB_SPINLOCK_HPP
+
+#include <asm/cpu.hpp>
+#include <kernel/sched/preempt.hpp>
+#include <kernel/types.hpp>
+
+using namespace tacOS::Kernel;
+
+/*
+    Define KERNELRTL_LOCK_STATISTICS (see the Makefile) to compile
+    in per-class contention statistics. Without it, locks carry no
+    accounting fields and their fast paths are a single atomic.
+
+    Every lock holds off preemption from acquisition to release,
+    so a holder is never switched out or migrated, and the MCS
+    queue nodes stay on the processor that took them.
+*/
+
+#define KERNELRTL_QSPINLOCK_LOCKED 1
+#define KERNELRTL_QSPINLOCK_MAXNESTING 4 /* Task, SoftIRQ, IRQ, NMI */
+#define KERNELRTL_RWLOCK_WRITER (1U << 31)
+
+namespace tacOS {
+namespace Tools {
+    namespace KernelRTL {
+        /// @brief Contention Statistics shared by the Locks of a Class
+        struct LockClass {
+            const char* Name;
+            u64 Acquisitions;
+            u64 Contentions; /* Acquisitions that had to Spin */
+            u64 Spins;
+            u64 MaxHoldCycles;
+            LockClass* Next;
+            bool Registered;
+        };
+
+        /// @brief Records and Reports Lock Class Statistics
+        class LockStatistics {
+        public:
+            static LockClass* Classes;
+
+            static void Acquired(LockClass* Class, u64 Spins);
+            static void Released(LockClass* Class, u64 HeldCycles);
+            static void Dump();
+        };
+
+        /// @brief FIFO Spinlock for Short Critical Sections
+        class TicketLock {
+        public:
+            /*
+                A ticket lock hands the lock out in arrival order, so a
+                waiter cannot be starved by faster cores. Each waiter
+                takes a ticket with one atomic add, then spins reading
+                Owner. Waiters back off in proportion to their place in
+                line, which keeps the Owner line from being hammered.
+
+                All waiters spin on the same cache line, so a release
+                invalidates every waiting core. Heavily contended locks
+                should be a QueuedSpinLock instead.
+
+                Refer:
+                https://lwn.net/Articles/267968/
+            */
+
+            constexpr TicketLock([[maybe_unused]] LockClass* Class = 0)
+                : Value(0)
+#ifdef KERNELRTL_LOCK_STATISTICS
+                , Class(Class)
+                , AcquiredAt(0)
+#endif
+            {
+            }
+
+            /// @brief Acquires the Lock, Spinning till it's Free
+            inline void Lock()
+            {
+                Preempt::Disable();
+                u16 Ticket = __atomic_fetch_add(&Next, 1, __ATOMIC_RELAXED);
+                u64 Spins = 0;
+
+                for (;;) {
+                    u16 Current = __atomic_load_n(&Owner, __ATOMIC_ACQUIRE);
+                    if (Current == Ticket)
+                        break;
+
+                    for (u16 Wait = Ticket - Current; Wait; Wait--, Spins++)
+                        ASM::Cpu::Pause();
+                }
+
+                RecordAcquire(Spins);
+            }
+
+            /// @brief Acquires the Lock only if it's Free
+            /// @return True if Acquired, False otherwise
+            inline bool TryLock()
+            {
+                Preempt::Disable();
+                u32 Old = __atomic_load_n(&Value, __ATOMIC_RELAXED);
+                if ((u16)Old != (u16)(Old >> 16)
+                    || !__atomic_compare_exchange_n(&Value, &Old, Old + (1 << 16), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                    Preempt::Enable();
+                    return false;
+                }
+
+                RecordAcquire(0);
+                return true;
+            }
+
+            /// @brief Releases the Lock to the next Ticket
+            inline void Unlock()
+            {
+                RecordRelease();
+                __atomic_store_n(&Owner, (u16)(Owner + 1), __ATOMIC_RELEASE);
+                Preempt::Enable();
+            }
+
+            /// @brief Disables Interrupts, then Acquires the Lock
+            /// @return Saved RFLAGS, to be passed to UnlockIrqRestore()
+            inline u64 LockIrqSave()
+            {
+                u64 Flags = ASM::Cpu::SaveFlagsAndDisable();
+                Lock();
+                return Flags;
+            }
+
+            /// @brief Releases the Lock, then Restores Interrupts
+            /// @param Flags RFLAGS returned by LockIrqSave()
+            inline void UnlockIrqRestore(u64 Flags)
+            {
+                Unlock();
+                ASM::Cpu::RestoreFlags(Flags);
+            }
+
+            /// @brief Checks if the Lock is Held
+            inline bool IsLocked()
+            {
+                u32 Current = __atomic_load_n(&Value, __ATOMIC_RELAXED);
+                return (u16)Current != (u16)(Current >> 16);
+            }
+
+        private:
+            union {
+                u32 Value;
+                struct {
+                    u16 Owner; /* Ticket being Served */
+                    u16 Next; /* Ticket handed to the next Arrival */
+                };
+            };
+
+#ifdef KERNELRTL_LOCK_STATISTICS
+            LockClass* Class;
+            u64 AcquiredAt;
+
+            inline void RecordAcquire(u64 Spins)
+            {
+                LockStatistics::Acquired(Class, Spins);
+                AcquiredAt = ASM::Cpu::ReadTsc();
+            }
+
+            inline void RecordRelease()
+            {
+                LockStatistics::Released(Class, ASM::Cpu::ReadTsc() - AcquiredAt);
+            }
+#else
+            inline void RecordAcquire(u64) { }
+            inline void RecordRelease() { }
+#endif
+        };
+
+        /// @brief Queued (MCS) Spinlock for Contended Locks
+        class QueuedSpinLock {
+        public:
+            /*
+                An uncontended acquisition is one compare-exchange of a
+                32-bit word. Under contention, waiters form an MCS queue
+                and each spins on its own queue node, so a release only
+                touches the cache line of the next waiter. The queue
+                nodes are per-CPU (one per nesting level: task, softirq,
+                interrupt, NMI), so the lock itself stays 4 bytes.
+
+                The word holds a Locked byte and the Tail of the queue,
+                encoded as (CPU + 1, nesting level). The fast path only
+                succeeds on a zero word, so arrivals queue behind any
+                waiter and the lock stays fair.
+
+                Refer:
+                https://lwn.net/Articles/590243/
+                https://www.cs.rochester.edu/u/scott/papers/1991_TOCS_synch.pdf
+            */
+
+            /// @brief Node a Waiter Spins on, one per CPU per Nesting Level
+            struct QueueNode {
+                QueueNode* Next;
+                bool Ready; /* Set by the Predecessor, Waiter is now the Head */
+            };
+
+            constexpr QueuedSpinLock([[maybe_unused]] LockClass* Class = 0)
+                : Value(0)
+#ifdef KERNELRTL_LOCK_STATISTICS
+                , Class(Class)
+                , AcquiredAt(0)
+#endif
+            {
+            }
+
+            /// @brief Acquires the Lock, Queueing if it's Contended
+            inline void Lock()
+            {
+                Preempt::Disable();
+                u32 Expected = 0;
+                if (__atomic_compare_exchange_n(&Value, &Expected, KERNELRTL_QSPINLOCK_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                    RecordAcquire(0);
+                    return;
+                }
+
+                RecordAcquire(LockSlowPath());
+            }
+
+            /// @brief Acquires the Lock only if it's Free and Nobody is Queued
+            /// @return True if Acquired, False otherwise
+            inline bool TryLock()
+            {
+                Preempt::Disable();
+                u32 Expected = 0;
+                if (!__atomic_compare_exchange_n(&Value, &Expected, KERNELRTL_QSPINLOCK_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                    Preempt::Enable();
+                    return false;
+                }
+
+                RecordAcquire(0);
+                return true;
+            }
+
+            /// @brief Releases the Lock, the Queue Head takes it next
+            inline void Unlock()
+            {
+                RecordRelease();
+                __atomic_store_n(&Locked, 0, __ATOMIC_RELEASE);
+                Preempt::Enable();
+            }
+
+            /// @brief Disables Interrupts, then Acquires the Lock
+            /// @return Saved RFLAGS, to be passed to UnlockIrqRestore()
+            inline u64 LockIrqSave()
+            {
+                u64 Flags = ASM::Cpu::SaveFlagsAndDisable();
+                Lock();
+                return Flags;
+            }
+
+            /// @brief Releases the Lock, then Restores Interrupts
+            /// @param Flags RFLAGS returned by LockIrqSave()
+            inline void UnlockIrqRestore(u64 Flags)
+            {
+                Unlock();
+                ASM::Cpu::RestoreFlags(Flags);
+            }
+
+            /// @brief Checks if the Lock is Held
+            inline bool IsLocked()
+            {
+                return __atomic_load_n(&Locked, __ATOMIC_RELAXED);
+            }
+
+        private:
+            union {
+                u32 Value;
+                struct {
+                    u8 Locked;
+                    u8 Reserved;
+                    u16 Tail;
+                };
+            };
+
+            u64 LockSlowPath();
+
+#ifdef KERNELRTL_LOCK_STATISTICS
+            LockClass* Class;
+            u64 AcquiredAt;
+
+            inline void RecordAcquire(u64 Spins)
+            {
+                LockStatistics::Acquired(Class, Spins);
+                AcquiredAt = ASM::Cpu::ReadTsc();
+            }
+
+            inline void RecordRelease()
+            {
+                LockStatistics::Released(Class, ASM::Cpu::ReadTsc() - AcquiredAt);
+            }
+#else
+            inline void RecordAcquire(u64) { }
+            inline void RecordRelease() { }
+#endif
+        };
+
+        /// @brief Reader-Writer Spinlock for Read-Mostly Data
+        class RwSpinLock {
+        public:
+            /*
+                Readers share the lock, a writer holds it alone. The
+                word counts readers in its low bits, the top bit marks
+                a writer. A waiting writer sets the bit first and then
+                waits for readers to drain. New readers back off once
+                the bit is set, so a stream of readers can't starve it.
+
+                Hold times are only recorded for writers, as concurrent
+                readers don't have a single acquisition time.
+            */
+
+            constexpr RwSpinLock([[maybe_unused]] LockClass* Class = 0)
+                : Value(0)
+#ifdef KERNELRTL_LOCK_STATISTICS
+                , Class(Class)
+                , AcquiredAt(0)
+#endif
+            {
+            }
+
+            /// @brief Acquires the Lock Shared, Spinning while a Writer Holds or Waits
+            inline void ReadLock()
+            {
+                Preempt::Disable();
+                u64 Spins = 0;
+                for (;;) {
+                    u32 Old = __atomic_load_n(&Value, __ATOMIC_RELAXED);
+                    if (!(Old & KERNELRTL_RWLOCK_WRITER)
+                        && __atomic_compare_exchange_n(&Value, &Old, Old + 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                        break;
+
+                    ASM::Cpu::Pause();
+                    Spins++;
+                }
+
+#ifdef KERNELRTL_LOCK_STATISTICS
+                LockStatistics::Acquired(Class, Spins);
+#endif
+            }
+
+            /// @brief Releases a Shared Hold
+            inline void ReadUnlock()
+            {
+                __atomic_fetch_sub(&Value, 1, __ATOMIC_RELEASE);
+                Preempt::Enable();
+            }
+
+            /// @brief Acquires the Lock Exclusively
+            inline void WriteLock()
+            {
+                Preempt::Disable();
+                u64 Spins = 0;
+                for (;;) {
+                    u32 Old = __atomic_load_n(&Value, __ATOMIC_RELAXED);
+                    if (!(Old & KERNELRTL_RWLOCK_WRITER)
+                        && __atomic_compare_exchange_n(&Value, &Old, Old | KERNELRTL_RWLOCK_WRITER, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                        break;
+
+                    ASM::Cpu::Pause();
+                    Spins++;
+                }
+
+                /* New Readers are held off, wait for the Current ones */
+                while (__atomic_load_n(&Value, __ATOMIC_ACQUIRE) != KERNELRTL_RWLOCK_WRITER) {
+                    ASM::Cpu::Pause();
+                    Spins++;
+                }
+
+#ifdef KERNELRTL_LOCK_STATISTICS
+                LockStatistics::Acquired(Class, Spins);
+                AcquiredAt = ASM::Cpu::ReadTsc();
+#endif
+            }
+
+            /// @brief Releases an Exclusive Hold
+            inline void WriteUnlock()
+            {
+#ifdef KERNELRTL_LOCK_STATISTICS
+                LockStatistics::Released(Class, ASM::Cpu::ReadTsc() - AcquiredAt);
+#endif
+                __atomic_store_n(&Value, 0, __ATOMIC_RELEASE);
+                Preempt::Enable();
+            }
+
+            /// @brief Disables Interrupts, then Acquires the Lock Shared
+            /// @return Saved RFLAGS, to be passed to ReadUnlockIrqRestore()
+            inline u64 ReadLockIrqSave()
+            {
+                u64 Flags = ASM::Cpu::SaveFlagsAndDisable();
+                ReadLock();
+                return Flags;
+            }
+
+            /// @brief Releases a Shared Hold, then Restores Interrupts
+            /// @param Flags RFLAGS returned by ReadLockIrqSave()
+            inline void ReadUnlockIrqRestore(u64 Flags)
+            {
+                ReadUnlock();
+                ASM::Cpu::RestoreFlags(Flags);
+            }
+
+            /// @brief Disables Interrupts, then Acquires the Lock Exclusively
+            /// @return Saved RFLAGS, to be passed to WriteUnlockIrqRestore()
+            inline u64 WriteLockIrqSave()
+            {
+                u64 Flags = ASM::Cpu::SaveFlagsAndDisable();
+                WriteLock();
+                return Flags;
+            }
+
+            /// @brief Releases an Exclusive Hold, then Restores Interrupts
+            /// @param Flags RFLAGS returned by WriteLockIrqSave()
+            inline void WriteUnlockIrqRestore(u64 Flags)
+            {
+                WriteUnlock();
+                ASM::Cpu::RestoreFlags(Flags);
+            }
+
+        private:
+            u32 Value;
+
+#ifdef KERNELRTL_LOCK_STATISTICS
+            LockClass* Class;
+            u64 AcquiredAt;
+#endif
+        };
+    }
+}
+}
+
+#endif
@@ -28,6 +28,7 @@ namespace Tools {
     namespace KernelRTL {
         i32 strncmp(const char* s1, const char* s2, usize len);
         void* memset(void* ptr, u8 value, u64 num);
+        void* memcpy(void* dest, const void* src, u64 num);
     }
 }
 }
@@ -0,0 +1,103 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <kernel/interrupts/gdtdef.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Descriptor Tables of the Bootstrap Processor, Others are Allocated */
+__attribute__((aligned(0x10))) static Gdt::CpuTables BootCpuTables;
+Gdt::CpuTables* Gdt::Tables[KERNEL_SMP_MAXCPUS] = { &BootCpuTables };
+
+/// @brief Populates the GDT and TSS of a Processor
+/// @param Cpu Logical CPU Index
+/// @param CpuTbl Tables to use (0 for the Bootstrap Processor's Tables)
+void Gdt::Initialize(u32 Cpu, CpuTables* CpuTbl)
+{
+    /*
+        The GDT built by osloader.asm only holds a code segment. A
+        Task State Segment is needed for the Interrupt Stack Table
+        (IST). An IST entry makes the CPU switch to a known-good
+        stack on delivery. It is used for NMIs, Double Faults and
+        Machine Checks, which may arrive on a corrupt stack.
+
+        IST stacks are reset on every delivery, so vectors that can
+        nest must not use them. Device, timer and IPI vectors use a
+        dedicated per-CPU IRQ stack instead, switched to by the ISR
+        stubs in software when entering the outermost interrupt.
+
+        Refer:
+        https://wiki.osdev.org/Task_State_Segment#Long_Mode
+        Intel SDM Vol. 3A, Section 6.14.5 (Interrupt Stack Table)
+    */
+
+    if (CpuTbl)
+        Tables[Cpu] = CpuTbl;
+
+    CpuTables* Tbl = Tables[Cpu];
+    memset(&Tbl->Tss, 0, sizeof(TaskStateSegment));
+
+    Tbl->Entries[0] = 0;
+    Tbl->Entries[1] = (1ULL << 43) | (1ULL << 44) | (1ULL << 47) | (1ULL << 53); /* Code, Long Mode */
+    Tbl->Entries[2] = (1ULL << 41) | (1ULL << 44) | (1ULL << 47); /* Data, Writable */
+
+    /* 64-bit TSS Descriptor spans two Entries */
+    u64 TssBase = (u64)&Tbl->Tss;
+    u64 TssLimit = sizeof(TaskStateSegment) - 1;
+    Tbl->Entries[3] = (TssLimit & 0xFFFF)
+        | ((TssBase & 0xFFFFFF) << 16)
+        | (0x9ULL << 40) /* Available 64-bit TSS */
+        | (1ULL << 47) /* Present */
+        | (((TssLimit >> 16) & 0xF) << 48)
+        | (((TssBase >> 24) & 0xFF) << 56);
+    Tbl->Entries[4] = (TssBase >> 32);
+
+    /* Stacks grow down, IST Entries hold the Top */
+    for (u32 Ist = 0; Ist < GDT_IST_COUNT; Ist++)
+        Tbl->Tss.Ist[Ist] = (u64)&Tbl->IstStacks[Ist][GDT_ISTSTACK_SIZE];
+
+    Tbl->Tss.IoMapBase = sizeof(TaskStateSegment); /* No I/O Permission Bitmap */
+}
+
+/// @brief Loads the GDT and TSS of a Processor on the Executing Processor
+/// @param Cpu Logical CPU Index
+void Gdt::Load(u32 Cpu)
+{
+    GdtRegister Gdtr;
+    Gdtr.Base = (u64)Tables[Cpu]->Entries;
+    Gdtr.Limit = sizeof(Tables[Cpu]->Entries) - 1;
+
+    /* Reload CS through a Far Return, then the Data Segments and TR */
+    __asm__ volatile(
+        "lgdt %0\n"
+        "pushq %1\n"
+        "leaq 1f(%%rip), %%rax\n"
+        "pushq %%rax\n"
+        "lretq\n"
+        "1:\n"
+        "mov %2, %%ax\n"
+        "mov %%ax, %%ds\n"
+        "mov %%ax, %%es\n"
+        "mov %%ax, %%ss\n"
+        "ltr %w3"
+        :
+        : "m"(Gdtr), "i"(GDT_SELECTOR_KERNELCODE), "i"(GDT_SELECTOR_KERNELDATA), "r"((u16)GDT_SELECTOR_TSS)
+        : "rax", "memory");
+}
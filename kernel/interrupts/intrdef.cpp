@@ -16,10 +16,24 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <asm/cpu.hpp>
 #include <asm/io.hpp>
+#include <kernel/interrupts/gdtdef.hpp>
 #include <kernel/interrupts/intrdef.hpp>
+#include <kernel/interrupts/intrpoll.hpp>
+#include <kernel/interrupts/intrstat.hpp>
+#include <kernel/interrupts/softirq.hpp>
+#include <kernel/sched/fpu.hpp>
+#include <kernel/sched/sched.hpp>
+#include <kernel/sync/rcu.hpp>
+#include <kernel/time/tick.hpp>
 #include <drivers/hal/apic.hpp>
+#include <drivers/hal/hpet.hpp>
+#include <drivers/hal/lapictimer.hpp>
 #include <drivers/hal/pic8259.hpp>
+#include <drivers/hal/pmtimer.hpp>
+#include <drivers/hal/tsc.hpp>
+#include <drivers/ps2/keyboard.hpp>
 #include <tools/kernelrtl/kernelrtl.hpp>
 
 using namespace tacOS::Kernel;
@@ -29,43 +43,153 @@ using namespace tacOS::Tools::KernelRTL;
 
 namespace tacOS {
 namespace Kernel {
+    /* Vector Bindings of the Bootstrap Processor, Others are Allocated */
+    static Interrupt::VectorTable BootCpuVectorTable;
+    Interrupt::VectorTable* Interrupt::VectorTables[KERNEL_SMP_MAXCPUS] = { &BootCpuVectorTable };
+    KERNEL_PERCPU u32 Interrupt::NestingDepth;
+
     extern "C" void* IsrWrapperTable[];
-    extern "C" void InterruptHandler(u64 InterruptCode)
+
+    /// @brief Accounts Interrupt Entry, Called by the ISR Stubs with IF Clear
+    /// @param InterruptCode Vector being Delivered
+    /// @return Stack Top to switch to, or 0 to stay on the Current Stack
+    extern "C" u64 InterruptEnter(u64 InterruptCode)
+    {
+        /*
+            Exceptions are synchronous to the interrupted code and
+            stay on its stack (NMI, #DF and #MC arrive on IST stacks).
+            The outermost external interrupt moves to the per-CPU
+            IRQ stack, nested ones continue below it. Thread stacks
+            then only need room for a single interrupt frame.
+        */
+
+        if (InterruptCode < 32)
+            return 0;
+
+        u32 Depth = PerCpu::Read(Interrupt::NestingDepth);
+        PerCpu::Write(Interrupt::NestingDepth, Depth + 1);
+        if (Depth != 0)
+            return 0;
+
+        Rcu::IrqEnter();
+        return Gdt::GetIrqStackTop(Smp::CurrentCpu());
+    }
+
+    /// @brief Accounts Interrupt Exit, Called by the ISR Stubs with IF Clear
+    /// @param InterruptCode Vector being Returned from
+    extern "C" void InterruptExit(u64 InterruptCode)
     {
         if (InterruptCode < 32)
+            return;
+
+        /* The Stub is back on the Thread's Stack, it may be Switched Out */
+        PerCpu::Add(Interrupt::NestingDepth, (u32)-1);
+        if (PerCpu::Read(Interrupt::NestingDepth) == 0)
+            Scheduler::PreemptIrq();
+    }
+
+    extern "C" void InterruptHandler(u64 InterruptCode, Interrupt::CpuState* State)
+    {
+        Interrupt::VectorEntry* Entry = &Interrupt::VectorTables[Smp::CurrentCpu()]->Entries[InterruptCode];
+        Interrupt::Handler Routine = Rcu::Dereference(Entry->Routine); /* Handlers run as RCU Readers */
+        u64 EntryCycles = Cpu::ReadTsc();
+
+        if (InterruptCode == INTERRUPT_DEVICENOTAVAILABLE)
+            Fpu::DeviceNotAvailable();
+
+        else if (InterruptCode < 32)
             Interrupt::CpuException(InterruptCode);
 
-        else if (InterruptCode >= PIC8259_MIN_IRQ && InterruptCode <= PIC8259_MAX_IRQ)
+        else if (Routine) {
+            /*
+                Bound Vectors are delivered through the Local APIC.
+                Until EOI, the class of this vector stays in service
+                and the LAPIC holds back this and all lower classes.
+                Setting IF only lets more urgent classes through.
+            */
+
+            if (Entry->Nestable) {
+                Cpu::EnableInterrupts();
+                Routine((u8)InterruptCode, Entry->Context);
+                Cpu::DisableInterrupts();
+            } else
+                Routine((u8)InterruptCode, Entry->Context);
+
+            Apic::EndOfInterrupt();
+        }
+
+        else if (InterruptCode >= PIC8259_MIN_IRQ && InterruptCode <= PIC8259_MAX_IRQ) {
+            if (Pic8259::IsSpurious(InterruptCode)) {
+                InterruptStats::RecordSpurious(InterruptCode);
+                return;
+            }
+
             Pic8259::TranslateInterrupt(InterruptCode);
+        }
 
-        else {
-            /* TODO: Have Binding Functions for Custom Interrupts. */
-            __asm__ volatile("cli; hlt");
+        else if (InterruptCode == APIC_LAPIC_SPURIOUS_VECTOR) {
+            /* Spurious Interrupts must not be Acknowledged */
+            InterruptStats::RecordSpurious(InterruptCode);
+            return;
         }
+
+        else
+            Interrupt::UnhandledException(InterruptCode);
+
+        /* Account Top Half Time only, Bottom Halves run with IF Set */
+        InterruptStats::Record(InterruptCode, Cpu::ReadTsc() - EntryCycles);
+
+        /* Hardware is Acknowledged, Run Bottom Halves when leaving the Outermost Interrupt */
+        if (InterruptCode >= 32 && PerCpu::Read(Interrupt::NestingDepth) == 1 && SoftIrq::IsPending())
+            SoftIrq::Run();
     }
 
+    /* Define a Global Interrupt Descriptor Table, Shared by every Processor */
+    __attribute__((aligned(0x10))) static Interrupt::IdTableEntry IdTable[256];
+    static Interrupt::IdTableRegister Idtr;
+
     void Interrupt::Register()
     {
-        /* Define a Global Interrupt Descriptor Table */
-        __attribute__((aligned(0x10))) static IdTableEntry IdTable[256];
-        static IdTableRegister Idtr;
+        /* Build the GDT with a TSS, used for the Interrupt Stack Table */
+        Gdt::Initialize(KERNEL_SMP_BOOTCPU, 0);
 
         /* IDT Init */
         Idtr.base = (u64)&IdTable[0];
         Idtr.limit = sizeof(IdTable);
 
         /* Populate the Interrupt Descriptor Table */
-        for (u8 Offset = 0; Offset < INTERRUPT_ISRCOUNT; Offset++) {
+        for (u16 Offset = 0; Offset < INTERRUPT_ISRCOUNT; Offset++) {
             IdTableEntry* Idt = &IdTable[Offset];
             Idt->IsrLow = ((u64)IsrWrapperTable[Offset]) & 0xFFFF;
-            Idt->KernelCs = 0x08; /* What's GDT_OFFSET_KERNEL_CODE? */
+            Idt->KernelCs = GDT_SELECTOR_KERNELCODE;
             Idt->Ist = 0;
-            Idt->Attributes = 0x8E; /* What's this Flag? */
+            Idt->Attributes = INTERRUPT_GATE_ATTRIBUTES;
             Idt->IsrMid = ((u64)IsrWrapperTable[Offset] >> 16) & 0xFFFF;
             Idt->IsrHigh = ((u64)IsrWrapperTable[Offset] >> 32) & 0xFFFFFFFF;
             Idt->Reserved = 0;
         }
 
+        /* Exceptions that may arrive on a Corrupt Stack use the IST */
+        IdTable[2].Ist = GDT_IST_NMI;
+        IdTable[8].Ist = GDT_IST_DOUBLEFAULT;
+        IdTable[18].Ist = GDT_IST_MACHINECHECK;
+
+        /* Load the Tables on the Bootstrap Processor */
+        InitializeCpu(KERNEL_SMP_BOOTCPU);
+    }
+
+    /// @brief Loads the Descriptor Tables on the Executing Processor
+    /// @param Cpu Logical CPU Index, its GDT must be Initialized
+    void Interrupt::InitializeCpu(u32 Cpu)
+    {
+        /*
+            The IDT only holds ISR stub addresses, so one table serves
+            every processor. Per-CPU state is reached via the GDT and
+            TSS (IST stacks) and the per-CPU VectorTables instead.
+        */
+
+        Gdt::Load(Cpu);
+
         /*
             __asm__ executes traditional assembly block and it does
             not use GNU Extensions or extended assembly. (GCC asm()
@@ -82,16 +206,180 @@ namespace Kernel {
     }
 
     void Interrupt::InitHWInterrupts() {
+        /* Register the System Clock first, it also Calibrates Delays */
+        Hpet::Initialize();
+        PmTimer::Initialize();
+        Tsc::Initialize();
+
         /* Initialize Interrupt Controllers */
         Pic8259::Initialize();
         Pic8259::Disable(); // TODO: ADD APIC COMPATIBILITY CHECK BEFORE DISABLE!
 
+        /* Initialize Bottom Half Processing before Top Halves can Queue Work */
+        SoftIrq::Initialize();
+        Tick::Initialize();
+        InterruptPoll::Initialize();
+        Drivers::PS2::Keyboard::Initialize();
+
         /* Intiailize APIC Interrupts */
         Apic::Status ApicStatus = Apic::Initialize();
         if (!ApicStatus) printf("APIC Initialization Failed!");
 
+        /* Calibrate the LAPIC Timer, it drives the Tick from here on */
+        else if (!LapicTimer::Initialize()) printf("LAPIC Timer Initialization Failed!");
+
+        /* HPET Comparators take over the Tick if the LAPIC Timer is Unusable */
+        if (!ClockEvent::Devices[KERNEL_SMP_BOOTCPU]) Hpet::InitializeCpu(KERNEL_SMP_BOOTCPU);
+
         /* Enable HW Interrupts */
-        __asm__ volatile("sti");
+        Cpu::EnableInterrupts();
+    }
+
+    /// @brief Returns the Vector Range of an Allocatable Priority Class
+    static bool GetClassRange(Interrupt::PriorityClass Class, u16* First, u16* Last)
+    {
+        switch (Class) {
+        case Interrupt::DEVICE_LOW:
+            *First = 0x30, *Last = 0x6F;
+            return true;
+        case Interrupt::DEVICE:
+            *First = 0x70, *Last = 0xAF;
+            return true;
+        case Interrupt::DEVICE_HIGH:
+            *First = 0xB0, *Last = 0xDF;
+            return true;
+        case Interrupt::TIMER:
+            *First = 0xE0, *Last = 0xEF;
+            return true;
+        case Interrupt::IPI:
+            *First = 0xF0, *Last = 0xFE; /* 0xFF is the Spurious Vector */
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// @brief Reserves a free Vector on a Processor
+    /// @param Cpu Logical CPU Index that receives the Vector
+    /// @param Class Priority Class the Vector is taken from
+    /// @return Allocated Vector or 0 (if exhausted)
+    u8 Interrupt::AllocateVector(u32 Cpu, PriorityClass Class)
+    {
+        /*
+            Vector spaces are CPU-local. Each processor dispatches
+            through its own VectorTable, so the same vector number
+            can serve different devices on different processors.
+            This lets per-queue MSI-X interrupts scale with cores
+            instead of exhausting one global 8-bit vector space.
+        */
+
+        VectorTable* Table = VectorTables[Cpu];
+        u16 First, Last;
+        if (!Table || !GetClassRange(Class, &First, &Last))
+            return 0;
+
+        /* Remote Processors' Tables are Allocated from, Claim with an Exchange */
+        for (u16 Vector = First; Vector <= Last; Vector++) {
+            if (!__atomic_exchange_n(&Table->Entries[Vector].Allocated, true, __ATOMIC_ACQ_REL))
+                return (u8)Vector;
+        }
+
+        /* Device Classes degrade to a Lower Class rather than Failing */
+        if (Class == DEVICE_HIGH)
+            return AllocateVector(Cpu, DEVICE);
+        if (Class == DEVICE)
+            return AllocateVector(Cpu, DEVICE_LOW);
+
+        /* Vector Space Exhausted */
+        return 0;
+    }
+
+    /// @brief Returns a Vector to the free pool of a Processor
+    /// @param Cpu Logical CPU Index owning the Vector
+    /// @param Vector Previously Allocated Vector
+    void Interrupt::FreeVector(u32 Cpu, u8 Vector)
+    {
+        VectorTable* Table = VectorTables[Cpu];
+        if (!Table || Vector < INTERRUPT_DYNAMIC_MIN || Vector > INTERRUPT_DYNAMIC_MAX)
+            return;
+
+        UnbindHandler(Cpu, Vector);
+        __atomic_store_n(&Table->Entries[Vector].Allocated, false, __ATOMIC_RELEASE);
+    }
+
+    /// @brief Binds a Handler to a Vector on a Processor
+    /// @param Cpu Logical CPU Index
+    /// @param Vector Interrupt Vector
+    /// @param Routine Handler invoked on delivery
+    /// @param Context Opaque pointer passed to the Handler
+    /// @param Nestable Run the Handler with IF Set (Higher Classes may Preempt it)
+    /// @return True if Bound, False otherwise
+    bool Interrupt::BindHandler(u32 Cpu, u8 Vector, Handler Routine, void* Context, bool Nestable)
+    {
+        VectorTable* Table = VectorTables[Cpu];
+        if (!Table || Vector < 32)
+            return false;
+
+        /*
+            Handlers load the Routine, then the Context, as two reads.
+            Context is only written while no Routine is bound and no
+            handler still runs the last one, so a live vector is
+            unbound first. Context is published before the Routine.
+        */
+
+        if (Table->Entries[Vector].Routine)
+            UnbindHandler(Cpu, Vector);
+
+        Table->Entries[Vector].Context = Context;
+        Table->Entries[Vector].Nestable = Nestable;
+        Rcu::Assign(Table->Entries[Vector].Routine, Routine);
+        return true;
+    }
+
+    /// @brief Removes the Handler bound to a Vector on a Processor
+    /// @note Waits for a Grace Period, Handlers Running the old Routine are Done on Return
+    /// @param Cpu Logical CPU Index
+    /// @param Vector Interrupt Vector
+    void Interrupt::UnbindHandler(u32 Cpu, u8 Vector)
+    {
+        VectorTable* Table = VectorTables[Cpu];
+        if (!Table || !Table->Entries[Vector].Routine)
+            return;
+
+        /* Context stays Valid for Handlers that Loaded the Routine before it was Cleared */
+        Rcu::Assign(Table->Entries[Vector].Routine, (Handler)0);
+        Rcu::Synchronize();
+
+        Table->Entries[Vector].Context = 0;
+        Table->Entries[Vector].Nestable = false;
+    }
+
+    /// @brief Raises the Task Priority of the Executing Processor
+    /// @param Class Vectors of this Class and below are held Pending
+    /// @return Previous Priority, to be passed to LowerPriority
+    u8 Interrupt::RaisePriority(PriorityClass Class)
+    {
+        /*
+            Unlike masking with cli, raising the TPR keeps more
+            urgent classes deliverable. A section that only races
+            with device handlers raises to their class, and the
+            timer and IPIs continue to arrive on time. Priority is
+            never lowered here, so raises nest like IRQLs.
+        */
+
+        u8 Previous = Apic::GetTaskPriority();
+        if ((u8)Class > Previous)
+            Apic::SetTaskPriority((u8)Class);
+
+        return Previous;
+    }
+
+    /// @brief Restores the Task Priority saved by RaisePriority
+    /// @param Previous Priority returned by the matching RaisePriority
+    void Interrupt::LowerPriority(u8 Previous)
+    {
+        /* Held Vectors above Previous are Delivered once Lowered */
+        Apic::SetTaskPriority(Previous);
     }
 
     void Interrupt::UnhandledException(int Code)
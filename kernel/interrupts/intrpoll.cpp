@@ -0,0 +1,171 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/interrupts/intrpoll.hpp>
+#include <kernel/interrupts/softirq.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::ASM;
+
+/* Define Statics */
+InterruptPoll::PollList InterruptPoll::Lists[KERNEL_SMP_MAXCPUS];
+
+/// @brief Initializes the Polling Bottom Half
+void InterruptPoll::Initialize()
+{
+    /*
+        Taking one interrupt per event stops scaling at high event
+        rates. Drivers that opt in only take the first interrupt of
+        a burst: their top half masks the device interrupt and sch
+        -edules the device for polling. The POLL bottom half then
+        processes events in batches, and the interrupt is unmasked
+        only once a poll round comes up short (the queue ran dry).
+        Under load the device is serviced with no interrupts at all,
+        when idle it costs nothing.
+
+        Refer:
+        https://wiki.linuxfoundation.org/networking/napi
+        https://docs.kernel.org/networking/napi.html
+    */
+
+    SoftIrq::RegisterAction(SoftIrq::Type::POLL, Run);
+}
+
+/// @brief Prepares a Device Polling Context
+/// @param Context Polling Context, Embedded in the Driver
+/// @param Poll Routine that processes up to Budget Events
+/// @param DisableIrq Routine that masks the Device Interrupt
+/// @param EnableIrq Routine that unmasks the Device Interrupt
+/// @param Device Opaque Driver Pointer
+/// @param Weight Events processed per Poll before yielding to other Devices
+void InterruptPoll::Register(PollContext* Context, PollRoutine Poll, IrqControl DisableIrq,
+    IrqControl EnableIrq, void* Device, u32 Weight)
+{
+    Context->Next = 0;
+    Context->Poll = Poll;
+    Context->DisableIrq = DisableIrq;
+    Context->EnableIrq = EnableIrq;
+    Context->HasPending = 0;
+    Context->Device = Device;
+    Context->Weight = Weight;
+    Context->PollState = State::IDLE;
+    Context->Interrupts = 0;
+    Context->Polls = 0;
+    Context->Events = 0;
+}
+
+/// @brief Switches a Device to Polling Mode, called from its Top Half
+/// @param Context Device Polling Context
+/// @return False if the Device was already Scheduled
+bool InterruptPoll::Schedule(PollContext* Context)
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    Context->Interrupts++;
+
+    if (Context->PollState == State::SCHEDULED) {
+        Cpu::RestoreFlags(Flags);
+        return false;
+    }
+
+    /* Mask the Source, Events are picked up by Polling from here on */
+    Context->PollState = State::SCHEDULED;
+    Context->DisableIrq(Context);
+    Enqueue(&Lists[Smp::CurrentCpu()], Context);
+    SoftIrq::Raise(SoftIrq::Type::POLL);
+
+    Cpu::RestoreFlags(Flags);
+    return true;
+}
+
+/// @brief Appends a Context to a Poll List (Interrupts Disabled)
+void InterruptPoll::Enqueue(PollList* List, PollContext* Context)
+{
+    Context->Next = 0;
+    if (List->Tail)
+        List->Tail->Next = Context;
+    else
+        List->Head = Context;
+
+    List->Tail = Context;
+}
+
+/// @brief Switches a Device back to Interrupt Mode
+/// @param Context Device Polling Context (already Dequeued)
+void InterruptPoll::Complete(PollContext* Context)
+{
+    Context->PollState = State::IDLE;
+    Context->EnableIrq(Context);
+
+    /*
+        An event may have arrived between the last poll and the
+        unmask. Edge-triggered sources don't re-signal those, so
+        the driver is asked and the device re-scheduled if needed.
+    */
+
+    if (Context->HasPending && Context->HasPending(Context))
+        Schedule(Context);
+}
+
+/// @brief POLL Bottom Half, Polls Scheduled Devices within a Budget
+void InterruptPoll::Run()
+{
+    u32 Budget = KERNEL_INTRPOLL_BUDGET;
+    PollList* List = &Lists[Smp::CurrentCpu()];
+
+    while (Budget) {
+        /* Dequeue the next Device, Top Halves append with IF Clear */
+        Cpu::DisableInterrupts();
+        PollContext* Context = List->Head;
+        if (Context) {
+            List->Head = Context->Next;
+            if (!List->Head)
+                List->Tail = 0;
+        }
+
+        Cpu::EnableInterrupts();
+        if (!Context)
+            return;
+
+        u32 Weight = (Context->Weight < Budget) ? Context->Weight : Budget;
+        u32 Processed = Context->Poll(Context, Weight);
+        Context->Polls++;
+        Context->Events += Processed;
+        Budget -= (Processed < Budget) ? Processed : Budget;
+
+        if (Processed < Weight) {
+            /* Queue Ran Dry, Back to Interrupt Mode */
+            Cpu::DisableInterrupts();
+            Complete(Context);
+            Cpu::EnableInterrupts();
+        } else {
+            /* More Events likely, Round-Robin behind other Devices */
+            Cpu::DisableInterrupts();
+            Enqueue(List, Context);
+            Cpu::EnableInterrupts();
+        }
+
+        /* Guarantee Progress for Devices that Report no Work */
+        if (!Processed && Budget)
+            Budget--;
+    }
+
+    /* Budget Exhausted, Continue in the next Round */
+    if (List->Head)
+        SoftIrq::Raise(SoftIrq::Type::POLL);
+}
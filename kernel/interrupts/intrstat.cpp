@@ -0,0 +1,141 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <drivers/hal/tsc.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/interrupts/intrstat.hpp>
+#include <kernel/smp/isolation.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Statistics of the Bootstrap Processor, Others are Allocated */
+static InterruptStats::CpuStats BootCpuStats;
+InterruptStats::CpuStats* InterruptStats::Stats[KERNEL_SMP_MAXCPUS] = { &BootCpuStats };
+
+/// @brief Converts Recorded TSC Cycles for Display, Raw until Calibrated
+static u64 CyclesToNs(u64 Cycles)
+{
+    return (Tsc::Frequency) ? ClockSource::CyclesToNs(&Tsc::Clock, Cycles) : Cycles;
+}
+
+/// @brief Clears the Statistics of a Processor
+/// @param Cpu Logical CPU Index
+void InterruptStats::Reset(u32 Cpu)
+{
+    if (Stats[Cpu])
+        memset(Stats[Cpu], 0, sizeof(CpuStats));
+}
+
+/// @brief Writes a Summary of every Active Vector to the Kernel Log
+void InterruptStats::Dump()
+{
+    /*
+        Only vectors that fired (or were spurious) are listed, one
+        line per CPU and vector. Times are TSC deltas measured
+        around the top half (bottom halves are excluded), shown in
+        nanoseconds once the TSC is calibrated.
+        A noisy device shows up as a high count, a slow handler as
+        a high average or maximum.
+    */
+
+    Logging::LogMessage(Logging::LogLevel::INFO, "Interrupt Statistics (CPU VEC COUNT AVGNS MAXNS SPUR):");
+    for (u32 Cpu = 0; Cpu < KERNEL_SMP_MAXCPUS; Cpu++) {
+        if (!Stats[Cpu])
+            continue;
+
+        for (u32 Vector = 0; Vector < INTERRUPT_VECTORS; Vector++) {
+            VectorStats* Entry = &Stats[Cpu]->Vectors[Vector];
+            if (!Entry->Count && !Entry->Spurious)
+                continue;
+
+            printf("\n    ");
+            printf(Cpu);
+            printf(" 0x");
+            printf(Vector, 16);
+            printf(" ");
+            printf(Entry->Count);
+            printf(" ");
+            printf(CyclesToNs(Entry->Count ? (Entry->TotalCycles / Entry->Count) : 0));
+            printf(" ");
+            printf(CyclesToNs(Entry->MaxCycles));
+            printf(" ");
+            printf(Entry->Spurious);
+        }
+    }
+}
+
+/// @brief Writes each Processor's Interrupt Totals to the Kernel Log
+void InterruptStats::DumpCpus()
+{
+    /*
+        One line per processor, over every vector: the interrupts
+        taken and the time they took from the running thread. On
+        an isolated processor this is the jitter its thread sees,
+        ideally the residual tick alone with nohz_full. Reset() a
+        processor before a run to measure just that run.
+    */
+
+    Logging::LogMessage(Logging::LogLevel::INFO, "Interrupt Totals (CPU COUNT TOTALNS MAXNS ISOLATED):");
+    for (u32 Cpu = 0; Cpu < KERNEL_SMP_MAXCPUS; Cpu++) {
+        if (!Stats[Cpu])
+            continue;
+
+        u64 Count = 0, TotalCycles = 0, MaxCycles = 0;
+        for (u32 Vector = 0; Vector < INTERRUPT_VECTORS; Vector++) {
+            VectorStats* Entry = &Stats[Cpu]->Vectors[Vector];
+            Count += Entry->Count + Entry->Spurious;
+            TotalCycles += Entry->TotalCycles;
+            if (Entry->MaxCycles > MaxCycles)
+                MaxCycles = Entry->MaxCycles;
+        }
+
+        printf("\n    ");
+        printf(Cpu);
+        printf(" ");
+        printf(Count);
+        printf(" ");
+        printf(CyclesToNs(TotalCycles));
+        printf(" ");
+        printf(CyclesToNs(MaxCycles));
+        printf(Isolation::IsIsolated(Cpu) ? (char*)(Isolation::IsNoHzFull(Cpu) ? " NOHZ" : " YES") : (char*)" NO");
+    }
+}
+
+/// @brief Writes the log2 Latency Histogram of a Vector to the Kernel Log
+/// @param Cpu Logical CPU Index
+/// @param Vector Interrupt Vector
+void InterruptStats::DumpHistogram(u32 Cpu, u8 Vector)
+{
+    if (!Stats[Cpu])
+        return;
+
+    VectorStats* Entry = &Stats[Cpu]->Vectors[Vector];
+    Logging::LogMessage(Logging::LogLevel::INFO, "Interrupt Latency Histogram (CYCLES >= 2^N: COUNT):");
+    for (u32 Bucket = 0; Bucket < INTRSTAT_HISTBUCKETS; Bucket++) {
+        if (!Entry->Histogram[Bucket])
+            continue;
+
+        printf("\n    2^");
+        printf(Bucket);
+        printf(": ");
+        printf(Entry->Histogram[Bucket]);
+    }
+}
@@ -30,34 +30,83 @@
 %macro isr_wrapper 1
 isr_wrapper_%+%1:
 
+    ; The CPU pushes an error code only for some exceptions
+    ; (#DF, #TS, #NP, #SS, #GP, #PF, #AC, #CP, #VC, #SX). Push
+    ; a dummy code for the rest so that every wrapper builds
+    ; the same stack frame (Interrupt::StackState).
+%if !(%1 == 8 || (%1 >= 10 && %1 <= 14) || %1 == 17 || %1 == 21 || %1 == 29 || %1 == 30)
+    push 0
+%endif
+
+    ; Save every General Purpose Register. The interrupted
+    ; code may be anywhere (not just the hlt loop), and the
+    ; C++ handler is free to clobber caller-saved registers.
+    ; Registers are pushed in reverse order of the members in
+    ; Interrupt::CpuState, so RSP then points to the struct.
+    push r15
+    push r14
+    push r13
+    push r12
+    push r11
+    push r10
+    push r9
+    push r8
+    push rdi
+    push rsi
+    push rsp
+    push rbp
+    push rdx
+    push rcx
+    push rbx
+    push rax
+
     ; Providing parameters to CPP functions in long mode:
-    ; After mutliple failed attempts of using the 'push'
-    ; instruction in x64, I resorted to manually moving
-    ; the parameters to the registers.
-    ;
-    ; In x86-64 calling convention, the first six integer or 
-    ; pointer parameters are passed in registers (rdi, rsi, 
-    ; rdx, rcx, r8, r9), and any additional parameters are 
+    ; In x86-64 calling convention, the first six integer or
+    ; pointer parameters are passed in registers (rdi, rsi,
+    ; rdx, rcx, r8, r9), and any additional parameters are
     ; passed on the stack.
     ;
-    ; Example:
-    ; mov rdi, 66             ; First parameter
-    ; mov rsi, 65             ; Second parameter
-    ; mov rdx, 64             ; Third parameter
-    ; mov rcx, 63             ; Fourth parameter
-    ; mov r8, 62              ; Fifth parameter
-    ; mov r9, 61              ; Sixth parameter
-    ; sub rsp, 40             ; Allocate space for additional parameters on the stack
-    ;
-    ; mov qword [rsp], 60     ; Seventh parameter
-    ; mov qword [rsp + 8], 59 ; Eighth parameter
+    ; The CPU aligns RSP to 16 bytes before pushing its frame.
+    ; The 5 frame qwords, the error code and the 16 registers
+    ; add up to 22 qwords, so the stack is aligned for the call.
+
     ;
-    ; add rsp, 40             ; Restore the stack pointer after the call
+    ; InterruptEnter returns the per-CPU IRQ Stack when this
+    ; is the outermost interrupt (0 otherwise). RBX is callee
+    ; saved and already on the frame, so it keeps the frame
+    ; address across the call. The IRQ stack top is aligned.
 
     mov rdi, %+%1          ; Interrupt Code Parameter
-    sub rsp, 8             ; Align the stack
+    call InterruptEnter    ; Account Nesting, Get the IRQ Stack
+    mov rbx, rsp           ; Saved CPU State
+    test rax, rax
+    cmovnz rsp, rax        ; Switch Stacks if Outermost
+
+    mov rdi, %+%1          ; Interrupt Code Parameter
+    mov rsi, rbx           ; Saved CPU State Parameter
     call InterruptHandler  ; Call External C++ InterruptHandler
-    add rsp, 8             ; Restore the stack pointer (u64 is 8 bytes)
+
+    mov rsp, rbx           ; Back to the Interrupted Stack
+    mov rdi, %+%1          ; Interrupt Code Parameter
+    call InterruptExit     ; Account Nesting
+
+    pop rax
+    pop rbx
+    pop rcx
+    pop rdx
+    pop rbp
+    add rsp, 8             ; Skip the Saved RSP, iretq restores it
+    pop rsi
+    pop rdi
+    pop r8
+    pop r9
+    pop r10
+    pop r11
+    pop r12
+    pop r13
+    pop r14
+    pop r15
+    add rsp, 8             ; Discard the Error Code
 
     ; Return from Interrupt (64 bit instruction).
     iretq
@@ -69,8 +118,10 @@ isr_wrapper_%+%1:
 ; a common interrupt wrapper for N interrupts. Additionally,
 ; define total interrupt count for using them in %rep.
 
+extern InterruptEnter
 extern InterruptHandler ; Matches with interrupt.hpp
-%assign isr_count 50    ; Should Match with interrupt.hpp
+extern InterruptExit
+%assign isr_count 256   ; Should Match with interrupt.hpp
 
 %assign ihctr 0
 %rep isr_count
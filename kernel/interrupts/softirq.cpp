@@ -0,0 +1,181 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/interrupts/softirq.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::ASM;
+
+/* Define Statics */
+SoftIrq::CpuQueue SoftIrq::Queues[KERNEL_SMP_MAXCPUS];
+SoftIrq::Action SoftIrq::Actions[SoftIrq::Type::MAX];
+
+/// @brief Initializes Deferred Interrupt Work Processing
+void SoftIrq::Initialize()
+{
+    /*
+        Interrupt handlers are split into two halves. The top half
+        runs with interrupts disabled and does the bare minimum to
+        acknowledge the device. Everything else is queued to the
+        current processor and run by the bottom half with interr
+        -upts enabled, either while exiting the outermost interrupt
+        or from the idle loop.
+
+        Refer:
+        https://www.kernel.org/doc/htmldocs/kernel-hacking/basics-softirqs.html
+        https://lwn.net/Articles/520076/
+    */
+
+    for (u32 Cpu = 0; Cpu < KERNEL_SMP_MAXCPUS; Cpu++)
+        Queues[Cpu].TaskletTail = &Queues[Cpu].TaskletHead;
+
+    RegisterAction(Type::TASKLET, RunTasklets);
+}
+
+/// @brief Registers the Routine run for a Bottom Half Type
+/// @param SoftIrqType Bottom Half Type
+/// @param Routine Routine to run when Raised
+void SoftIrq::RegisterAction(Type SoftIrqType, Action Routine)
+{
+    Actions[SoftIrqType] = Routine;
+}
+
+/// @brief Marks a Bottom Half Type Pending on this Processor
+/// @param SoftIrqType Bottom Half Type
+void SoftIrq::Raise(Type SoftIrqType)
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    Queues[Smp::CurrentCpu()].Pending |= (1U << SoftIrqType);
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Runs Pending Bottom Halves of this Processor
+void SoftIrq::Run()
+{
+    /*
+        Pending types are snapshotted and cleared with interrupts
+        disabled, then run with interrupts enabled so top halves
+        keep getting acknowledged. Handlers may raise new work, so
+        the snapshot is repeated, but only KERNEL_SOFTIRQ_MAXRESTART
+        times. Whatever remains stays pending for the next interr
+        -upt exit or the idle loop. This bounds the time stolen
+        from the interrupted code.
+    */
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    CpuQueue* Queue = &Queues[Smp::CurrentCpu()];
+
+    /* Nested Interrupt Exit, Outer Run() continues the Work */
+    if (Queue->Running) {
+        Cpu::RestoreFlags(Flags);
+        return;
+    }
+
+    Queue->Running = true;
+    for (u32 Round = 0; Round < KERNEL_SOFTIRQ_MAXRESTART && Queue->Pending; Round++) {
+        u32 Pending = Queue->Pending;
+        Queue->Pending = 0;
+
+        Cpu::EnableInterrupts();
+        for (u32 SoftIrqType = 0; Pending; SoftIrqType++, Pending >>= 1) {
+            if ((Pending & 1) && Actions[SoftIrqType])
+                Actions[SoftIrqType]();
+        }
+
+        Cpu::DisableInterrupts();
+    }
+
+    Queue->Running = false;
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Queues a Tasklet on this Processor
+/// @param Task Tasklet (ignored if already Scheduled)
+void SoftIrq::ScheduleTasklet(Tasklet* Task)
+{
+    /* Claimed Atomically, Another Processor may Schedule it Concurrently */
+    if (__atomic_fetch_or(&Task->State, KERNEL_SOFTIRQ_TASKLET_SCHEDULED, __ATOMIC_ACQ_REL) & KERNEL_SOFTIRQ_TASKLET_SCHEDULED)
+        return;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    QueueTasklet(&Queues[Smp::CurrentCpu()], Task);
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Appends a Scheduled Tasklet to a Queue, Interrupts must be Disabled
+/// @param Queue Queue of this Processor
+/// @param Task Tasklet owning the SCHEDULED Bit
+void SoftIrq::QueueTasklet(CpuQueue* Queue, Tasklet* Task)
+{
+    Task->Next = 0;
+    *Queue->TaskletTail = Task;
+    Queue->TaskletTail = &Task->Next;
+    Queue->Pending |= (1U << Type::TASKLET);
+}
+
+/// @brief Runs Queued Tasklets, at most KERNEL_SOFTIRQ_TASKLETBUDGET
+void SoftIrq::RunTasklets()
+{
+    /* Detach the List, so Tasklets may Re-schedule themselves */
+    Cpu::DisableInterrupts();
+    CpuQueue* Queue = &Queues[Smp::CurrentCpu()];
+    Tasklet* Task = Queue->TaskletHead;
+    Queue->TaskletHead = 0;
+    Queue->TaskletTail = &Queue->TaskletHead;
+    Cpu::EnableInterrupts();
+
+    /*
+        SCHEDULED is cleared before the routine runs, so it may be
+        scheduled again meanwhile, possibly on another processor.
+        RUNNING keeps that processor from running it concurrently,
+        it re-queues the tasklet for its next round instead.
+    */
+
+    for (u32 Budget = KERNEL_SOFTIRQ_TASKLETBUDGET; Task && Budget; Budget--) {
+        Tasklet* Next = Task->Next;
+        if (__atomic_fetch_or(&Task->State, KERNEL_SOFTIRQ_TASKLET_RUNNING, __ATOMIC_ACQUIRE) & KERNEL_SOFTIRQ_TASKLET_RUNNING) {
+            Cpu::DisableInterrupts();
+            QueueTasklet(Queue, Task);
+            Cpu::EnableInterrupts();
+        } else {
+            __atomic_and_fetch(&Task->State, ~KERNEL_SOFTIRQ_TASKLET_SCHEDULED, __ATOMIC_ACQ_REL);
+            Task->Routine(Task->Context);
+            __atomic_and_fetch(&Task->State, ~KERNEL_SOFTIRQ_TASKLET_RUNNING, __ATOMIC_RELEASE);
+        }
+
+        Task = Next;
+    }
+
+    if (!Task)
+        return;
+
+    /* Budget Exhausted, Put the Remainder back in front */
+    Cpu::DisableInterrupts();
+    Tasklet* Last = Task;
+    while (Last->Next)
+        Last = Last->Next;
+
+    Last->Next = Queue->TaskletHead;
+    if (!Queue->TaskletHead)
+        Queue->TaskletTail = &Last->Next;
+
+    Queue->TaskletHead = Task;
+    Queue->Pending |= (1U << Type::TASKLET);
+    Cpu::EnableInterrupts();
+}
@@ -18,7 +18,9 @@
 
 #include <kernel/assert/logging.hpp>
 #include <kernel/mem/bootmem.hpp>
+#include <kernel/mem/numa.hpp>
 #include <kernel/mem/physicalmm.hpp>
+#include <kernel/mem/tlb.hpp>
 #include <kernel/mem/virtualmm.hpp>
 #include <tools/kernelrtl/kernelrtl.hpp>
 
@@ -31,6 +33,8 @@ extern void* KRNL_END;
 
 /* Define Statics */
 u64 BootMem::PhysicalFreeBlocks;
+static LockClass BootMemLockClass = { "bootmem" };
+TicketLock BootMem::Lock(&BootMemLockClass);
 u64 BootMem::PhysicalTotalBlocks;
 u64* BootMem::PhysicalMemoryMap;
 
@@ -119,6 +123,7 @@ BootMem::PhysicalAddress* BootMem::PhysicalMemoryAllocateBlock(u64 Size)
 
     /* Update Free Frames and Return Physical Address */
     PhysicalFreeBlocks -= Size;
+    AccountNodeBlocks(Frame, Size, false);
     return (PhysicalAddress*)(Frame * KERNEL_BOOTMEM_PMMGR_BLOCKSIZE);
 }
 
@@ -208,6 +213,7 @@ void BootMem::PhysicalMemoryFreeBlock(PhysicalAddress* AllocatedBlock, u64 Size)
 
     /* Mark as Free, Update Free Blocks */
     PhysicalFreeBlocks += Size;
+    AccountNodeBlocks(Frame, Size, true);
     for (u64 i = 0; i < Size; i++) {
         PhysicalMemoryMapUnset(Frame + i);
     }
@@ -221,16 +227,56 @@ u64 BootMem::GetPhysicalMemoryMapFreeIndex(u64 Blocks)
     if (PhysicalFreeBlocks < Blocks)
         return -1;
 
-    for (u64 i = 0; i < (PhysicalTotalBlocks / 64); i++) {
+    /* Prefer the Calling Processor's Node, then the Nearest ones */
+    if (Numa::NodeCount > 1) {
+        Numa::Node* Local = &Numa::Nodes[Numa::CurrentNode()];
+
+        for (u32 Fallback = 0; Fallback < Numa::NodeCount; Fallback++) {
+            u32 Node = Local->Fallback[Fallback];
+            if (Numa::Nodes[Node].FreeBlocks < Blocks)
+                continue;
+
+            for (u32 Range = 0; Range < Numa::RangeCount; Range++) {
+                if (Numa::Ranges[Range].Node != Node)
+                    continue;
+
+                u64 FirstFrame, EndFrame;
+                GetRangeFrames(&Numa::Ranges[Range], &FirstFrame, &EndFrame);
+
+                u64 Frame = SearchPhysicalMemoryMap(Blocks, FirstFrame, EndFrame);
+                if (Frame != -1)
+                    return Frame;
+            }
+        }
+    }
+
+    /* Memory Outside the SRAT, or Runs Crossing Nodes */
+    return SearchPhysicalMemoryMap(Blocks, 0, (PhysicalTotalBlocks / 64) * 64);
+}
+
+/// @brief Searches a Frame Range of the Bitmap for Contiguous Free Blocks
+/// @param FirstFrame First Frame to Search
+/// @param EndFrame Frame past the Last, the Run must End before it
+/// @return First Frame of the Run, -1 if None
+u64 BootMem::SearchPhysicalMemoryMap(u64 Blocks, u64 FirstFrame, u64 EndFrame)
+{
+    for (u64 i = (FirstFrame / 64); i < ((EndFrame + 63) / 64); i++) {
         /* Check if Block isn't Full */
         if (PhysicalMemoryMap[i] != 0xFFFFFFFFFFFFFFFF) {
             /* Check each bit in Block to find an Empty Address */
             for (u8 j = 0; j < 64; j++) {
                 u64 Bit = 1ULL << j;
+                u64 SearchIndex = (i * 64) + j;
+
+                if (SearchIndex < FirstFrame)
+                    continue;
+
+                if (SearchIndex + Blocks > EndFrame)
+                    return -1;
+
                 if (!(PhysicalMemoryMap[i] & Bit)) {
                     /* Check if requested Block Length is available */
                     u64 FreeBlocks = 0;
-                    u64 SearchIndex = (i * 64) + j;
 
                     for (u64 k = 0; k < Blocks; k++) {
                         if (!PhysicalMemoryMapTest(SearchIndex + k))
@@ -251,13 +297,71 @@ u64 BootMem::GetPhysicalMemoryMapFreeIndex(u64 Blocks)
     return -1;
 }
 
+/// @brief Converts a NUMA Memory Range to Whole Frames within the Bitmap
+void BootMem::GetRangeFrames(Numa::MemoryRange* Range, u64* FirstFrame, u64* EndFrame)
+{
+    u64 MapFrames = (PhysicalTotalBlocks / 64) * 64;
+    *FirstFrame = AlignAddressToPage(Range->Base) / KERNEL_BOOTMEM_PMMGR_BLOCKSIZE;
+    *EndFrame = (Range->Base + Range->Length) / KERNEL_BOOTMEM_PMMGR_BLOCKSIZE;
+
+    if (*EndFrame > MapFrames)
+        *EndFrame = MapFrames;
+
+    if (*FirstFrame > *EndFrame)
+        *FirstFrame = *EndFrame;
+}
+
+/// @brief Moves Blocks into or out of their Nodes' Free Counts (Lock Held)
+/// @param Freed true if the Blocks were Freed, false if Allocated
+void BootMem::AccountNodeBlocks(u64 Frame, u64 Size, bool Freed)
+{
+    for (u32 Range = 0; Range < Numa::RangeCount; Range++) {
+        u64 FirstFrame, EndFrame;
+        GetRangeFrames(&Numa::Ranges[Range], &FirstFrame, &EndFrame);
+
+        /* Blocks of the Allocation within this Range */
+        u64 Start = (Frame > FirstFrame) ? Frame : FirstFrame;
+        u64 End = ((Frame + Size) < EndFrame) ? (Frame + Size) : EndFrame;
+        if (Start >= End)
+            continue;
+
+        Numa::Node* Node = &Numa::Nodes[Numa::Ranges[Range].Node];
+        if (Freed)
+            Node->FreeBlocks += (End - Start);
+        else
+            Node->FreeBlocks -= (End - Start);
+    }
+}
+
+/// @brief Counts each NUMA Node's Total and Free Blocks, after Numa::Initialize()
+void BootMem::InitializeNodes()
+{
+    u64 Flags = Lock.LockIrqSave();
+
+    for (u32 Range = 0; Range < Numa::RangeCount; Range++) {
+        u64 FirstFrame, EndFrame;
+        GetRangeFrames(&Numa::Ranges[Range], &FirstFrame, &EndFrame);
+
+        Numa::Node* Node = &Numa::Nodes[Numa::Ranges[Range].Node];
+        for (u64 Frame = FirstFrame; Frame < EndFrame; Frame++) {
+            Node->TotalBlocks++;
+            if (!PhysicalMemoryMapTest(Frame))
+                Node->FreeBlocks++;
+        }
+    }
+
+    Lock.UnlockIrqRestore(Flags);
+}
+
 /// @brief Allocates blocks from Virtual Memory Space
 /// @param Size Number of Blocks to allocate
 /// @return Pointer to Block
 BootMem::VirtualAddress* BootMem::VirtAllocateBlock(u64 Size)
 {
     /* Allocate a Physical Memory Block */
+    u64 Flags = Lock.LockIrqSave();
     PhysicalAddress* BaseAlloc = PhysicalMemoryAllocateBlock(Size);
+    Lock.UnlockIrqRestore(Flags);
 
     /* Return 0 if Out of Memory */
     if (!BaseAlloc)
@@ -275,7 +379,9 @@ BootMem::VirtualAddress* BootMem::VirtAllocateBlock(u64 Size)
 void BootMem::VirtFreeBlock(VirtualAddress* AllocatedBlock, u64 Size)
 {
     VirtualAddress VirtBaseAlloc = ((u64)AllocatedBlock) - KERNEL_BOOTMEM_VMMGR_MAPOFFSET;
+    u64 Flags = Lock.LockIrqSave();
     PhysicalMemoryFreeBlock((PhysicalAddress*)VirtBaseAlloc, Size);
+    Lock.UnlockIrqRestore(Flags);
 }
 
 /// @brief Maps Physical Address to Virtual Address at Default Offset
@@ -287,12 +393,12 @@ void tacOS::Kernel::BootMem::PhysicalMemoryMapToOffset(PhysicalAddress BaseAddre
     u64 PDPTIndex = VirtualMemory::GetPDPTIndex(VirtBaseAddress);
     u64 PDTIndex = VirtualMemory::GetPDTIndex(VirtBaseAddress);
     u64 PTIndex = VirtualMemory::GetPTIndex(VirtBaseAddress);
+    u64 Flags = Lock.LockIrqSave();
 
     // lazy code. optimize on mvp.
     if (!osloader_pml4t.Entries[PML4Index]) {
         PhysicalAddress* AllocatedPDPT = PhysicalMemoryAllocateIDMappedBlock();
         osloader_pml4t.Entries[PML4Index] = (VirtualMemory::PML4Entry)AllocatedPDPT | 3;
-        FlushTLBCache();
 
         /* Debug. FUTURE: Improve */
         // printf("\n=> PDPT CREATED: 0x");
@@ -303,7 +409,6 @@ void tacOS::Kernel::BootMem::PhysicalMemoryMapToOffset(PhysicalAddress BaseAddre
     if (!PDPTable->Entries[PDPTIndex]) {
         PhysicalAddress* AllocatedPDT = PhysicalMemoryAllocateIDMappedBlock();
         PDPTable->Entries[PDPTIndex] = (VirtualMemory::PDPEntry)AllocatedPDT | 3;
-        FlushTLBCache();
 
         /* Debug. FUTURE: Improve */
         // printf("\n=> PDT CREATED: 0x");
@@ -314,17 +419,26 @@ void tacOS::Kernel::BootMem::PhysicalMemoryMapToOffset(PhysicalAddress BaseAddre
     if (!PDTable->Entries[PDTIndex]) {
         PhysicalAddress* AllocatedPT = PhysicalMemoryAllocateIDMappedBlock();
         PDTable->Entries[PDTIndex] = (VirtualMemory::PDEntry)AllocatedPT | 3;
-        FlushTLBCache();
 
         /* Debug. FUTURE: Improve */
         // printf("\n=> Page Table CREATED: 0x");
         // printf((u64) AllocatedPT, 16);
     }
 
-    /* Update the Page Table */
+    /*
+        Entries going from Not Present to Present need no TLB
+        invalidation (Intel SDM Vol. 3A, 4.10.4.3). A replaced
+        mapping may be cached by any processor, it's added to the
+        shootdown batch, sent by the caller's Tlb::Flush().
+    */
+
     VirtualMemory::PTable* PTable = (VirtualMemory::PTable*)VirtualMemory::GetBaseAddress(PDTable->Entries[PDTIndex]);
+    VirtualMemory::PTEntry Previous = PTable->Entries[PTIndex];
     PTable->Entries[PTIndex] = BaseAddress | 3;
-    FlushTLBCache();
+    if ((Previous & 1) && Previous != PTable->Entries[PTIndex])
+        Tlb::Invalidate(VirtBaseAddress);
+
+    Lock.UnlockIrqRestore(Flags);
 }
 
 void BootMem::InitPhysicalMemory(MBootDef::MemoryMap* MemoryMap)
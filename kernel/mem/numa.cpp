@@ -0,0 +1,271 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <drivers/acpi/acpidef.hpp>
+#include <drivers/acpi/acpipvdr.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/mem/bootmem.hpp>
+#include <kernel/mem/numa.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::Drivers::Acpi;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+Numa::Node Numa::Nodes[KERNEL_NUMA_MAXNODES];
+u32 Numa::NodeCount;
+Numa::MemoryRange Numa::Ranges[KERNEL_NUMA_MAXRANGES];
+u32 Numa::RangeCount;
+u32 Numa::CpuNodes[KERNEL_SMP_MAXCPUS];
+u8 Numa::Distances[KERNEL_NUMA_MAXNODES][KERNEL_NUMA_MAXNODES];
+
+/// @brief Reads the SRAT and SLIT, after ACPI and Smp::Initialize()
+void Numa::Initialize()
+{
+    /*
+        On multi-socket machines each package has its own memory
+        controller. Memory behind another package is reached over
+        the interconnect, with higher latency and less bandwidth.
+        The SRAT tags memory ranges and processors with proximity
+        domains, the SLIT gives the relative distance between them.
+
+        Each domain becomes a node. BootMem keeps a free count per
+        node and serves an allocation from the node of the calling
+        processor, falling back to the others nearest first. Memory
+        outside every SRAT range (or with no SRAT) is served last.
+
+        Refer:
+        https://www.kernel.org/doc/html/latest/mm/numa.html
+        https://uefi.org/htmlspecs/ACPI_Spec_6_4_html/05_ACPI_Software_Programming_Model/ACPI_Software_Programming_Model.html#system-resource-affinity-table-srat
+    */
+
+    AcpiDef::Address SratAddr;
+    if (!AcpiDef::GetTableBySignature(ACPI_SIG_SRAT, AcpiProvider::Xsdt, &SratAddr)) {
+        /* Uniform Memory, Everything is Node 0 */
+        NodeCount = 1;
+        Distances[0][0] = KERNEL_NUMA_LOCALDISTANCE;
+        return;
+    }
+
+    AcpiDef::Srat* Srat = (AcpiDef::Srat*)SratAddr;
+    u8* SratEntryPtr = (u8*)(Srat + 1);
+    u8* SratEnd = (u8*)Srat + Srat->Header.Length;
+
+    while (SratEntryPtr < SratEnd) {
+        AcpiDef::MadtEntryHeader* Header = (AcpiDef::MadtEntryHeader*)SratEntryPtr;
+        if (!Header->RecordLength)
+            break;
+
+        SratEntryPtr += Header->RecordLength;
+
+        switch (Header->EntryType) {
+        case AcpiDef::SratEntryType::PROCESSOR_APIC_AFFINITY: {
+            AcpiDef::SratProcessorApic* Entry = (AcpiDef::SratProcessorApic*)Header;
+            if (!(Entry->Flags & ACPI_SRAT_ENABLED))
+                break;
+
+            u32 Domain = Entry->ProximityDomainLow
+                | (Entry->ProximityDomainHigh[0] << 8)
+                | (Entry->ProximityDomainHigh[1] << 16)
+                | (Entry->ProximityDomainHigh[2] << 24);
+
+            AssignCpu(Entry->ApicId, Domain);
+            break;
+        }
+
+        case AcpiDef::SratEntryType::PROCESSOR_X2APIC_AFFINITY: {
+            AcpiDef::SratProcessorX2Apic* Entry = (AcpiDef::SratProcessorX2Apic*)Header;
+            if (Entry->Flags & ACPI_SRAT_ENABLED)
+                AssignCpu(Entry->X2ApicId, Entry->ProximityDomain);
+
+            break;
+        }
+
+        case AcpiDef::SratEntryType::MEMORY_AFFINITY: {
+            AcpiDef::SratMemory* Entry = (AcpiDef::SratMemory*)Header;
+            if (!(Entry->Flags & ACPI_SRAT_ENABLED) || !Entry->Length)
+                break;
+
+            u32 Node = GetNode(Entry->ProximityDomain);
+            if (Node == KERNEL_NUMA_NONODE)
+                break;
+
+            if (RangeCount == KERNEL_NUMA_MAXRANGES) {
+                Logging::LogMessage(Logging::LogLevel::WARNING, "More SRAT Memory Ranges than KERNEL_NUMA_MAXRANGES, Ignoring the Rest");
+                break;
+            }
+
+            Ranges[RangeCount].Base = Entry->BaseAddress;
+            Ranges[RangeCount].Length = Entry->Length;
+            Ranges[RangeCount].Node = Node;
+            RangeCount++;
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    if (!NodeCount)
+        NodeCount = 1;
+
+    ParseSlit();
+    for (u32 Node = 0; Node < NodeCount; Node++)
+        BuildFallback(Node);
+
+    /* Memory Allocated so far is Accounted to its Node from here on */
+    BootMem::InitializeNodes();
+    Dump();
+}
+
+/// @brief Finds the Node a Physical Address belongs to
+/// @return Node Index, KERNEL_NUMA_NONODE if no SRAT Range holds it
+u32 Numa::NodeOfAddress(u64 PhysicalAddress)
+{
+    for (u32 Range = 0; Range < RangeCount; Range++) {
+        if (PhysicalAddress >= Ranges[Range].Base && PhysicalAddress - Ranges[Range].Base < Ranges[Range].Length)
+            return Ranges[Range].Node;
+    }
+
+    return KERNEL_NUMA_NONODE;
+}
+
+/// @brief Returns the Relative Memory Distance between two Nodes
+/// @return KERNEL_NUMA_LOCALDISTANCE for the same Node, Larger is Further
+u8 Numa::Distance(u32 From, u32 To)
+{
+    if (From >= NodeCount || To >= NodeCount)
+        return 0xFF;
+
+    return Distances[From][To];
+}
+
+/// @brief Prints the Nodes, their Memory and Distances
+void Numa::Dump()
+{
+    printf("NUMA Nodes: ");
+    printf(NodeCount);
+    printf("\n");
+
+    for (u32 Node = 0; Node < NodeCount; Node++) {
+        printf("  Node ");
+        printf(Node);
+        printf(" (Domain ");
+        printf(Nodes[Node].Domain);
+        printf("): ");
+        printf(Nodes[Node].FreeBlocks * 4);
+        printf("KB Free of ");
+        printf(Nodes[Node].TotalBlocks * 4);
+        printf("KB, CPUs");
+
+        for (u32 Cpu = 0; Cpu < Smp::CpuCount; Cpu++) {
+            if (CpuNodes[Cpu] == Node) {
+                printf(" ");
+                printf(Cpu);
+            }
+        }
+
+        printf(", Distances");
+        for (u32 To = 0; To < NodeCount; To++) {
+            printf(" ");
+            printf(Distances[Node][To]);
+        }
+
+        printf("\n");
+    }
+}
+
+/// @brief Returns the Node of a Proximity Domain, Adding it if New
+/// @return Node Index, KERNEL_NUMA_NONODE past KERNEL_NUMA_MAXNODES
+u32 Numa::GetNode(u32 Domain)
+{
+    for (u32 Node = 0; Node < NodeCount; Node++) {
+        if (Nodes[Node].Domain == Domain)
+            return Node;
+    }
+
+    if (NodeCount == KERNEL_NUMA_MAXNODES) {
+        Logging::LogMessage(Logging::LogLevel::WARNING, "More Proximity Domains than KERNEL_NUMA_MAXNODES, Ignoring the Rest");
+        return KERNEL_NUMA_NONODE;
+    }
+
+    Nodes[NodeCount].Domain = Domain;
+    return NodeCount++;
+}
+
+/// @brief Places a Registered Processor on the Node of a Proximity Domain
+void Numa::AssignCpu(u32 ApicId, u32 Domain)
+{
+    u32 Node = GetNode(Domain);
+    if (Node == KERNEL_NUMA_NONODE)
+        return;
+
+    /* Processors the MADT didn't Register (Disabled) are Skipped */
+    for (u32 Cpu = 0; Cpu < Smp::CpuCount; Cpu++) {
+        if (Smp::Cpus[Cpu].ApicId == ApicId) {
+            CpuNodes[Cpu] = Node;
+            return;
+        }
+    }
+}
+
+/// @brief Fills the Distance Matrix from the SLIT, or with Defaults
+void Numa::ParseSlit()
+{
+    AcpiDef::Address SlitAddr;
+    AcpiDef::Slit* Slit = 0;
+    if (AcpiDef::GetTableBySignature(ACPI_SIG_SLIT, AcpiProvider::Xsdt, &SlitAddr))
+        Slit = (AcpiDef::Slit*)SlitAddr;
+
+    for (u32 From = 0; From < NodeCount; From++) {
+        for (u32 To = 0; To < NodeCount; To++) {
+            u64 Row = Nodes[From].Domain;
+            u64 Column = Nodes[To].Domain;
+
+            /* SLIT Indices are Proximity Domains */
+            if (Slit && Row < Slit->Localities && Column < Slit->Localities)
+                Distances[From][To] = Slit->Entries[(Row * Slit->Localities) + Column];
+            else
+                Distances[From][To] = (From == To) ? KERNEL_NUMA_LOCALDISTANCE : KERNEL_NUMA_REMOTEDISTANCE;
+        }
+    }
+}
+
+/// @brief Orders the Nodes by Distance from a Node, the Allocation Fallback
+void Numa::BuildFallback(u32 From)
+{
+    u32* Order = Nodes[From].Fallback;
+    Order[0] = From;
+    u32 Count = 1;
+
+    /* Insertion Sort, Ties keep Node Order */
+    for (u32 To = 0; To < NodeCount; To++) {
+        if (To == From)
+            continue;
+
+        u32 Position = Count++;
+        while (Position > 1 && Distances[From][Order[Position - 1]] > Distances[From][To]) {
+            Order[Position] = Order[Position - 1];
+            Position--;
+        }
+
+        Order[Position] = To;
+    }
+}
@@ -30,6 +30,8 @@ PhysicalMemory::PhysicalAddress* PhysicalMemory::AvailableBlocksPtr;
 u64 PhysicalMemory::TotalBlocksCount;
 u64 PhysicalMemory::FreeBlocksCount;
 u64 PhysicalMemory::TotalMemoryBytes;
+static LockClass PhysicalMemoryLockClass = { "physicalmm" };
+QueuedSpinLock PhysicalMemory::Lock(&PhysicalMemoryLockClass);
 
 /// @brief Initialization Routine for Physical Memory Manager
 void PhysicalMemory::Initialize()
@@ -65,13 +67,17 @@ void PhysicalMemory::Initialize()
 /// @brief Allocates a block of Physical Memory
 /// @return Pointer to the allocated block of Memory
 PhysicalMemory::PhysicalAddress* PhysicalMemory::AllocateBlock() {
-    if (FreeBlocksCount < 1)  // FUTURE: Don't Provide Addresses of Stack!      
+    u64 Flags = Lock.LockIrqSave();
+    if (FreeBlocksCount < 1) { // FUTURE: Don't Provide Addresses of Stack!
+        Lock.UnlockIrqRestore(Flags);
         return 0;
+    }
     
     /* Pop the Address off the stack */
     PhysicalAddress AllocatedBlock = *(--AvailableBlocksPtr);
     *AvailableBlocksPtr = 0;
     FreeBlocksCount--;
+    Lock.UnlockIrqRestore(Flags);
     
     /* Return Pointer to Allocated Address */
     return (PhysicalAddress*) AllocatedBlock;
@@ -80,16 +86,20 @@ PhysicalMemory::PhysicalAddress* PhysicalMemory::AllocateBlock() {
 /// @brief Frees a block of Physical Memory
 /// @param BaseAddress Pointer to an existing block of Memory
 void PhysicalMemory::FreeBlock(PhysicalAddress* BaseAddress) {
+    u64 Flags = Lock.LockIrqSave();
     *(AvailableBlocksPtr++) = (u64) BaseAddress;
     FreeBlocksCount++;
+    Lock.UnlockIrqRestore(Flags);
 }
 
 /// @brief Fetches the Current Memory Pool Statistics
 /// @return A MemoryStats Structure
 PhysicalMemory::MemoryStats PhysicalMemory::GetMemoryStatistics() {
     MemoryStats MemoryStatistics;
+    u64 Flags = Lock.LockIrqSave();
     MemoryStatistics.TotalBlocksCount = TotalBlocksCount;
     MemoryStatistics.FreeBlocksCount = FreeBlocksCount;
+    Lock.UnlockIrqRestore(Flags);
     MemoryStatistics.BlockSize = KERNEL_PHYSICALMM_BLOCKSIZE;
     return MemoryStatistics;
 }
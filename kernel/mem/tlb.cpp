@@ -0,0 +1,295 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <drivers/hal/apic.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/interrupts/intrdef.hpp>
+#include <kernel/mem/tlb.hpp>
+#include <kernel/mem/virtualmm.hpp>
+#include <kernel/smp/smpcall.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Drivers::HAL;
+
+/* Define Statics */
+Tlb::CpuShootdown Tlb::Cpus[KERNEL_SMP_MAXCPUS];
+u64 Tlb::ActiveMask[KERNEL_TLB_MASKWORDS];
+u64 Tlb::Generation;
+
+/// @brief Reloads CR3, Flushing every Non-Global Translation
+static inline void FlushAll()
+{
+    u64 Cr3;
+    __asm__ volatile("mov %%cr3, %0\n"
+                     "mov %0, %%cr3"
+                     : "=r"(Cr3)
+                     :
+                     : "memory");
+}
+
+/// @brief Drops the Reference a Processor holds on an Initiator's Request
+static inline void Release(Tlb::CpuShootdown* Initiator)
+{
+    /* Read before the Release, the Initiator may Reuse its Request after */
+    Tlb::ReclaimRoutine Reclaim = Initiator->Reclaim;
+    void* Context = Initiator->ReclaimContext;
+
+    if (__atomic_sub_fetch(&Initiator->Remaining, 1, __ATOMIC_ACQ_REL) == 0 && Reclaim)
+        Reclaim(Context);
+}
+
+/// @brief Sets up Shootdowns, the Bootstrap Processor Joins
+void Tlb::Initialize()
+{
+    /*
+        Every processor shares the kernel's page tables. When a
+        mapping that may be cached is changed, the others have to
+        drop it from their TLBs. Doing so per page with an IPI
+        each is ruinous, so invalidations are batched instead:
+
+        Invalidate() records a page in the executing processor's
+        batch. Flush() invalidates the batch locally, then sends
+        one IPI to every processor in ActiveMask, and waits till
+        each has flushed. Up to KERNEL_TLB_BATCHSIZE pages are
+        flushed with INVLPG, larger batches reload CR3 instead.
+        FlushDeferred() doesn't wait, a reclaim routine runs once
+        the last processor is done (e.g. to free unmapped pages).
+
+        An idle processor in MWAIT leaves ActiveMask (EnterLazy)
+        and isn't interrupted. It flushes everything on return
+        if a shootdown was sent in the meantime (ExitLazy).
+
+        Refer:
+        Intel SDM Vol. 3A, Section 4.10.5 (Propagation of Paging-Structure Changes to Multiple Processors)
+        https://www.kernel.org/doc/html/latest/x86/tlb.html
+    */
+
+    InitializeCpu(KERNEL_SMP_BOOTCPU);
+}
+
+/// @brief Makes the Executing Processor a Shootdown Target
+/// @param Cpu Logical CPU Index of the Executing Processor
+void Tlb::InitializeCpu(u32 Cpu)
+{
+    u8 Vector = Interrupt::AllocateVector(Cpu, Interrupt::IPI);
+    if (!Vector || !Interrupt::BindHandler(Cpu, Vector, ShootdownInterrupt, 0)) {
+        Logging::LogMessage(Logging::LogLevel::CRITICAL, "TLB Shootdown Vector Allocation Failed");
+        return;
+    }
+
+    /* Entries Cached before Joining may be Stale */
+    Cpus[Cpu].Vector = Vector;
+    FlushAll();
+    __atomic_or_fetch(&ActiveMask[Cpu / 64], 1ULL << (Cpu % 64), __ATOMIC_SEQ_CST);
+}
+
+/// @brief Adds a Page to the Executing Processor's Batch, Flushed by Flush()
+/// @param Address Virtual Address within the Page
+void Tlb::Invalidate(u64 Address)
+{
+    /*
+        The batch is per-CPU, the caller keeps from migrating
+        (Scheduler::PreemptDisable) till its Flush(). Interrupts
+        are disabled so a handler's own batch doesn't interleave.
+    */
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    Batch* Pending = &Cpus[Smp::CurrentCpu()].Pending;
+
+    if (Pending->Count < KERNEL_TLB_BATCHSIZE)
+        Pending->Addresses[Pending->Count++] = Address & ~(u64)KERNEL_VIRTMM_ADDRESSMASK;
+    else
+        Pending->Full = true;
+
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Makes the next Flush() Flush the Whole TLB
+void Tlb::InvalidateAll()
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    Cpus[Smp::CurrentCpu()].Pending.Full = true;
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Flushes the Batch on every Processor, Returns once all are Done
+void Tlb::Flush()
+{
+    Send(0, 0, true);
+}
+
+/// @brief Flushes the Batch on every Processor without Waiting
+/// @param Reclaim Routine run by the Last Processor to Flush, with Interrupts Disabled
+/// @param Context Opaque pointer passed to the Routine
+void Tlb::FlushDeferred(ReclaimRoutine Reclaim, void* Context)
+{
+    /* Reclaim runs in Interrupt Context, it mustn't take Locks held across a Flush */
+    Send(Reclaim, Context, false);
+}
+
+/// @brief Stops Shootdowns to the Executing Processor while it Idles, IF Clear
+void Tlb::EnterLazy()
+{
+    u32 Self = Smp::CurrentCpu();
+    if (!Cpus[Self].Vector)
+        return;
+
+    Cpus[Self].LazyGeneration = __atomic_load_n(&Generation, __ATOMIC_SEQ_CST);
+    __atomic_and_fetch(&ActiveMask[Self / 64], ~(1ULL << (Self % 64)), __ATOMIC_SEQ_CST);
+}
+
+/// @brief Resumes Shootdowns, Flushing if any were Missed, IF Clear
+void Tlb::ExitLazy()
+{
+    /*
+        Send() bumps Generation before reading ActiveMask, this
+        sets the bit before reading Generation. Either the sender
+        sees the bit and interrupts, or this sees the new count.
+    */
+
+    u32 Self = Smp::CurrentCpu();
+    if (!Cpus[Self].Vector)
+        return;
+
+    __atomic_or_fetch(&ActiveMask[Self / 64], 1ULL << (Self % 64), __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&Generation, __ATOMIC_SEQ_CST) != Cpus[Self].LazyGeneration) {
+        Cpus[Self].FullFlushes++;
+        FlushAll();
+    }
+}
+
+/// @brief Flushes Locally and Sends the Batch to the Active Processors
+void Tlb::Send(ReclaimRoutine Reclaim, void* Context, bool Wait)
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    u32 Self = Smp::CurrentCpu();
+    CpuShootdown* Me = &Cpus[Self];
+
+    if (!Me->Pending.Count && !Me->Pending.Full) {
+        Cpu::RestoreFlags(Flags);
+        if (Reclaim)
+            Reclaim(Context);
+
+        return;
+    }
+
+    /* Targets may still be Reading the previous Request, Serve others meanwhile */
+    while (__atomic_load_n(&Me->Remaining, __ATOMIC_ACQUIRE)) {
+        ProcessPending(Self);
+        SmpCall::ProcessPending();
+        Cpu::Pause();
+    }
+
+    Me->Request.Count = Me->Pending.Count;
+    Me->Request.Full = Me->Pending.Full;
+    for (u32 Page = 0; Page < Me->Pending.Count; Page++)
+        Me->Request.Addresses[Page] = Me->Pending.Addresses[Page];
+
+    Me->Pending.Count = 0;
+    Me->Pending.Full = false;
+    Me->Reclaim = Reclaim;
+    Me->ReclaimContext = Context;
+    Me->Shootdowns++;
+    if (Me->Request.Full)
+        Me->FullFlushes++;
+
+    FlushLocal(&Me->Request);
+
+    /* The Sender's own Reference keeps the Request from Completing while Targets are Added */
+    Me->Remaining = 1;
+    __atomic_add_fetch(&Generation, 1, __ATOMIC_SEQ_CST);
+
+    for (u32 Word = 0; Word < KERNEL_TLB_MASKWORDS; Word++) {
+        u64 Targets = __atomic_load_n(&ActiveMask[Word], __ATOMIC_SEQ_CST);
+        if (Word == Self / 64)
+            Targets &= ~(1ULL << (Self % 64));
+
+        while (Targets) {
+            u32 Target = (Word * 64) + __builtin_ctzll(Targets);
+            Targets &= Targets - 1;
+
+            __atomic_add_fetch(&Me->Remaining, 1, __ATOMIC_RELAXED);
+            __atomic_or_fetch(&Cpus[Target].Initiators[Self / 64], 1ULL << (Self % 64), __ATOMIC_RELEASE);
+            Apic::SendIpi(Smp::GetApicId(Target), APIC_LAPIC_ICR_FIXED | Cpus[Target].Vector);
+            Me->IpisSent++;
+        }
+    }
+
+    Release(Me);
+
+    /*
+        Waiting with interrupts disabled is safe, requests sent to
+        this processor are served from the loop. Two processors
+        waiting on each other both make progress. A target may be
+        waiting in SmpCall for this one with interrupts disabled
+        too, so remote calls are served here as well.
+    */
+
+    while (Wait && __atomic_load_n(&Me->Remaining, __ATOMIC_ACQUIRE)) {
+        ProcessPending(Self);
+        SmpCall::ProcessPending();
+        Cpu::Pause();
+    }
+
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Invalidates a Batch on the Executing Processor
+void Tlb::FlushLocal(Batch* Invalidations)
+{
+    if (Invalidations->Full) {
+        FlushAll();
+        return;
+    }
+
+    for (u32 Page = 0; Page < Invalidations->Count; Page++)
+        __asm__ volatile("invlpg (%0)" : : "r"(Invalidations->Addresses[Page]) : "memory");
+}
+
+/// @brief Serves every Request sent to a Processor
+/// @param Cpu Logical CPU Index of the Executing Processor
+void Tlb::ProcessPending(u32 Cpu)
+{
+    for (u32 Word = 0; Word < KERNEL_TLB_MASKWORDS; Word++) {
+        u64 Initiators = __atomic_exchange_n(&Cpus[Cpu].Initiators[Word], 0, __ATOMIC_ACQUIRE);
+        while (Initiators) {
+            CpuShootdown* Initiator = &Cpus[(Word * 64) + __builtin_ctzll(Initiators)];
+            Initiators &= Initiators - 1;
+
+            if (Initiator->Request.Full)
+                Cpus[Cpu].FullFlushes++;
+
+            FlushLocal(&Initiator->Request);
+            Release(Initiator);
+        }
+    }
+}
+
+/// @brief Serves Shootdowns sent to the Executing Processor, for Wait Loops with IF Clear
+void Tlb::ProcessPending()
+{
+    ProcessPending(Smp::CurrentCpu());
+}
+
+/// @brief Shootdown IPI
+void Tlb::ShootdownInterrupt(u8 Vector, void* Context)
+{
+    ProcessPending(Smp::CurrentCpu());
+}
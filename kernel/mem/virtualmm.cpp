@@ -18,7 +18,9 @@
 
 #include <kernel/assert/logging.hpp>
 #include <kernel/mem/bootmem.hpp>
+#include <kernel/mem/tlb.hpp>
 #include <kernel/mem/virtualmm.hpp>
+#include <kernel/sched/sched.hpp>
 #include <tools/kernelrtl/kernelrtl.hpp>
 
 using namespace tacOS::Kernel;
@@ -61,7 +63,32 @@ VirtualMemory::VirtualAddress* VirtualMemory::HardwareRemap(
 {
     /* UGLY CODE !!!, TEMPORARY */
     /* FUTURE: Impl. should use Virtual Address Manager, Include Security!!! */
+    Scheduler::PreemptDisable();
     BootMem::PhysicalMemoryMapToOffset((u64)BaseAddress, KERNEL_VIRTMM_HWMEM_MAPOFFSET);
+    Tlb::Flush();
+    Scheduler::PreemptEnable();
+    return (VirtualAddress*)((u64)BaseAddress + KERNEL_VIRTMM_HWMEM_MAPOFFSET);
+}
+
+/// @brief Maps an unaligned Memory-Mapped Hardware Range to Virtual Address Space
+/// @param BaseAddress Memory-Mapped Physical Address (need not be Page Aligned)
+/// @param Length Length of the Range in Bytes
+/// @return Memory-Mapped Virtual Address of BaseAddress
+VirtualMemory::VirtualAddress* VirtualMemory::HardwareRemap(
+    PhysicalMemory::PhysicalAddress* BaseAddress, u64 Length)
+{
+    /* Page Table Entries hold Frame Addresses, Map every Frame in Range */
+    u64 FrameAddress = ((u64)BaseAddress) & ~((u64)KERNEL_VIRTMM_PAGESIZE - 1);
+    u64 EndAddress = ((u64)BaseAddress) + Length;
+
+    /* A Remapped Range takes a single Shootdown, the Batch is Per-CPU */
+    Scheduler::PreemptDisable();
+    for (; FrameAddress < EndAddress; FrameAddress += KERNEL_VIRTMM_PAGESIZE)
+        BootMem::PhysicalMemoryMapToOffset(FrameAddress, KERNEL_VIRTMM_HWMEM_MAPOFFSET);
+
+    Tlb::Flush();
+    Scheduler::PreemptEnable();
+
     return (VirtualAddress*)((u64)BaseAddress + KERNEL_VIRTMM_HWMEM_MAPOFFSET);
 }
 
@@ -25,6 +25,7 @@ using namespace tacOS::Tools::KernelRTL;
 MBootDef::MultibootInfo* MBootProvider::MBootInfoPtr;
 MBootDef::MemoryMap* MBootProvider::MemoryMapPtr;
 MBootDef::MemoryInfo* MBootProvider::MemoryInfoPtr;
+const char* MBootProvider::CommandLine = "";
 
 /// @brief Parses Multiboot Structres and Inits appropriate structures
 /// @param MultibootInfoPtrAddress Multiboot2 Pointer Address from Bootloader
@@ -60,6 +61,11 @@ int MBootProvider::Initialize(u64 MultibootInfoPtrAddress)
             break;
         }
 
+        case MBootDef::Tag::BOOT_CMD_LINE: {
+            MBootProvider::CommandLine = ((MBootDef::BootCMDLine*)MBootInfoTag)->CmdLine;
+            break;
+        }
+
         default: {
             // printf("MBoot Tag Type ");
             // printf(Tag->TagType);
@@ -86,4 +92,33 @@ void MBootProvider::ProcessMemoryInfo(MBootDef::MemoryInfo* MemoryInfo)
     printf("\n    Upper Memory: ");
     printf(MemoryInfo->MemUpper);
     printf("KB\n\n");
-}
\ No newline at end of file
+}
+
+/// @brief Finds a Parameter on the Kernel Command Line
+/// @param Name Parameter Name, as in "name" or "name=value"
+/// @return Value (Terminated by a Space or Null), "" for a Flag, 0 if Absent
+const char* MBootProvider::GetParameter(const char* Name)
+{
+    usize Length = 0;
+    while (Name[Length])
+        Length++;
+
+    /* Parameters are Separated by Spaces */
+    for (const char* Token = CommandLine; *Token;) {
+        while (*Token == ' ')
+            Token++;
+
+        if (!strncmp(Token, Name, Length)) {
+            if (Token[Length] == '=')
+                return &Token[Length + 1];
+
+            if (Token[Length] == ' ' || !Token[Length])
+                return "";
+        }
+
+        while (*Token && *Token != ' ')
+            Token++;
+    }
+
+    return 0;
+}
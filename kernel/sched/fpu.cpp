@@ -0,0 +1,205 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/sched/fpu.hpp>
+#include <kernel/smp/percpu.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+Fpu::SaveMethod Fpu::Method;
+u64 Fpu::Features;
+u32 Fpu::StateSize;
+KERNEL_PERCPU Scheduler::Thread* Fpu::Owner;
+
+/// @brief Selects the Save Method, Called on the BSP before any Thread Exists
+void Fpu::Initialize()
+{
+    /*
+        osloader.asm enabled SSE, and XSAVE with x87, SSE and AVX
+        in XCR0. The instructions used to switch extended state
+        are picked from the best the processor supports:
+
+        XSAVES, compacted, skips components that are in their
+        initial state or unmodified since the last XRSTORS.
+        XSAVEOPT, the same optimizations in the standard format.
+        XSAVE, every enabled component. FXSAVE, x87 and SSE.
+
+        Switching lazily relies on the kernel never touching this
+        state itself, which is why it's built -mgeneral-regs-only.
+
+        Refer:
+        Intel SDM Vol. 1, Chapter 13 (Managing State Using the XSAVE Feature Set)
+        Intel SDM Vol. 3A, Section 13.4 (Designing OS Facilities for Saving x87 FPU, SSE and Extended States)
+    */
+
+    u32 Eax, Ebx, Ecx, Edx;
+    Cpu::Cpuid(1, 0, &Eax, &Ebx, &Ecx, &Edx);
+
+    Method = FXSAVE;
+    StateSize = KERNEL_FPU_FXSAVE_SIZE;
+    Features = 0;
+
+    /* CPUID.1:ECX.OSXSAVE[bit 27] reflects CR4.OSXSAVE */
+    if (Ecx & (1 << 27)) {
+        Features = Cpu::ReadXcr(0);
+        Method = XSAVE;
+
+        /* EBX of Sub-Leaf 0 is the Standard Size for the Enabled XCR0 */
+        Cpu::Cpuid(0xD, 0, &Eax, &Ebx, &Ecx, &Edx);
+        StateSize = Ebx;
+
+        /* EBX of Sub-Leaf 1 is the Compacted Size for XCR0 | IA32_XSS */
+        Cpu::Cpuid(0xD, 1, &Eax, &Ebx, &Ecx, &Edx);
+        if (Eax & (1 << 3)) {
+            Method = XSAVES;
+            StateSize = Ebx;
+        } else if (Eax & (1 << 0))
+            Method = XSAVEOPT;
+    }
+
+    static const char* const Names[] = { "FXSAVE", "XSAVE", "XSAVEOPT", "XSAVES" };
+    printf("Extended State Save Method: ");
+    printf((char*)Names[Method]);
+    printf(", Size: ");
+    printf(StateSize);
+    printf("\n");
+}
+
+/// @brief Starts Extended State Tracking on the Executing Processor
+void Fpu::InitializeCpu()
+{
+    /* State left by Boot Code is Discarded, the first use Faults (#NM) */
+    PerCpu::Write(Owner, (Scheduler::Thread*)0);
+    Cpu::WriteCr0(Cpu::ReadCr0() | ASM_CPU_CR0_TS);
+}
+
+/// @brief Places a Thread's Save Area right after its Thread Structure
+/// @param Thd Thread, Zeroed and followed by at least Alignment + StateSize Bytes
+void Fpu::InitializeThread(Scheduler::Thread* Thd)
+{
+    u8* Area = (u8*)(((u64)(Thd + 1) + KERNEL_FPU_AREA_ALIGN - 1) & ~(u64)(KERNEL_FPU_AREA_ALIGN - 1));
+
+    /*
+        An all-zero XSAVE header (XSTATE_BV) restores every
+        component to its initial state. The control words are
+        loaded regardless, so they're set to their defaults.
+    */
+
+    *(u16*)(Area + 0) = KERNEL_FPU_DEFAULT_FCW;
+    *(u32*)(Area + 24) = KERNEL_FPU_DEFAULT_MXCSR;
+    if (Method == XSAVES)
+        *(u64*)(Area + 520) = KERNEL_FPU_XCOMP_COMPACTED | Features;
+
+    Thd->ExtendedState = Area;
+    Thd->ExtendedCpu = KERNEL_FPU_NOCPU;
+}
+
+/// @brief Switches Extended State, Called by the Scheduler with Interrupts Disabled
+/// @param Prev Outgoing Thread
+/// @param Next Incoming Thread
+/// @param Cpu Logical CPU Index of the Executing Processor
+void Fpu::Switch(Scheduler::Thread* Prev, Scheduler::Thread* Next, u32 Cpu)
+{
+    /*
+        CR0.TS is Clear only while the registers hold the state of
+        the running thread, after it faulted (#NM) or kept its
+        ownership. A thread that never touches extended state
+        leaves TS Set, and is switched without saving anything.
+    */
+
+    u64 Cr0 = ASM::Cpu::ReadCr0();
+    if (!(Cr0 & ASM_CPU_CR0_TS)) {
+        if (Prev->State != Scheduler::DEAD)
+            Save(Prev->ExtendedState);
+        else
+            PerCpu::Write(Owner, (Scheduler::Thread*)0);
+    }
+
+    /* The Registers still hold Next's State if no one Loaded over it */
+    if (PerCpu::Read(Owner) == Next && Next->ExtendedCpu == Cpu) {
+        if (Cr0 & ASM_CPU_CR0_TS)
+            ASM::Cpu::ClearTaskSwitched();
+    } else if (!(Cr0 & ASM_CPU_CR0_TS))
+        ASM::Cpu::WriteCr0(Cr0 | ASM_CPU_CR0_TS);
+}
+
+/// @brief Device Not Available (#NM), Loads the Current Thread's State
+void Fpu::DeviceNotAvailable()
+{
+    /*
+        The previous owner was saved when it was switched out, so
+        the registers can be overwritten. Handlers share the state
+        of the thread they interrupted, and must not modify it.
+    */
+
+    Scheduler::Thread* Thd = Scheduler::CurrentThread();
+    Cpu::ClearTaskSwitched();
+    if (!Thd || !Thd->ExtendedState)
+        return;
+
+    Restore(Thd->ExtendedState);
+    Thd->ExtendedCpu = Smp::CurrentCpu();
+    PerCpu::Write(Owner, Thd);
+}
+
+/// @brief Saves the Enabled Extended State to a Save Area
+void Fpu::Save(u8* Area)
+{
+    u32 Low = (u32)Features;
+    u32 High = (u32)(Features >> 32);
+
+    switch (Method) {
+    case XSAVES:
+        __asm__ volatile("xsaves64 (%0)" : : "r"(Area), "a"(Low), "d"(High) : "memory");
+        break;
+    case XSAVEOPT:
+        __asm__ volatile("xsaveopt64 (%0)" : : "r"(Area), "a"(Low), "d"(High) : "memory");
+        break;
+    case XSAVE:
+        __asm__ volatile("xsave64 (%0)" : : "r"(Area), "a"(Low), "d"(High) : "memory");
+        break;
+    default:
+        __asm__ volatile("fxsave64 (%0)" : : "r"(Area) : "memory");
+        break;
+    }
+}
+
+/// @brief Loads the Enabled Extended State from a Save Area
+void Fpu::Restore(u8* Area)
+{
+    u32 Low = (u32)Features;
+    u32 High = (u32)(Features >> 32);
+
+    switch (Method) {
+    case XSAVES:
+        __asm__ volatile("xrstors64 (%0)" : : "r"(Area), "a"(Low), "d"(High) : "memory");
+        break;
+    case XSAVEOPT:
+    case XSAVE:
+        __asm__ volatile("xrstor64 (%0)" : : "r"(Area), "a"(Low), "d"(High) : "memory");
+        break;
+    default:
+        __asm__ volatile("fxrstor64 (%0)" : : "r"(Area) : "memory");
+        break;
+    }
+}
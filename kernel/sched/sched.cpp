@@ -0,0 +1,787 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <drivers/hal/apic.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/interrupts/intrdef.hpp>
+#include <kernel/mem/bootmem.hpp>
+#include <kernel/sched/fpu.hpp>
+#include <kernel/sched/sched.hpp>
+#include <kernel/sched/workqueue.hpp>
+#include <kernel/smp/cpuidle.hpp>
+#include <kernel/smp/isolation.hpp>
+#include <kernel/smp/topology.hpp>
+#include <kernel/sync/rcu.hpp>
+#include <kernel/time/tick.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Defined in switch.asm */
+extern "C" void SchedulerSwitchContext(u64* SaveStackPointer, u64 NextStackPointer);
+extern "C" void SchedulerThreadStart();
+
+/* Define Statics */
+Scheduler::RunQueue Scheduler::RunQueues[KERNEL_SMP_MAXCPUS];
+KERNEL_PERCPU Scheduler::Thread* Scheduler::Running;
+KERNEL_PERCPU u32 Preempt::Count;
+static u64 NextThreadId;
+
+/// @brief Initializes the Scheduler, the Boot Context becomes the BSP's Idle Thread
+void Scheduler::Initialize()
+{
+    /*
+        Every processor owns a run queue with one FIFO list per
+        priority and a bitmap of the non-empty lists. Picking the
+        next thread is a bit scan and a list pop, O(1) whatever the
+        number of threads. A queue is only locked by its own CPU,
+        by wakeups targeting it and by thieves, so there's no lock
+        shared by every processor on the schedule path.
+
+        A thread runs till it blocks, yields, or its time slice
+        of ticks runs out while others wait at its CPU. Preemption
+        happens on the way out of the outermost interrupt, once
+        the ISR stub is back on the thread's stack. A processor
+        whose queue runs dry steals from the busiest other queue,
+        and busy processors periodically pull from busier ones.
+
+        Refer:
+        https://www.kernel.org/doc/html/v4.14/scheduler/sched-arch.html
+        https://lwn.net/Articles/23631/ (O(1) Scheduler)
+    */
+
+    Fpu::Initialize();
+    InitializeCpu(KERNEL_SMP_BOOTCPU);
+}
+
+/// @brief Sets up the Run Queue of the Executing Processor
+/// @param Cpu Logical CPU Index of the Executing Processor
+void Scheduler::InitializeCpu(u32 Cpu)
+{
+    RunQueue* Rq = &RunQueues[Cpu];
+    u64 Size = sizeof(Thread) + KERNEL_FPU_AREA_ALIGN + Fpu::StateSize;
+    Thread* Idle = (Thread*)BootMem::VirtAllocateBlock(BootMem::AlignAddressToPage(Size) / KERNEL_BOOTMEM_PMMGR_BLOCKSIZE);
+    if (!Idle) {
+        Logging::LogMessage(Logging::LogLevel::ERROR, "Idle Thread Allocation Failed");
+        return;
+    }
+
+    /* The Executing Context is Adopted, its Stack was set up at Boot */
+    Idle->State = RUNNING;
+    Idle->Active = true;
+    Idle->Priority = KERNEL_SCHED_PRIORITIES - 1;
+    Idle->Cpu = Cpu;
+    Idle->Bound = true;
+    memset(Idle->Affinity, 0, sizeof(Idle->Affinity));
+    Idle->Affinity[Cpu / 64] = (1ULL << (Cpu % 64));
+    Idle->Worker = 0;
+    Idle->Id = __atomic_fetch_add(&NextThreadId, 1, __ATOMIC_RELAXED);
+    Idle->Name = "idle";
+    Fpu::InitializeThread(Idle);
+
+    Rq->ReschedVector = Interrupt::AllocateVector(Cpu, Interrupt::IPI);
+    if (Rq->ReschedVector)
+        Interrupt::BindHandler(Cpu, Rq->ReschedVector, ReschedInterrupt, Rq);
+
+    Rq->Current = Idle;
+    PerCpu::Write(Running, Idle);
+    Fpu::InitializeCpu();
+    __atomic_store_n(&Rq->Idle, Idle, __ATOMIC_RELEASE);
+}
+
+/// @brief Creates a Kernel Thread and Makes it Runnable
+/// @param Name Thread Name (Not Copied)
+/// @param Routine Entry Point, the Thread Exits when it Returns
+/// @param Context Opaque pointer passed to the Routine
+/// @param Priority 0 (Highest) to KERNEL_SCHED_PRIORITIES - 1
+/// @param BoundCpu Processor the Thread is Bound to, or KERNEL_SCHED_ANYCPU (Housekeeping Processors)
+/// @return Created Thread or 0 (if Out of Memory)
+Scheduler::Thread* Scheduler::CreateThread(const char* Name, ThreadRoutine Routine, void* Context, u8 Priority, u32 BoundCpu)
+{
+    /* FUTURE: Guard Pages, an Overflow currently Corrupts the Thread */
+    u8* Stack = (u8*)BootMem::VirtAllocateBlock(KERNEL_SCHED_STACKPAGES);
+    if (!Stack)
+        return 0;
+
+    Thread* Thd = (Thread*)Stack;
+    Thd->State = BLOCKED;
+    Thd->Priority = (Priority < KERNEL_SCHED_PRIORITIES) ? Priority : KERNEL_SCHED_PRIORITIES - 1;
+    Thd->Cpu = (BoundCpu != KERNEL_SCHED_ANYCPU) ? BoundCpu : Smp::CurrentCpu();
+    Thd->Bound = (BoundCpu != KERNEL_SCHED_ANYCPU);
+    if (Thd->Bound) {
+        memset(Thd->Affinity, 0, sizeof(Thd->Affinity));
+        Thd->Affinity[BoundCpu / 64] = (1ULL << (BoundCpu % 64));
+    } else
+        memcpy(Thd->Affinity, Isolation::Housekeeping, sizeof(Thd->Affinity));
+
+    Thd->Worker = 0;
+    Thd->Id = __atomic_fetch_add(&NextThreadId, 1, __ATOMIC_RELAXED);
+    Thd->Name = Name;
+    Thd->Routine = Routine;
+    Thd->Context = Context;
+    Fpu::InitializeThread(Thd);
+
+    /*
+        The initial frame is what SchedulerSwitchContext() pops:
+        R15, R14, R13, R12, RBX, RBP and a return address. RSP is
+        16-byte aligned once SchedulerThreadStart is returned to.
+    */
+
+    u64* Frame = (u64*)(Stack + (KERNEL_SCHED_STACKPAGES * KERNEL_BOOTMEM_PMMGR_BLOCKSIZE));
+    *--Frame = (u64)SchedulerThreadStart;
+    *--Frame = 0; /* RBP */
+    *--Frame = 0; /* RBX */
+    *--Frame = (u64)Thd; /* R12 */
+    *--Frame = (u64)&ThreadMain; /* R13 */
+    *--Frame = 0; /* R14 */
+    *--Frame = 0; /* R15 */
+    Thd->StackPointer = (u64)Frame;
+
+    Wake(Thd);
+    return Thd;
+}
+
+/// @brief First Code run by a Thread, after its First Switch
+/// @param Thd Thread being Started
+void Scheduler::ThreadMain(Thread* Thd)
+{
+    FinishSwitch();
+    Cpu::EnableInterrupts();
+
+    Thd->Routine(Thd->Context);
+    Exit();
+}
+
+/// @brief Gives up the Processor to an Equal or Higher Priority Thread
+void Scheduler::Yield()
+{
+    if (Interrupt::InInterrupt())
+        return;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    Schedule();
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Checks if the Executing Context may Block
+/// @return False in Interrupts, the Idle Thread or with Preemption Disabled
+bool Scheduler::CanBlock()
+{
+    RunQueue* Rq = &RunQueues[Smp::CurrentCpu()];
+    return Rq->Idle && Rq->Current != Rq->Idle && !Interrupt::InInterrupt() && !PreemptDisabled();
+}
+
+/// @brief Marks the Current Thread as about to Block
+void Scheduler::PrepareToBlock()
+{
+    /*
+        The state is set before the caller checks its wait condition.
+        A Wake() between the check and Block() then sets it back to
+        RUNNING, and Block() returns at once instead of sleeping.
+        Block() also returns if the thread was preempted before it,
+        so callers check their condition again in a loop.
+    */
+
+    __atomic_store_n(&CurrentThread()->State, BLOCKED, __ATOMIC_SEQ_CST);
+}
+
+/// @brief Undoes PrepareToBlock() once the Wait Condition turned out True
+void Scheduler::CancelBlock()
+{
+    /* A racing Wake() does the Same, both leave it Running */
+    __atomic_store_n(&CurrentThread()->State, RUNNING, __ATOMIC_SEQ_CST);
+}
+
+/// @brief Switches Away from the Current Thread till it's Woken
+void Scheduler::Block()
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    Thread* Thd = CurrentThread();
+
+    if (Thd->State == BLOCKED) {
+        /* A Worker's Pool may Start Another while it Sleeps */
+        if (Thd->Worker)
+            Workqueue::WorkerSleeping(Thd);
+
+        Schedule();
+
+        if (Thd->Worker)
+            Workqueue::WorkerRunning(Thd);
+    }
+
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Makes a Blocked Thread Runnable
+/// @param Thd Thread to be Woken
+void Scheduler::Wake(Thread* Thd)
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    RunQueue* Rq = LockQueueOf(Thd);
+
+    ThreadState Expected = BLOCKED;
+    if (!__atomic_compare_exchange_n(&Thd->State, &Expected, RUNNING, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+        || Thd->Active) {
+        /* Already Awake, or hasn't Switched Out yet and will continue */
+        Rq->Lock.Unlock();
+        Cpu::RestoreFlags(Flags);
+        return;
+    }
+
+    /* The Lock was Held till it Switched Out, its Stack is Saved */
+    Rq->Lock.Unlock();
+
+    u32 Target = SelectCpu(Thd);
+    Rq = &RunQueues[Target];
+    Rq->Lock.Lock();
+
+    Thd->State = READY;
+    Thd->Active = true;
+    Thd->Cpu = Target;
+    Enqueue(Rq, Thd);
+
+    /* A Bound Thread may be Queued on a Processor not yet Online, it has no Current */
+    bool Preempts = Rq->Current && ((Thd->Priority < Rq->Current->Priority) || (Rq->Current == Rq->Idle));
+    if (Preempts)
+        Rq->NeedResched = true;
+
+    /* A Busy Processor with its Tick Stopped must Round-Robin again */
+    bool Restart = Tick::Ticks[Target].FullStop;
+
+    Rq->Lock.Unlock();
+
+    if ((Preempts || Restart) && Target != Smp::CurrentCpu())
+        Kick(Target);
+    else if (Restart)
+        Tick::Restart();
+
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Restricts the Processors a Thread may Run on
+/// @param Thd Thread, Migrated at once if Queued or Running elsewhere
+/// @param Mask KERNEL_SCHED_MASKWORDS Words, Bit N allows Logical CPU N
+/// @return False if the Mask holds no Online Processor
+bool Scheduler::SetAffinity(Thread* Thd, const u64* Mask)
+{
+    /*
+        A queued thread is taken off its queue and woken again,
+        which places it within the new mask. A running one is
+        preempted, Schedule() then hands it to FinishSwitch() to
+        be woken once its stack is saved. A blocked thread moves
+        on its next wakeup.
+    */
+
+    u32 Allowed = 0;
+    bool Online = false;
+    for (u32 Word = 0; Word < KERNEL_SCHED_MASKWORDS; Word++) {
+        Allowed += __builtin_popcountll(Mask[Word]);
+        for (u64 Bits = Mask[Word]; Bits; Bits &= Bits - 1)
+            Online |= (__atomic_load_n(&RunQueues[(Word * 64) + __builtin_ctzll(Bits)].Idle, __ATOMIC_ACQUIRE) != 0);
+    }
+
+    if (!Online)
+        return false;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    RunQueue* Rq = LockQueueOf(Thd);
+
+    memcpy(Thd->Affinity, Mask, sizeof(Thd->Affinity));
+    Thd->Bound = (Allowed == 1);
+
+    u32 Target = Thd->Cpu;
+    bool Requeue = false, Preempt = false;
+    if (!AllowedOn(Thd, Target)) {
+        if (Rq->Current == Thd) {
+            Rq->NeedResched = true;
+            Preempt = true;
+        } else if (Thd->State == READY && Thd->Active) {
+            Remove(Rq, Thd);
+            Thd->State = BLOCKED;
+            Thd->Active = false;
+            Requeue = true;
+        }
+    }
+
+    Rq->Lock.Unlock();
+
+    if (Requeue)
+        Wake(Thd);
+    else if (Preempt && Target != Smp::CurrentCpu())
+        Kick(Target);
+
+    Cpu::RestoreFlags(Flags);
+
+    if (Preempt && Thd == CurrentThread() && CanBlock())
+        Yield();
+
+    return true;
+}
+
+/// @brief Checks if a Processor runs a Single Thread, Called by the Tick with IF Clear
+/// @param Cpu Logical CPU Index of the Executing Processor
+bool Scheduler::CanStopTick(u32 Cpu)
+{
+    RunQueue* Rq = &RunQueues[Cpu];
+    return Rq->Idle && Rq->Current != Rq->Idle && !Rq->Queued;
+}
+
+/// @brief Terminates the Current Thread
+void Scheduler::Exit()
+{
+    Cpu::DisableInterrupts();
+    CurrentThread()->State = DEAD;
+    Schedule();
+
+    /* A Dead Thread is never Switched back to */
+    for (;;)
+        __asm__ volatile("hlt");
+}
+
+/// @brief Accounts a Tick, Called by the Tick Handler with Interrupts Disabled
+/// @param Cpu Logical CPU Index of the Executing Processor
+void Scheduler::Tick(u32 Cpu)
+{
+    RunQueue* Rq = &RunQueues[Cpu];
+    if (!Rq->Idle)
+        return;
+
+    /* Round-Robin among Equals once the Slice runs out */
+    Thread* Current = Rq->Current;
+    if (Current != Rq->Idle) {
+        if (Current->Slice)
+            Current->Slice--;
+
+        if (!Current->Slice && Rq->Queued)
+            Rq->NeedResched = true;
+    }
+
+    if (++Rq->BalanceTicks >= KERNEL_SCHED_BALANCETICKS) {
+        Rq->BalanceTicks = 0;
+        Balance(Cpu);
+    }
+}
+
+/// @brief Preempts the Current Thread if Due, Called on Outermost Interrupt Exit
+void Scheduler::PreemptIrq()
+{
+    /*
+        The ISR stub calls this on the thread's own stack, with
+        interrupts disabled and the vector acknowledged. The Idle
+        thread is never preempted here, it reschedules itself once
+        its tick is restarted (see Smp::Idle()). Non-preemptible
+        builds (KERNEL_SCHED_NOPREEMPT) only switch when a thread
+        blocks, yields or exits.
+    */
+
+#ifndef KERNEL_SCHED_NOPREEMPT
+    RunQueue* Rq = &RunQueues[Smp::CurrentCpu()];
+    if (!Rq->NeedResched || Rq->Current == Rq->Idle || Preempt::Disabled())
+        return;
+
+    Schedule(true);
+#endif
+}
+
+/// @brief Switches to the Next Thread, Called with Interrupts Disabled
+/// @param Preempted Entered from PreemptIrq(), Prev stays Runnable even if Marked Blocked
+void Scheduler::Schedule(bool Preempted)
+{
+    u32 Cpu = Smp::CurrentCpu();
+    RunQueue* Rq = &RunQueues[Cpu];
+    Thread* Prev = Rq->Current;
+
+    /* Prev can't be inside a Read-Side Critical Section here */
+    Rcu::NoteContextSwitch(Cpu);
+
+    Rq->Lock.Lock();
+    Rq->NeedResched = false;
+
+    /*
+        A thread preempted between PrepareToBlock() and Block() has
+        only tested its wait condition, it may not be queued where a
+        waker finds it yet. It's queued again like a running one, and
+        Block() returns once it runs, so its caller checks again.
+    */
+
+    bool Runnable = (Prev->State == RUNNING) || (Preempted && Prev->State == BLOCKED);
+
+    if (Prev != Rq->Idle) {
+        if (Runnable && !AllowedOn(Prev, Cpu)) {
+            /* Its Affinity Changed, Woken elsewhere once Switched Out */
+            Prev->State = BLOCKED;
+            Prev->Active = false;
+            Rq->Migrating = Prev;
+        } else if (Runnable) {
+            Prev->State = READY;
+            Enqueue(Rq, Prev);
+        } else if (Prev->State == DEAD) {
+            Prev->Active = false;
+            Rq->Dead = Prev;
+        } else {
+            Prev->Active = false;
+        }
+    }
+
+    Thread* Next = Dequeue(Rq);
+    if (!Next)
+        Next = Steal(Cpu);
+    if (!Next)
+        Next = Rq->Idle;
+
+    Next->State = RUNNING;
+    Next->Cpu = Cpu;
+    if (!Next->Slice)
+        Next->Slice = KERNEL_SCHED_TIMESLICE;
+
+    if (Next == Prev) {
+        Rq->Lock.Unlock();
+        return;
+    }
+
+    /*
+        The queue stays locked across the switch and is unlocked by
+        the next thread (FinishSwitch). Until then, Prev's registers
+        aren't saved, so it must not be stolen or woken elsewhere.
+    */
+
+    Rq->Current = Next;
+    Rq->Switches++;
+    PerCpu::Write(Running, Next);
+
+    Fpu::Switch(Prev, Next, Cpu);
+    SchedulerSwitchContext(&Prev->StackPointer, Next->StackPointer);
+    FinishSwitch();
+}
+
+/// @brief Completes a Switch on the Incoming Thread's Side
+void Scheduler::FinishSwitch()
+{
+    /* May run on another Processor than the one that Switched Out */
+    RunQueue* Rq = &RunQueues[Smp::CurrentCpu()];
+    Thread* Dead = Rq->Dead;
+    Thread* Migrating = Rq->Migrating;
+    Rq->Dead = 0;
+    Rq->Migrating = 0;
+    Rq->Lock.Unlock();
+
+    if (Dead)
+        BootMem::VirtFreeBlock((BootMem::VirtualAddress*)Dead, KERNEL_SCHED_STACKPAGES);
+
+    if (Migrating)
+        Wake(Migrating);
+}
+
+/// @brief Appends a Thread to its Priority List
+void Scheduler::Enqueue(RunQueue* Rq, Thread* Thd)
+{
+    u8 Priority = Thd->Priority;
+    Thd->Next = 0;
+    Thd->Prev = Rq->Tails[Priority];
+
+    if (Rq->Tails[Priority])
+        Rq->Tails[Priority]->Next = Thd;
+    else
+        Rq->Heads[Priority] = Thd;
+
+    Rq->Tails[Priority] = Thd;
+    Rq->Bitmap |= (1U << Priority);
+    Rq->Queued++;
+}
+
+/// @brief Removes the Highest Priority Waiting Thread, in O(1)
+/// @return Thread or 0 (if the Queue is Empty)
+Scheduler::Thread* Scheduler::Dequeue(RunQueue* Rq)
+{
+    if (!Rq->Bitmap)
+        return 0;
+
+    u32 Priority = __builtin_ctz(Rq->Bitmap);
+    Thread* Thd = Rq->Heads[Priority];
+
+    Rq->Heads[Priority] = Thd->Next;
+    if (Thd->Next)
+        Thd->Next->Prev = 0;
+    else {
+        Rq->Tails[Priority] = 0;
+        Rq->Bitmap &= ~(1U << Priority);
+    }
+
+    Thd->Next = 0;
+    Rq->Queued--;
+    return Thd;
+}
+
+/// @brief Unlinks a Waiting Thread from its Priority List
+void Scheduler::Remove(RunQueue* Rq, Thread* Thd)
+{
+    u8 Priority = Thd->Priority;
+    if (Thd->Prev)
+        Thd->Prev->Next = Thd->Next;
+    else
+        Rq->Heads[Priority] = Thd->Next;
+
+    if (Thd->Next)
+        Thd->Next->Prev = Thd->Prev;
+    else
+        Rq->Tails[Priority] = Thd->Prev;
+
+    if (!Rq->Heads[Priority])
+        Rq->Bitmap &= ~(1U << Priority);
+
+    Thd->Next = 0;
+    Thd->Prev = 0;
+    Rq->Queued--;
+}
+
+/// @brief Takes a Waiting Thread from the Busiest Queue, Nearest Domains First
+/// @param Cpu Logical CPU Index of the Executing Processor, its Queue Locked
+/// @return Stolen Thread or 0
+Scheduler::Thread* Scheduler::Steal(u32 Cpu)
+{
+    /*
+        A thread moved to an SMT sibling or a core sharing the LLC
+        finds its data in cache, one moved further starts cold.
+        Thieves look in their SMT and LLC domains first, and only
+        take from beyond the LLC if a queue there has two or more
+        threads waiting, so the move clearly pays. Isolated
+        processors only run what's given an affinity for them.
+    */
+
+    if (Isolation::IsIsolated(Cpu))
+        return 0;
+
+    for (u32 Domain = Topology::SMT; Domain < Topology::LEVELS; Domain++) {
+        u32 Victim = FindBusiest(Cpu, Domain, (Domain <= Topology::LLC) ? 1 : 2);
+        if (Victim == Cpu)
+            continue;
+
+        Thread* Thd = StealFrom(Cpu, Victim);
+        if (Thd)
+            return Thd;
+    }
+
+    return 0;
+}
+
+/// @brief Takes a Migratable Thread from a Queue
+/// @param Cpu Logical CPU Index of the Executing Processor, its Queue Locked
+/// @param Victim Logical CPU Index of the Queue Stolen from
+/// @return Stolen Thread or 0
+Scheduler::Thread* Scheduler::StealFrom(u32 Cpu, u32 Victim)
+{
+    /*
+        Queue lengths are read without locks, only the victim is
+        locked. TryLock() keeps two thieves locking each other's
+        queues from deadlocking, a failed attempt just moves on.
+    */
+
+    if (!RunQueues[Victim].Lock.TryLock())
+        return 0;
+
+    /* The Highest Priority Thread Allowed on Cpu is Taken */
+    Thread* Thd = 0;
+    for (u32 Bitmap = RunQueues[Victim].Bitmap; Bitmap && !Thd; Bitmap &= Bitmap - 1) {
+        for (Thread* Candidate = RunQueues[Victim].Heads[__builtin_ctz(Bitmap)]; Candidate; Candidate = Candidate->Next) {
+            if (AllowedOn(Candidate, Cpu)) {
+                Thd = Candidate;
+                break;
+            }
+        }
+    }
+
+    if (Thd) {
+        Remove(&RunQueues[Victim], Thd);
+        Thd->Cpu = Cpu;
+    }
+
+    RunQueues[Victim].Lock.Unlock();
+    return Thd;
+}
+
+/// @brief Finds the Longest other Queue within a Topology Domain
+/// @param Cpu Logical CPU Index of the Executing Processor
+/// @param Domain Topology::Level to Search
+/// @param Minimum Waiting Threads a Queue needs to be Picked
+/// @return Logical CPU Index, Cpu if None Qualifies (Isolated Processors Never do)
+u32 Scheduler::FindBusiest(u32 Cpu, u32 Domain, u32 Minimum)
+{
+    u32 Busiest = Cpu;
+    u32 Most = Minimum - 1;
+
+    for (u32 Word = 0; Word < KERNEL_TOPOLOGY_MASKWORDS; Word++) {
+        for (u64 Siblings = Topology::Cpus[Cpu].Siblings[Domain][Word]; Siblings; Siblings &= Siblings - 1) {
+            u32 Other = (Word * 64) + __builtin_ctzll(Siblings);
+            u32 Queued = __atomic_load_n(&RunQueues[Other].Queued, __ATOMIC_RELAXED);
+            if (Other != Cpu && Queued > Most && !Isolation::IsIsolated(Other)) {
+                Busiest = Other;
+                Most = Queued;
+            }
+        }
+    }
+
+    return Busiest;
+}
+
+/// @brief Pulls a Thread from a Busier Queue, Called by the Tick
+/// @param Cpu Logical CPU Index of the Executing Processor
+void Scheduler::Balance(u32 Cpu)
+{
+    if (Isolation::IsIsolated(Cpu))
+        return;
+
+    RunQueue* Rq = &RunQueues[Cpu];
+    Rq->Lock.Lock();
+
+    /*
+        Only an imbalance of two or more is worth a migration, of
+        three beyond the LLC. Domains beyond the LLC are only
+        balanced every KERNEL_SCHED_REMOTEBALANCE passes.
+    */
+
+    u32 Own = Rq->Queued;
+    bool Remote = (++Rq->BalancePasses % KERNEL_SCHED_REMOTEBALANCE) == 0;
+    Thread* Thd = 0;
+
+    for (u32 Domain = Topology::SMT; Domain < Topology::LEVELS && !Thd; Domain++) {
+        if (Domain > Topology::LLC && !Remote)
+            break;
+
+        u32 Victim = FindBusiest(Cpu, Domain, Own + ((Domain <= Topology::LLC) ? 2 : 3));
+        if (Victim != Cpu)
+            Thd = StealFrom(Cpu, Victim);
+    }
+
+    if (Thd) {
+        Enqueue(Rq, Thd);
+        if (Thd->Priority < Rq->Current->Priority || Rq->Current == Rq->Idle)
+            Rq->NeedResched = true;
+    }
+
+    Rq->Lock.Unlock();
+}
+
+/// @brief Picks the Processor a Woken Thread is Queued on
+/// @param Thd Thread being Woken
+/// @return Logical CPU Index, within its Affinity
+u32 Scheduler::SelectCpu(Thread* Thd)
+{
+    /*
+        The last CPU keeps its caches warm, so it's kept if idle.
+        Otherwise the nearest idle CPU is preferred (an SMT sibling,
+        then the LLC, then further), then the shortest queue that
+        shares the last CPU's LLC. Only CPUs in the thread's
+        affinity are considered.
+    */
+
+    RunQueue* Last = &RunQueues[Thd->Cpu];
+    bool LastAllowed = AllowedOn(Thd, Thd->Cpu);
+    if (Thd->Bound && LastAllowed)
+        return Thd->Cpu;
+
+    /* Idle is Set once the Processor is Online, Current is 0 till then */
+    if (LastAllowed && __atomic_load_n(&Last->Idle, __ATOMIC_ACQUIRE) && Last->Current == Last->Idle && !Last->Queued)
+        return Thd->Cpu;
+
+    for (u32 Domain = Topology::SMT; Domain < Topology::LEVELS; Domain++) {
+        for (u32 Word = 0; Word < KERNEL_TOPOLOGY_MASKWORDS; Word++) {
+            for (u64 Siblings = Topology::Cpus[Thd->Cpu].Siblings[Domain][Word] & Thd->Affinity[Word]; Siblings; Siblings &= Siblings - 1) {
+                u32 Cpu = (Word * 64) + __builtin_ctzll(Siblings);
+                RunQueue* Rq = &RunQueues[Cpu];
+                if (__atomic_load_n(&Rq->Idle, __ATOMIC_ACQUIRE) && Rq->Current == Rq->Idle && !Rq->Queued)
+                    return Cpu;
+            }
+        }
+    }
+
+    /* Beyond the LLC only if the Affinity leaves no Choice within it */
+    bool LastOnline = LastAllowed && __atomic_load_n(&Last->Idle, __ATOMIC_ACQUIRE);
+    u32 Best = LastOnline ? Thd->Cpu : KERNEL_SCHED_ANYCPU;
+    u32 BestQueued = LastOnline ? Last->Queued + 1 : 0xFFFFFFFF;
+    for (u32 Domain = Topology::LLC; Domain < Topology::LEVELS; Domain++) {
+        if (Domain > Topology::LLC && Best != KERNEL_SCHED_ANYCPU)
+            break;
+
+        for (u32 Word = 0; Word < KERNEL_TOPOLOGY_MASKWORDS; Word++) {
+            for (u64 Siblings = Topology::Cpus[Thd->Cpu].Siblings[Domain][Word] & Thd->Affinity[Word]; Siblings; Siblings &= Siblings - 1) {
+                u32 Cpu = (Word * 64) + __builtin_ctzll(Siblings);
+                RunQueue* Rq = &RunQueues[Cpu];
+                if (!__atomic_load_n(&Rq->Idle, __ATOMIC_ACQUIRE))
+                    continue;
+
+                u32 Load = Rq->Queued + ((Rq->Current != Rq->Idle) ? 1 : 0);
+                if (Load < BestQueued) {
+                    Best = Cpu;
+                    BestQueued = Load;
+                }
+            }
+        }
+    }
+
+    /* Affinity for Processors not yet Online, Queued there till they Start */
+    if (Best == KERNEL_SCHED_ANYCPU) {
+        for (u32 Word = 0; Word < KERNEL_SCHED_MASKWORDS && Best == KERNEL_SCHED_ANYCPU; Word++) {
+            if (Thd->Affinity[Word])
+                Best = (Word * 64) + __builtin_ctzll(Thd->Affinity[Word]);
+        }
+    }
+
+    return (Best != KERNEL_SCHED_ANYCPU) ? Best : Thd->Cpu;
+}
+
+/// @brief Locks the Run Queue a Thread is on, Called with IF Clear
+/// @return Locked Run Queue, Thd->Cpu is Stable till it's Unlocked
+Scheduler::RunQueue* Scheduler::LockQueueOf(Thread* Thd)
+{
+    /* The Thread may Migrate till its Queue is Locked */
+    for (;;) {
+        u32 Cpu = __atomic_load_n(&Thd->Cpu, __ATOMIC_ACQUIRE);
+        RunQueue* Rq = &RunQueues[Cpu];
+        Rq->Lock.Lock();
+        if (Thd->Cpu == Cpu)
+            return Rq;
+
+        Rq->Lock.Unlock();
+    }
+}
+
+/// @brief Interrupts another Processor so it Reschedules
+/// @param Cpu Logical CPU Index
+void Scheduler::Kick(u32 Cpu)
+{
+    /* An Idle Processor in MWAIT is Woken by a Write, no IPI needed */
+    if (CpuIdle::Wake(Cpu))
+        return;
+
+    if (RunQueues[Cpu].ReschedVector)
+        Apic::SendIpi(Smp::GetApicId(Cpu), APIC_LAPIC_ICR_FIXED | RunQueues[Cpu].ReschedVector);
+}
+
+/// @brief Reschedule IPI, the Switch happens on Interrupt Exit
+void Scheduler::ReschedInterrupt(u8 Vector, void* Context)
+{
+    ((RunQueue*)Context)->NeedResched = true;
+
+    /* Sent to a Busy Processor with its Tick Stopped, it has Threads to Round-Robin */
+    if (Tick::Ticks[Smp::CurrentCpu()].FullStop)
+        Tick::Restart();
+}
@@ -0,0 +1,65 @@
+;   tacOS
+;   Copyright (C) 2024  Atheesh Thirumalairajan
+;
+;   This program is free software: you can redistribute it and/or modify
+;   it under the terms of the GNU General Public License as published by
+;   the Free Software Foundation, either version 3 of the License, or
+;   (at your option) any later version.
+;
+;   This program is distributed in the hope that it will be useful,
+;   but WITHOUT ANY WARRANTY; without even the implied warranty of
+;   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;   GNU General Public License for more details.
+;
+;   You should have received a copy of the GNU General Public License
+;   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+
+; This Assembly File contains:
+; The Kernel Thread Context Switch.
+;
+; Only callee-saved registers are saved, the caller of
+; SchedulerSwitchContext() has already saved the rest as
+; the SysV ABI requires. The saved RSP is all that's kept
+; in the Thread, everything else is on its own stack.
+; Extended (x87/SSE/AVX) state is switched lazily, by
+; Fpu::Switch() right before this routine is called.
+;
+; Refer:
+; https://wiki.osdev.org/Kernel_Multitasking
+; https://refspecs.linuxbase.org/elf/x86_64-abi-0.99.pdf (Section 3.2.1)
+
+global SchedulerSwitchContext
+global SchedulerThreadStart
+
+section .text
+bits 64
+
+; void SchedulerSwitchContext(u64* SaveStackPointer, u64 NextStackPointer)
+SchedulerSwitchContext:
+    push rbp
+    push rbx
+    push r12
+    push r13
+    push r14
+    push r15
+
+    mov [rdi], rsp
+    mov rsp, rsi
+
+    pop r15
+    pop r14
+    pop r13
+    pop r12
+    pop rbx
+    pop rbp
+    ret
+
+; The first switch into a Thread returns here, with the
+; Thread in R12 and Scheduler::ThreadMain() in R13, as
+; laid out by Scheduler::CreateThread().
+SchedulerThreadStart:
+    mov rdi, r12
+    call r13
+    ud2
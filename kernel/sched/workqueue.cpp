@@ -0,0 +1,380 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/sched/workqueue.hpp>
+#include <kernel/smp/smpcall.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+
+/* Define Statics */
+Workqueue::Pool Workqueue::Pools[KERNEL_SMP_MAXCPUS + 1];
+
+/// @brief Cancellation of a Delayed Work Timer, Run on the Timer's Processor
+struct CancelRequest {
+    Workqueue::DelayedWork* Dw;
+    bool Cancelled;
+};
+
+/// @brief Marks a Work Item Pending
+/// @return False if it was Pending already
+static inline bool Claim(Workqueue::Work* Wk)
+{
+    bool Expected = false;
+    return __atomic_compare_exchange_n(&Wk->Pending, &Expected, true, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+/// @brief Sets up the Unbound Pool and the Bootstrap Processor's Pool
+void Workqueue::Initialize()
+{
+    /*
+        Work that may block or run long doesn't belong in a bottom
+        half. It's queued to a pool of kernel threads instead: one
+        pool bound to each processor, plus an unbound pool whose
+        workers run on any housekeeping (not isolated) processor.
+        Queue() picks the pool of the executing processor, the
+        item then runs where its data is likely still cached.
+
+        Pools are concurrency managed. Running counts the workers
+        that are neither idle nor blocked, and a pool only wakes
+        (or creates) another worker when it drops to zero with
+        work left. Scheduler::Block() tells the pool when a worker
+        sleeps inside an item, so a blocking item doesn't hold up
+        the rest, while CPU-bound items run back to back on one
+        thread. Workers beyond the first are only ever created
+        that way, up to KERNEL_WORKQUEUE_MAXWORKERS per pool.
+
+        Delayed work arms a timer wheel timer, its expiry queues
+        the item to the pool it was queued from.
+
+        Refer:
+        https://www.kernel.org/doc/html/latest/core-api/workqueue.html
+    */
+
+    InitializePool(KERNEL_WORKQUEUE_UNBOUND, KERNEL_SCHED_ANYCPU);
+    InitializeCpu(KERNEL_SMP_BOOTCPU);
+}
+
+/// @brief Sets up the Pool of a Processor, after its Scheduler
+/// @param Cpu Logical CPU Index
+void Workqueue::InitializeCpu(u32 Cpu)
+{
+    InitializePool(Cpu, Cpu);
+}
+
+/// @brief Prepares a Work Item for Queueing
+/// @param Wk Caller-Owned Work Item
+/// @param Routine Runs in a Worker Thread, may Block
+/// @param Context Opaque pointer passed to the Routine
+void Workqueue::InitializeWork(Work* Wk, WorkRoutine Routine, void* Context)
+{
+    Wk->Next = 0;
+    Wk->Routine = Routine;
+    Wk->Context = Context;
+    Wk->Owner = 0;
+    Wk->Pending = false;
+}
+
+/// @brief Queues Work to the Executing Processor's Pool
+/// @param Wk Initialized Work Item
+/// @return False if it was Pending already
+bool Workqueue::Queue(Work* Wk)
+{
+    if (!Claim(Wk))
+        return false;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    Pool* Target = &Pools[Smp::CurrentCpu()];
+    Insert((Target->Ready) ? Target : &Pools[KERNEL_WORKQUEUE_UNBOUND], Wk);
+    Cpu::RestoreFlags(Flags);
+    return true;
+}
+
+/// @brief Queues Work to a Processor's Pool
+/// @param Cpu Logical CPU Index
+/// @param Wk Initialized Work Item
+/// @return False if it was Pending already, or the Processor has no Pool
+bool Workqueue::QueueOn(u32 Cpu, Work* Wk)
+{
+    if (Cpu >= Smp::CpuCount || !Pools[Cpu].Ready || !Claim(Wk))
+        return false;
+
+    return Insert(&Pools[Cpu], Wk);
+}
+
+/// @brief Queues Work to the Unbound Pool, its Workers run on any Processor
+/// @param Wk Initialized Work Item
+/// @return False if it was Pending already
+bool Workqueue::QueueUnbound(Work* Wk)
+{
+    if (!Claim(Wk))
+        return false;
+
+    return Insert(&Pools[KERNEL_WORKQUEUE_UNBOUND], Wk);
+}
+
+/// @brief Queues Work to the Executing Processor's Pool after a Delay
+/// @param Dw Delayed Work, its Wk Initialized
+/// @param DelayNs Nanoseconds from Now, Rounded up to a Jiffy
+/// @return False if it was Pending already
+bool Workqueue::QueueDelayed(DelayedWork* Dw, u64 DelayNs)
+{
+    if (!Claim(&Dw->Wk))
+        return false;
+
+    /* The Timer runs on this Processor, so does the Work */
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    u32 Self = Smp::CurrentCpu();
+    Dw->Pool = (Pools[Self].Ready) ? Self : KERNEL_WORKQUEUE_UNBOUND;
+    TimerWheel::Arm(&Dw->Tmr, DelayNs, DelayedTimer, Dw);
+    Cpu::RestoreFlags(Flags);
+    return true;
+}
+
+/// @brief Removes Queued Work before it Runs
+/// @param Wk Work Item
+/// @return True if Removed, False if it wasn't Queued or is Running already
+bool Workqueue::Cancel(Work* Wk)
+{
+    Pool* Owner = __atomic_load_n(&Wk->Owner, __ATOMIC_ACQUIRE);
+    if (!Owner)
+        return false;
+
+    bool Removed = false;
+    u64 Flags = Owner->Lock.LockIrqSave();
+
+    Work* Prev = 0;
+    for (Work* Item = Owner->Head; Item; Prev = Item, Item = Item->Next) {
+        if (Item != Wk)
+            continue;
+
+        if (Prev)
+            Prev->Next = Wk->Next;
+        else
+            Owner->Head = Wk->Next;
+
+        if (Owner->Tail == Wk)
+            Owner->Tail = Prev;
+
+        __atomic_store_n(&Wk->Pending, false, __ATOMIC_RELEASE);
+        Removed = true;
+        break;
+    }
+
+    Owner->Lock.UnlockIrqRestore(Flags);
+    return Removed;
+}
+
+/// @brief Cancels Delayed Work, whether its Timer is Armed or it's Queued
+/// @param Dw Delayed Work
+/// @return True if Cancelled, False if it wasn't Pending or is Running already
+bool Workqueue::CancelDelayed(DelayedWork* Dw)
+{
+    if (!__atomic_load_n(&Dw->Wk.Pending, __ATOMIC_ACQUIRE))
+        return false;
+
+    /* Wheel Timers are only Cancelled by the Processor that Armed them */
+    CancelRequest Request = { Dw, false };
+    SmpCall::Call(Dw->Tmr.Cpu, CancelTimer, &Request);
+    if (Request.Cancelled) {
+        __atomic_store_n(&Dw->Wk.Pending, false, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    return Cancel(&Dw->Wk);
+}
+
+/// @brief Notes a Worker Blocking inside a Work Item, Called by Scheduler::Block() with IF Clear
+/// @param Thd Worker Thread, about to Switch Out
+void Workqueue::WorkerSleeping(Scheduler::Thread* Thd)
+{
+    Worker* Self = (Worker*)Thd->Worker;
+    Pool* Owner = Self->Owner;
+    Owner->Lock.Lock();
+
+    /* Idle Workers Sleep by Design, and a Wake may have Raced the Block */
+    if (!Self->Idle && Thd->State == Scheduler::BLOCKED) {
+        Self->Sleeping = true;
+        Owner->Running--;
+        if (!Owner->Running && Owner->Head)
+            WakeWorker(Owner);
+    }
+
+    Owner->Lock.Unlock();
+}
+
+/// @brief Notes a Worker Running again, Called by Scheduler::Block() with IF Clear
+/// @param Thd Worker Thread, Switched back In
+void Workqueue::WorkerRunning(Scheduler::Thread* Thd)
+{
+    /* Sleeping is only Written by the Worker itself */
+    Worker* Self = (Worker*)Thd->Worker;
+    if (!Self->Sleeping)
+        return;
+
+    Pool* Owner = Self->Owner;
+    Owner->Lock.Lock();
+    Self->Sleeping = false;
+    Owner->Running++;
+    Owner->Lock.Unlock();
+}
+
+/// @brief Sets up a Pool with its First Worker
+/// @param Index Pool Index, KERNEL_WORKQUEUE_UNBOUND for the Unbound Pool
+/// @param Cpu Processor its Workers are Bound to, or KERNEL_SCHED_ANYCPU
+void Workqueue::InitializePool(u32 Index, u32 Cpu)
+{
+    Pool* Target = &Pools[Index];
+    u64 Flags = Target->Lock.LockIrqSave();
+
+    Target->Cpu = Cpu;
+    Worker* First = CreateWorker(Target);
+    Target->Ready = true;
+
+    Target->Lock.UnlockIrqRestore(Flags);
+    if (!First)
+        Logging::LogMessage(Logging::LogLevel::ERROR, "Workqueue Worker Creation Failed");
+}
+
+/// @brief Appends Claimed Work to a Pool, Waking a Worker if None is Running
+bool Workqueue::Insert(Pool* Target, Work* Wk)
+{
+    u64 Flags = Target->Lock.LockIrqSave();
+
+    Wk->Next = 0;
+    __atomic_store_n(&Wk->Owner, Target, __ATOMIC_RELEASE);
+    if (Target->Tail)
+        Target->Tail->Next = Wk;
+    else
+        Target->Head = Wk;
+
+    Target->Tail = Wk;
+    if (!Target->Running)
+        WakeWorker(Target);
+
+    Target->Lock.UnlockIrqRestore(Flags);
+    return true;
+}
+
+/// @brief Starts an Idle Worker, or Creates one, Called with the Pool Locked
+void Workqueue::WakeWorker(Pool* Target)
+{
+    Worker* Idle = Target->IdleList;
+    if (!Idle) {
+        /* At the Limit, the Work waits for a Blocked Worker */
+        CreateWorker(Target);
+        return;
+    }
+
+    Target->IdleList = Idle->NextIdle;
+    Idle->Idle = false;
+    Target->Running++;
+    Scheduler::Wake(Idle->Thd);
+}
+
+/// @brief Creates a Worker that Starts Running, Called with the Pool Locked
+/// @return Worker or 0 (at the Limit, or Out of Memory)
+Workqueue::Worker* Workqueue::CreateWorker(Pool* Target)
+{
+    if (Target->WorkerCount == KERNEL_WORKQUEUE_MAXWORKERS)
+        return 0;
+
+    Worker* Created = &Target->Workers[Target->WorkerCount];
+    Created->Owner = Target;
+    Created->NextIdle = 0;
+    Created->Current = 0;
+    Created->Idle = false;
+    Created->Sleeping = false;
+
+    const char* Name = (Target->Cpu == KERNEL_SCHED_ANYCPU) ? "worker/unbound" : "worker";
+    Scheduler::Thread* Thd = Scheduler::CreateThread(Name, WorkerMain, Created, KERNEL_SCHED_DEFAULTPRIORITY, Target->Cpu);
+    if (!Thd)
+        return 0;
+
+    /* Only Read once it's Idle, which needs the Pool Lock */
+    Created->Thd = Thd;
+    Target->WorkerCount++;
+    Target->Running++;
+    return Created;
+}
+
+/// @brief Worker Thread Loop
+/// @param Context Worker
+void Workqueue::WorkerMain(void* Context)
+{
+    Worker* Self = (Worker*)Context;
+    Pool* Owner = Self->Owner;
+    u64 Flags = Owner->Lock.LockIrqSave();
+    Scheduler::CurrentThread()->Worker = Self;
+
+    for (;;) {
+        /*
+            Only one running worker keeps taking items. Another one
+            woken while it was blocked goes idle once both run.
+        */
+
+        while (Owner->Head && Owner->Running <= 1) {
+            Work* Wk = Owner->Head;
+            Owner->Head = Wk->Next;
+            if (!Owner->Head)
+                Owner->Tail = 0;
+
+            /* Cleared before it Runs, the Routine may Queue it again */
+            WorkRoutine Routine = Wk->Routine;
+            void* WorkContext = Wk->Context;
+            Self->Current = Wk;
+            __atomic_store_n(&Wk->Pending, false, __ATOMIC_RELEASE);
+            Owner->Lock.UnlockIrqRestore(Flags);
+
+            Routine(WorkContext);
+
+            Flags = Owner->Lock.LockIrqSave();
+            Self->Current = 0;
+            Owner->Processed++;
+        }
+
+        Owner->Running--;
+        Self->Idle = true;
+        Self->NextIdle = Owner->IdleList;
+        Owner->IdleList = Self;
+
+        /* A Wake after the Unlock turns the Block into a Return, Idle Clears once Woken */
+        while (Self->Idle) {
+            Scheduler::PrepareToBlock();
+            Owner->Lock.UnlockIrqRestore(Flags);
+            Scheduler::Block();
+            Flags = Owner->Lock.LockIrqSave();
+        }
+    }
+}
+
+/// @brief Queues Delayed Work, Runs in the TIMER Bottom Half
+void Workqueue::DelayedTimer(void* Context)
+{
+    DelayedWork* Dw = (DelayedWork*)Context;
+    Insert(&Pools[Dw->Pool], &Dw->Wk);
+}
+
+/// @brief Cancels a Delayed Work Timer, Called on its Processor
+void Workqueue::CancelTimer(void* Context)
+{
+    CancelRequest* Request = (CancelRequest*)Context;
+    Request->Cancelled = TimerWheel::Cancel(&Request->Dw->Tmr);
+}
@@ -0,0 +1,241 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <drivers/hal/tsc.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/interrupts/softirq.hpp>
+#include <kernel/mem/tlb.hpp>
+#include <kernel/sched/sched.hpp>
+#include <kernel/smp/cpuidle.hpp>
+#include <kernel/time/tick.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::Tools::KernelRTL;
+
+/*
+    Nominal exit latencies and target residencies of the MWAIT
+    C-States. FUTURE: Take them from ACPI _CST (or _LPI) once the
+    AML interpreter exists, real values vary by model.
+*/
+static const CpuIdle::CState MwaitStates[KERNEL_CPUIDLE_MAXSTATES] = {
+    { "C1", 0x00, 2, 2 },
+    { "C2", 0x10, 50, 150 },
+    { "C3", 0x20, 100, 400 },
+    { "C4", 0x30, 150, 600 },
+    { "C5", 0x40, 200, 800 },
+    { "C6", 0x50, 250, 1000 },
+    { "C7", 0x60, 300, 1200 }
+};
+
+/* Define Statics */
+CpuIdle::CState CpuIdle::States[KERNEL_CPUIDLE_MAXSTATES] = { { "C1", 0x00, 2, 2 } };
+u32 CpuIdle::StateCount = 1;
+bool CpuIdle::MwaitSupported;
+bool CpuIdle::BreakOnMasked;
+CpuIdle::CpuState CpuIdle::Cpus[KERNEL_SMP_MAXCPUS];
+
+/// @brief Converts Recorded TSC Cycles for Display, Raw until Calibrated
+static u64 CyclesToNs(u64 Cycles)
+{
+    return (Tsc::Frequency) ? ClockSource::CyclesToNs(&Tsc::Clock, Cycles) : Cycles;
+}
+
+/// @brief Detects MONITOR/MWAIT and the C-States it Supports, Called on the BSP
+void CpuIdle::Initialize()
+{
+    /*
+        With MWAIT, an idle processor waits on a line of its own
+        (Cpus[N].Wakeup). A remote processor wakes it by writing
+        to the line, which is cheaper than an IPI on both sides.
+        The C-State is the deepest one whose target residency
+        fits before the next timer event, HLT is C1 without MWAIT.
+
+        Refer:
+        Intel SDM Vol. 2B, MWAIT (Table 4-10, MWAIT Extension Register)
+        Intel SDM Vol. 2A, CPUID Leaf 05H and 06H
+        https://www.kernel.org/doc/html/latest/admin-guide/pm/cpuidle.html
+    */
+
+    u32 Eax, Ebx, Ecx, Edx;
+    Cpu::Cpuid(1, 0, &Eax, &Ebx, &Ecx, &Edx);
+    if (!(Ecx & (1 << 3)) || Cpu::CpuidMaxLeaf(0) < 5) {
+        Logging::LogMessage(Logging::LogLevel::INFO, "Idle Driver: HLT");
+        return;
+    }
+
+    /* Leaf 5, ECX: Extensions Enumerated (Bit 0), Interrupts Break Masked MWAIT (Bit 1) */
+    Cpu::Cpuid(5, 0, &Eax, &Ebx, &Ecx, &Edx);
+    MwaitSupported = true;
+    BreakOnMasked = (Ecx & (1 << 0)) && (Ecx & (1 << 1));
+    u32 SubStates = (Ecx & (1 << 0)) ? Edx : 0;
+
+    /* States beyond C1 may stop the LAPIC Timer, unless it's Always Running (ARAT) */
+    bool AlwaysRunningTimer = false;
+    if (Cpu::CpuidMaxLeaf(0) >= 6) {
+        Cpu::Cpuid(6, 0, &Eax, &Ebx, &Ecx, &Edx);
+        AlwaysRunningTimer = (Eax & (1 << 2));
+    }
+
+    /* EDX Bits 4N+3:4N hold the Number of Sub-States of C-State N */
+    StateCount = 1;
+    for (u32 CState = 2; AlwaysRunningTimer && CState <= KERNEL_CPUIDLE_MAXSTATES; CState++) {
+        if ((SubStates >> (4 * CState)) & 0xF)
+            States[StateCount++] = MwaitStates[CState - 1];
+    }
+
+    printf("Idle Driver: MWAIT, C-States: ");
+    printf(StateCount);
+    printf("\n");
+}
+
+/// @brief Idles the Executing Processor, Called with IF Clear, Returns with IF Set
+void CpuIdle::Enter()
+{
+    u32 Self = Smp::CurrentCpu();
+    CpuState* State = &Cpus[Self];
+    u32 Index = SelectState(Tick::ExpectedIdleNs());
+    u64 Start = Cpu::ReadTsc();
+
+    if (MwaitSupported) {
+        /*
+            Mode is published before the line is armed, and work is
+            checked after. A waker that missed POLLING sends an IPI,
+            and one that saw it writes to the line, which either
+            ends the wait or lands before MONITOR and fails the check.
+        */
+
+        /* With Interrupts Masked till ExitLazy(), TLB Shootdowns can Skip this Processor */
+        if (BreakOnMasked)
+            Tlb::EnterLazy();
+
+        __atomic_store_n(&State->Mode, POLLING, __ATOMIC_SEQ_CST);
+        Cpu::Monitor(&State->Wakeup);
+
+        if (!Scheduler::NeedsResched() && !SoftIrq::IsPending()) {
+            if (BreakOnMasked)
+                Cpu::Mwait(States[Index].Hint, KERNEL_CPUIDLE_MWAIT_BREAKONMASKED);
+            else
+                Cpu::EnableInterruptsAndMwait(States[Index].Hint);
+        }
+
+        if (BreakOnMasked)
+            Tlb::ExitLazy();
+    } else {
+        __atomic_store_n(&State->Mode, HALTED, __ATOMIC_SEQ_CST);
+        Cpu::EnableInterruptsAndHalt();
+    }
+
+    u64 End = Cpu::ReadTsc();
+    __atomic_store_n(&State->Mode, RUNNING, __ATOMIC_SEQ_CST);
+
+    /* TSCs are Assumed Synchronized (Invariant TSC) across Processors */
+    u64 Requested = __atomic_exchange_n(&State->WakeRequest, 0, __ATOMIC_ACQUIRE);
+    if (Requested && End > Requested) {
+        u64 Latency = End - Requested;
+        State->Wakeups++;
+        State->WakeLatencyCycles += Latency;
+        if (Latency > State->MaxWakeLatencyCycles)
+            State->MaxWakeLatencyCycles = Latency;
+    }
+
+    State->Entries[Index]++;
+    State->ResidencyCycles[Index] += End - Start;
+    Cpu::EnableInterrupts();
+}
+
+/// @brief Wakes an Idle Processor without an IPI, if it's Waiting in MWAIT
+/// @param Cpu Logical CPU Index
+/// @return True if Woken, False if an IPI is needed (or it isn't Idle)
+bool CpuIdle::Wake(u32 Cpu)
+{
+    /* Orders the Caller's Work (e.g. NeedResched) before reading Mode */
+    CpuState* State = &Cpus[Cpu];
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    IdleMode Mode = __atomic_load_n(&State->Mode, __ATOMIC_RELAXED);
+    if (Mode == RUNNING)
+        return false;
+
+    u64 Expected = 0;
+    __atomic_compare_exchange_n(&State->WakeRequest, &Expected, ASM::Cpu::ReadTsc(), false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    if (Mode != POLLING)
+        return false;
+
+    __atomic_add_fetch(&State->Wakeup, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&State->MemoryWakeups, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+/// @brief Picks the Deepest C-State that Pays Off before the Next Event
+/// @param ExpectedNs Time till the Next Timer Event, KERNEL_TICK_NOEVENT if None
+/// @return Index into States
+u32 CpuIdle::SelectState(u64 ExpectedNs)
+{
+    u64 ExpectedUs = (ExpectedNs == KERNEL_TICK_NOEVENT) ? ~0ULL : ExpectedNs / 1000;
+    u32 Index = 0;
+
+    for (u32 State = 1; State < StateCount; State++) {
+        if (States[State].TargetResidencyUs <= ExpectedUs)
+            Index = State;
+    }
+
+    return Index;
+}
+
+/// @brief Writes Idle Residency and Wakeup Latency of every Processor to the Kernel Log
+void CpuIdle::Dump()
+{
+    Logging::LogMessage(Logging::LogLevel::INFO, "Idle Statistics (CPU STATE ENTRIES RESIDENCYUS):");
+    for (u32 Cpu = 0; Cpu < Smp::CpuCount || Cpu == 0; Cpu++) {
+        for (u32 State = 0; State < StateCount; State++) {
+            if (!Cpus[Cpu].Entries[State])
+                continue;
+
+            printf("\n    ");
+            printf(Cpu);
+            printf(" ");
+            printf((char*)States[State].Name);
+            printf(" ");
+            printf(Cpus[Cpu].Entries[State]);
+            printf(" ");
+            printf(CyclesToNs(Cpus[Cpu].ResidencyCycles[State]) / 1000);
+        }
+    }
+
+    Logging::LogMessage(Logging::LogLevel::INFO, "Idle Wakeups (CPU WAKEUPS NOIPI AVGNS MAXNS):");
+    for (u32 Cpu = 0; Cpu < Smp::CpuCount || Cpu == 0; Cpu++) {
+        CpuState* State = &Cpus[Cpu];
+        if (!State->Wakeups)
+            continue;
+
+        printf("\n    ");
+        printf(Cpu);
+        printf(" ");
+        printf(State->Wakeups);
+        printf(" ");
+        printf(State->MemoryWakeups);
+        printf(" ");
+        printf(CyclesToNs(State->WakeLatencyCycles / State->Wakeups));
+        printf(" ");
+        printf(CyclesToNs(State->MaxWakeLatencyCycles));
+    }
+}
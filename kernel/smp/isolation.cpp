@@ -0,0 +1,189 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <kernel/assert/logging.hpp>
+#include <kernel/multiboot/mbpvdr.hpp>
+#include <kernel/smp/isolation.hpp>
+#include <kernel/smp/topology.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+u64 Isolation::Isolated[KERNEL_ISOLATION_MASKWORDS];
+u64 Isolation::NoHzFull[KERNEL_ISOLATION_MASKWORDS];
+u64 Isolation::Housekeeping[KERNEL_ISOLATION_MASKWORDS];
+
+/// @brief Reads the Isolated Processors off the Command Line, after Smp::Initialize()
+void Isolation::Initialize()
+{
+    /*
+        Isolated processors are left to threads given an affinity
+        for them. Threads get the housekeeping processors as their
+        default affinity, so unbound work (workqueue workers too)
+        never lands on an isolated one, and the load balancer
+        neither pulls to nor steals from them. Device interrupts
+        are steered to the nearest housekeeping processor.
+
+        With nohz_full, an isolated processor running a single
+        thread also stops its tick, save for a residual one per
+        second (RCU and accounting). What's left is measurable as
+        the interrupt counts of the processor, InterruptStats.
+
+        isolcpus=<list> Isolates the listed Processors
+        nohz_full Stops the Tick of every Isolated Processor
+        nohz_full=<list> Isolates the listed Processors, Stopping their Tick
+
+        Lists are comma separated, with ranges (1,4-7). The boot
+        processor keeps timekeeping and is never isolated.
+
+        Refer:
+        https://docs.kernel.org/admin-guide/kernel-per-CPU-kthreads.html
+        https://docs.kernel.org/timers/no_hz.html#omit-scheduling-clock-ticks-for-cpus-with-only-one-runnable-task
+    */
+
+    const char* IsolCpus = MBootProvider::GetParameter("isolcpus");
+    if (IsolCpus && !ParseCpuList(IsolCpus, Isolated))
+        Logging::LogMessage(Logging::LogLevel::WARNING, "Malformed isolcpus= List, Ignored");
+
+    const char* NoHz = MBootProvider::GetParameter("nohz_full");
+    if (NoHz && !*NoHz) {
+        memcpy(NoHzFull, Isolated, sizeof(NoHzFull));
+    } else if (NoHz) {
+        if (!ParseCpuList(NoHz, NoHzFull))
+            Logging::LogMessage(Logging::LogLevel::WARNING, "Malformed nohz_full= List, Ignored");
+
+        for (u32 Word = 0; Word < KERNEL_ISOLATION_MASKWORDS; Word++)
+            Isolated[Word] |= NoHzFull[Word];
+    }
+
+    /* Unregistered Processors never come Online */
+    for (u32 Cpu = 0; Cpu < KERNEL_SMP_MAXCPUS; Cpu++) {
+        bool Keep = (Cpu < Smp::CpuCount) && (Cpu == KERNEL_SMP_BOOTCPU || !IsIsolated(Cpu));
+        if (!Keep) {
+            Isolated[Cpu / 64] &= ~(1ULL << (Cpu % 64));
+            NoHzFull[Cpu / 64] &= ~(1ULL << (Cpu % 64));
+        }
+
+        if (Cpu < Smp::CpuCount && !IsIsolated(Cpu))
+            Housekeeping[Cpu / 64] |= (1ULL << (Cpu % 64));
+    }
+
+    Dump();
+}
+
+/// @brief Picks the Processor a Device Interrupt is Delivered to
+/// @param Cpu Logical CPU Index Requested by the Driver
+/// @return Cpu if it is a Housekeeping one, else the Nearest Housekeeping Processor
+u32 Isolation::IrqCpu(u32 Cpu)
+{
+    if (IsHousekeeping(Cpu))
+        return Cpu;
+
+    /* An SMT Sibling or LLC Neighbour keeps the Handler's Data Cache-Warm */
+    if (Topology::Cpus[Cpu].Known) {
+        for (u32 Domain = Topology::SMT; Domain < Topology::LEVELS; Domain++) {
+            for (u32 Word = 0; Word < KERNEL_ISOLATION_MASKWORDS; Word++) {
+                u64 Candidates = Topology::Cpus[Cpu].Siblings[Domain][Word] & Housekeeping[Word];
+                if (Candidates)
+                    return (Word * 64) + __builtin_ctzll(Candidates);
+            }
+        }
+    }
+
+    return KERNEL_SMP_BOOTCPU;
+}
+
+/// @brief Drops a Processor that Failed to Start from every Set
+/// @param Cpu Logical CPU Index, never the Bootstrap Processor
+void Isolation::RemoveCpu(u32 Cpu)
+{
+    u64 Bit = 1ULL << (Cpu % 64);
+    Isolated[Cpu / 64] &= ~Bit;
+    NoHzFull[Cpu / 64] &= ~Bit;
+    Housekeeping[Cpu / 64] &= ~Bit;
+}
+
+/// @brief Prints the Isolated Processors
+void Isolation::Dump()
+{
+    bool Any = false;
+    for (u32 Word = 0; Word < KERNEL_ISOLATION_MASKWORDS; Word++)
+        Any |= (Isolated[Word] != 0);
+
+    if (!Any)
+        return;
+
+    printf("Isolated CPUs:");
+    for (u32 Cpu = 0; Cpu < Smp::CpuCount; Cpu++) {
+        if (!IsIsolated(Cpu))
+            continue;
+
+        printf(" ");
+        printf(Cpu);
+        if (IsNoHzFull(Cpu))
+            printf(" (NOHZ Full)");
+    }
+
+    printf("\n");
+}
+
+/// @brief Parses a CPU List such as "1,4-7" into a Mask
+/// @param List Terminated by a Space or Null
+/// @param Mask [out] Bits of the Listed Processors are Set
+/// @return True if the whole List was Valid
+bool Isolation::ParseCpuList(const char* List, u64* Mask)
+{
+    /* Nothing is Set unless the whole List Parses */
+    u64 Parsed[KERNEL_ISOLATION_MASKWORDS] = {};
+
+    while (*List && *List != ' ') {
+        u32 First = 0, Last;
+        if (*List < '0' || *List > '9')
+            return false;
+
+        while (*List >= '0' && *List <= '9')
+            First = (First * 10) + (*List++ - '0');
+
+        Last = First;
+        if (*List == '-') {
+            List++;
+            if (*List < '0' || *List > '9')
+                return false;
+
+            Last = 0;
+            while (*List >= '0' && *List <= '9')
+                Last = (Last * 10) + (*List++ - '0');
+        }
+
+        if (Last < First || Last >= KERNEL_SMP_MAXCPUS)
+            return false;
+
+        for (u32 Cpu = First; Cpu <= Last; Cpu++)
+            Parsed[Cpu / 64] |= (1ULL << (Cpu % 64));
+
+        if (*List == ',')
+            List++;
+    }
+
+    for (u32 Word = 0; Word < KERNEL_ISOLATION_MASKWORDS; Word++)
+        Mask[Word] |= Parsed[Word];
+
+    return true;
+}
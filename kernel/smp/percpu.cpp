@@ -0,0 +1,86 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/mem/bootmem.hpp>
+#include <kernel/smp/percpu.hpp>
+#include <kernel/smp/smp.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+u64 PerCpu::Offsets[KERNEL_SMP_MAXCPUS];
+KERNEL_PERCPU u64 PerCpu::Offset;
+
+/// @brief Gives the Bootstrap Processor its Copy, Usable before any Allocator
+void PerCpu::InitializeBootCpu()
+{
+    /*
+        The BSP's copy is reserved in .bss by linker.ld. Using the
+        template in place would leave APs started later to copy
+        whatever the BSP had written into it by then.
+    */
+
+    memcpy(PERCPU_BOOT, PERCPU_START, PERCPU_END - PERCPU_START);
+    Offsets[KERNEL_SMP_BOOTCPU] = (u64)(PERCPU_BOOT - PERCPU_START);
+    *Remote(Offset, KERNEL_SMP_BOOTCPU) = Offsets[KERNEL_SMP_BOOTCPU];
+    Load(KERNEL_SMP_BOOTCPU);
+}
+
+/// @brief Allocates and Initializes the Copy of a Processor
+/// @param Cpu Logical CPU Index
+/// @return True if Allocated, False otherwise
+bool PerCpu::Allocate(u32 Cpu)
+{
+    u64 Size = PERCPU_END - PERCPU_START;
+    u8* Copy = (u8*)BootMem::VirtAllocateBlock(BootMem::AlignAddressToPage(Size) / KERNEL_BOOTMEM_PMMGR_BLOCKSIZE);
+    if (!Copy)
+        return false;
+
+    memcpy(Copy, PERCPU_START, Size);
+    Offsets[Cpu] = (u64)(Copy - PERCPU_START);
+    *Remote(Offset, Cpu) = Offsets[Cpu];
+    return true;
+}
+
+/// @brief Frees the Copy of a Processor that never came Online
+/// @param Cpu Logical CPU Index
+void PerCpu::Free(u32 Cpu)
+{
+    if (!Offsets[Cpu] || Cpu == KERNEL_SMP_BOOTCPU)
+        return;
+
+    u64 Size = PERCPU_END - PERCPU_START;
+    BootMem::VirtFreeBlock((BootMem::VirtualAddress*)(PERCPU_START + Offsets[Cpu]), BootMem::AlignAddressToPage(Size) / KERNEL_BOOTMEM_PMMGR_BLOCKSIZE);
+    Offsets[Cpu] = 0;
+}
+
+/// @brief Points the GS Base of the Executing Processor at its Copy
+/// @param Cpu Logical CPU Index of the Executing Processor
+void PerCpu::Load(u32 Cpu)
+{
+    /*
+        GS is otherwise unused by the kernel. In long mode, its base
+        comes from IA32_GS_BASE and not the descriptor, so the MSR
+        value survives till a selector is loaded into GS again.
+    */
+
+    ASM::Cpu::WriteMsr(ASM_CPU_MSR_GSBASE, Offsets[Cpu]);
+}
@@ -0,0 +1,419 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <drivers/acpi/acpipvdr.hpp>
+#include <drivers/hal/apic.hpp>
+#include <drivers/hal/lapictimer.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/interrupts/gdtdef.hpp>
+#include <kernel/interrupts/intrdef.hpp>
+#include <kernel/interrupts/intrstat.hpp>
+#include <kernel/interrupts/softirq.hpp>
+#include <kernel/mem/bootmem.hpp>
+#include <kernel/mem/tlb.hpp>
+#include <kernel/sched/fpu.hpp>
+#include <kernel/sched/sched.hpp>
+#include <kernel/sched/workqueue.hpp>
+#include <kernel/smp/cpuidle.hpp>
+#include <kernel/smp/isolation.hpp>
+#include <kernel/smp/smp.hpp>
+#include <kernel/smp/smpcall.hpp>
+#include <kernel/smp/topology.hpp>
+#include <kernel/sync/rcu.hpp>
+#include <kernel/time/delay.hpp>
+#include <kernel/time/tick.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Drivers::Acpi;
+using namespace tacOS::Drivers::HAL;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+Smp::CpuInfo* Smp::Cpus;
+u32 Smp::CpuCount;
+volatile u32 Smp::OnlineCount;
+
+KERNEL_PERCPU u32 Smp::CpuIndex;
+static u32 CpuCapacity;
+
+/* Defined in trampoline.asm */
+extern "C" u8 TrampolineStart[];
+extern "C" u8 TrampolineParams[];
+extern "C" u8 TrampolineEnd[];
+
+/// @brief Trampoline Parameters, Layout matches trampoline.asm
+struct TrampolineParameters {
+    u16 GdtLimit;
+    u32 GdtBase; /* Offsets below are Rebased to the Load Address */
+    u32 ProtectedEntry;
+    u16 ProtectedSelector;
+    u32 LongEntry;
+    u16 LongSelector;
+    u64 Cr3;
+    u64 Stack;
+    u64 Entry;
+    u64 Cpu;
+    u64 Xcr0; /* Extended State Enabled by the BSP, 0 if None */
+} __attribute__((packed));
+
+static TrampolineParameters* Params;
+
+/* Processor being Started, Claimed by it or Abandoned by the BSP on a Timeout */
+static volatile u64 StartingCpu;
+
+/// @brief Returns the Number of Blocks covering an Object
+static inline u64 BlocksFor(u64 Size)
+{
+    return BootMem::AlignAddressToPage(Size) / KERNEL_BOOTMEM_PMMGR_BLOCKSIZE;
+}
+
+/// @brief Releases what StartCpu() Allocated for a Processor that never came Online
+static void ReleaseCpu(u32 Cpu, Gdt::CpuTables* Tables, Interrupt::VectorTable* Vectors, InterruptStats::CpuStats* Stats, u8* Stack)
+{
+    Gdt::Tables[Cpu] = 0;
+    Interrupt::VectorTables[Cpu] = 0;
+    InterruptStats::Stats[Cpu] = 0;
+    PerCpu::Free(Cpu);
+
+    if (Tables)
+        BootMem::VirtFreeBlock((BootMem::VirtualAddress*)Tables, BlocksFor(sizeof(Gdt::CpuTables)));
+    if (Vectors)
+        BootMem::VirtFreeBlock((BootMem::VirtualAddress*)Vectors, BlocksFor(sizeof(Interrupt::VectorTable)));
+    if (Stats)
+        BootMem::VirtFreeBlock((BootMem::VirtualAddress*)Stats, BlocksFor(sizeof(InterruptStats::CpuStats)));
+    if (Stack)
+        BootMem::VirtFreeBlock((BootMem::VirtualAddress*)Stack, KERNEL_SMP_STACKPAGES);
+}
+
+/// @brief Makes Per-CPU Variables and CurrentCpu() usable on the Bootstrap Processor
+void Smp::InitializeBootCpu()
+{
+    /* The Template's CpuIndex is KERNEL_SMP_BOOTCPU */
+    PerCpu::InitializeBootCpu();
+}
+
+/// @brief Builds the Processor Registry from the MADT
+void Smp::Initialize()
+{
+    /*
+        Processors are listed as Local APIC entries, and as Local
+        x2APIC entries if their APIC ID does not fit in 8 bits. The
+        MADT is walked twice, once to size the registry and once to
+        fill it. Disabled processors are skipped. Online-capable
+        ones are reserved for hot-add and are not started either.
+
+        Logical indices follow MADT order, except the Bootstrap
+        Processor is always index 0, whatever its position.
+
+        Refer:
+        https://uefi.org/htmlspecs/ACPI_Spec_6_4_html/05_ACPI_Software_Programming_Model/ACPI_Software_Programming_Model.html#processor-local-x2apic-structure
+    */
+
+    AcpiDef::Address MadtAddr;
+    AcpiDef::GetTableBySignature(ACPI_SIG_MADT, AcpiProvider::Xsdt, &MadtAddr);
+    AcpiDef::Madt* Madt = (AcpiDef::Madt*)MadtAddr;
+
+    u32 Discovered = 0;
+    for (u32 Pass = 0; Pass < 2; Pass++) {
+        u8* MadtEntryPtr = (u8*)(Madt + 1);
+        u8* MadtEnd = (u8*)Madt + Madt->Header.Length;
+
+        while (MadtEntryPtr < MadtEnd) {
+            AcpiDef::MadtEntryHeader* Header = (AcpiDef::MadtEntryHeader*)MadtEntryPtr;
+            MadtEntryPtr += Header->RecordLength;
+
+            u32 ApicId, AcpiId, Flags;
+            if (Header->EntryType == AcpiDef::MadtEntryType::LOCAL_APIC) {
+                AcpiDef::MadtEntryLocalApic* LApic = (AcpiDef::MadtEntryLocalApic*)Header;
+                ApicId = LApic->ApicId, AcpiId = LApic->AcpiProcessorId, Flags = LApic->Flags;
+            } else if (Header->EntryType == AcpiDef::MadtEntryType::LOCAL_X2APIC) {
+                AcpiDef::MadtEntryLocalX2Apic* LX2Apic = (AcpiDef::MadtEntryLocalX2Apic*)Header;
+                ApicId = LX2Apic->ApicId, AcpiId = LX2Apic->AcpiId, Flags = LX2Apic->Flags;
+            } else {
+                continue;
+            }
+
+            /* IDs past the xAPIC Range are Unreachable without x2APIC Mode */
+            if (!(Flags & ACPI_MADT_LAPIC_ENABLED))
+                continue;
+            if (ApicId > APIC_X2APIC_MAXXAPICID && !Apic::X2ApicMode)
+                continue;
+
+            if (Pass == 0)
+                Discovered++;
+            else
+                RegisterCpu(ApicId, AcpiId);
+        }
+
+        if (Pass == 0) {
+            /* Per-CPU Tables are Statically Sized, Processors past them are Ignored */
+            if (Discovered > KERNEL_SMP_MAXCPUS) {
+                Logging::LogMessage(Logging::LogLevel::WARNING, "More Processors than KERNEL_SMP_MAXCPUS, Ignoring the Rest");
+                Discovered = KERNEL_SMP_MAXCPUS;
+            }
+
+            CpuCapacity = (Discovered) ? Discovered : 1;
+            Cpus = (CpuInfo*)BootMem::VirtAllocateBlock(BlocksFor(CpuCapacity * sizeof(CpuInfo)));
+            if (!Cpus) {
+                Logging::LogMessage(Logging::LogLevel::ERROR, "Processor Registry Allocation Failed");
+                return;
+            }
+
+            Cpus[0].ApicId = Apic::GetLocalApicId();
+            Cpus[0].Online = true;
+            CpuCount = 1;
+        }
+    }
+
+    OnlineCount = 1;
+
+    printf("Processors Registered: ");
+    printf(CpuCount);
+    printf("\n");
+}
+
+/// @brief Appends a Processor to the Registry
+/// @param ApicId Local APIC ID
+/// @param AcpiId ACPI Processor UID
+void Smp::RegisterCpu(u32 ApicId, u32 AcpiId)
+{
+    if (ApicId == Cpus[KERNEL_SMP_BOOTCPU].ApicId) {
+        Cpus[KERNEL_SMP_BOOTCPU].AcpiId = AcpiId;
+        return;
+    }
+
+    /* Firmware should not list a Processor twice, but some do */
+    for (u32 Cpu = 0; Cpu < CpuCount; Cpu++) {
+        if (Cpus[Cpu].ApicId == ApicId)
+            return;
+    }
+
+    if (CpuCount == CpuCapacity)
+        return;
+
+    CpuInfo* Info = &Cpus[CpuCount];
+    Info->ApicId = ApicId;
+    Info->AcpiId = AcpiId;
+    Info->Online = false;
+    CpuCount++;
+}
+
+/// @brief Starts every Registered Application Processor
+void Smp::StartApplicationProcessors()
+{
+    /*
+        An Application Processor (AP) waits for a Startup IPI after
+        an INIT IPI. The SIPI vector selects the 4KB page below 1MB
+        it starts executing in, in real mode. The trampoline copied
+        there switches to long mode on the kernel's page tables and
+        calls ApplicationProcessorMain() on a freshly allocated stack.
+
+        BootMem never hands out frames below the kernel image, so
+        the trampoline page cannot be in use by an allocation. APs
+        are started one at a time, as they share its parameters.
+
+        Refer:
+        https://wiki.osdev.org/SMP
+        Intel SDM Vol. 3A, Section 9.4.4.1 (Typical BSP Initialization Sequence)
+    */
+
+    if (!Cpus || CpuCount < 2 || !Apic::LocalApicAddr)
+        return;
+
+    u64 Cr3;
+    __asm__ volatile("mov %%cr3, %0" : "=r"(Cr3));
+
+    u8* Trampoline = (u8*)KERNEL_SMP_TRAMPOLINE;
+    memcpy(Trampoline, TrampolineStart, TrampolineEnd - TrampolineStart);
+
+    Params = (TrampolineParameters*)(Trampoline + (TrampolineParams - TrampolineStart));
+    Params->GdtBase += KERNEL_SMP_TRAMPOLINE;
+    Params->ProtectedEntry += KERNEL_SMP_TRAMPOLINE;
+    Params->LongEntry += KERNEL_SMP_TRAMPOLINE;
+    Params->Cr3 = Cr3;
+    Params->Entry = (u64)&ApplicationProcessorMain;
+    Params->Xcr0 = Fpu::Features;
+
+    for (u32 Cpu = 1; Cpu < CpuCount; Cpu++) {
+        if (!StartCpu(Cpu)) {
+            /* Stays Registered but Offline, Interrupts and Threads are Kept off it */
+            Isolation::RemoveCpu(Cpu);
+            printf("Processor Failed to Start (APIC ID): ");
+            printf(Cpus[Cpu].ApicId);
+            printf("\n");
+        }
+    }
+
+    printf("Processors Online: ");
+    printf(OnlineCount);
+    printf("\n");
+}
+
+/// @brief Prepares and Starts an Application Processor
+/// @param Cpu Logical CPU Index
+/// @return True if the Processor came Online, False otherwise
+bool Smp::StartCpu(u32 Cpu)
+{
+    /* Everything the AP touches before its Tick runs is Allocated Here */
+    Gdt::CpuTables* Tables = (Gdt::CpuTables*)BootMem::VirtAllocateBlock(BlocksFor(sizeof(Gdt::CpuTables)));
+    Interrupt::VectorTable* Vectors = (Interrupt::VectorTable*)BootMem::VirtAllocateBlock(BlocksFor(sizeof(Interrupt::VectorTable)));
+    InterruptStats::CpuStats* Stats = (InterruptStats::CpuStats*)BootMem::VirtAllocateBlock(BlocksFor(sizeof(InterruptStats::CpuStats)));
+    u8* Stack = (u8*)BootMem::VirtAllocateBlock(KERNEL_SMP_STACKPAGES);
+
+    if (!Tables || !Vectors || !Stats || !Stack || !PerCpu::Allocate(Cpu)) {
+        ReleaseCpu(Cpu, Tables, Vectors, Stats, Stack);
+        return false;
+    }
+
+    *PerCpu::Remote(CpuIndex, Cpu) = Cpu;
+    Gdt::Initialize(Cpu, Tables);
+    Interrupt::VectorTables[Cpu] = Vectors;
+    InterruptStats::Stats[Cpu] = Stats;
+
+    Params->Stack = (u64)(Stack + (KERNEL_SMP_STACKPAGES * KERNEL_BOOTMEM_PMMGR_BLOCKSIZE));
+    Params->Cpu = Cpu;
+    __atomic_store_n(&StartingCpu, Cpu, __ATOMIC_RELEASE);
+
+    /*
+        INIT, then up to two SIPIs, per the MP Specification. The
+        second SIPI is ignored by a processor that already started.
+        An AP sets Online only after it's done with the parameters.
+    */
+
+    CpuInfo* Info = &Cpus[Cpu];
+    Apic::SendIpi(Info->ApicId, APIC_LAPIC_ICR_INIT | APIC_LAPIC_ICR_ASSERT | APIC_LAPIC_ICR_LEVEL);
+    Delay::Microseconds(KERNEL_SMP_INITDELAYUS);
+
+    for (u32 Attempt = 0; Attempt < 2 && !Info->Online; Attempt++) {
+        Apic::SendIpi(Info->ApicId, APIC_LAPIC_ICR_STARTUP | (KERNEL_SMP_TRAMPOLINE >> 12));
+        Delay::Microseconds(KERNEL_SMP_SIPIDELAYUS);
+    }
+
+    for (u32 Waited = 0; !Info->Online && Waited < KERNEL_SMP_ONLINETIMEOUTUS; Waited += 100)
+        Delay::Microseconds(100);
+
+    if (Info->Online)
+        return true;
+
+    /*
+        On a timeout, the AP may still be in the trampoline and read
+        the parameters after they're rewritten for the next one. It
+        races the BSP for StartingCpu on entering the kernel. If it
+        claimed it, it's past the parameters and is left to finish.
+        Otherwise, it halts there, and INIT holds it in wait-for-SIPI
+        before its stack and tables are freed.
+    */
+
+    u64 Expected = Cpu;
+    if (!__atomic_compare_exchange_n(&StartingCpu, &Expected, KERNEL_SMP_MAXCPUS, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        while (!Info->Online)
+            Delay::Microseconds(100);
+
+        return true;
+    }
+
+    Apic::SendIpi(Info->ApicId, APIC_LAPIC_ICR_INIT | APIC_LAPIC_ICR_ASSERT | APIC_LAPIC_ICR_LEVEL);
+    Delay::Microseconds(KERNEL_SMP_INITDELAYUS);
+
+    ReleaseCpu(Cpu, Tables, Vectors, Stats, Stack);
+    return false;
+}
+
+/// @brief First C++ Code run by an Application Processor
+/// @param Cpu Logical CPU Index, passed by the Trampoline
+void Smp::ApplicationProcessorMain(u64 Cpu)
+{
+    /* Abandoned by the BSP, which sends INIT next */
+    u64 Expected = Cpu;
+    if (!__atomic_compare_exchange_n(&StartingCpu, &Expected, KERNEL_SMP_MAXCPUS, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        for (;;)
+            __asm__ volatile("cli; hlt");
+    }
+
+    PerCpu::Load((u32)Cpu);
+    Interrupt::InitializeCpu((u32)Cpu);
+
+    /* The LAPIC Timer was Calibrated by the BSP, it drives the Tick */
+    Apic::EnableLocalApic();
+    if (LapicTimer::Frequency)
+        LapicTimer::InitializeCpu((u32)Cpu);
+
+    SmpCall::InitializeCpu((u32)Cpu);
+    Tlb::InitializeCpu((u32)Cpu);
+    Rcu::InitializeCpu((u32)Cpu);
+
+    /* The Trampoline's Context becomes the Idle Thread, Balanced in its Domains */
+    Topology::InitializeCpu((u32)Cpu);
+    Scheduler::InitializeCpu((u32)Cpu);
+    Workqueue::InitializeCpu((u32)Cpu);
+
+    Cpus[Cpu].Online = true;
+    __atomic_add_fetch(&OnlineCount, 1, __ATOMIC_RELEASE);
+    Idle();
+}
+
+/// @brief Translates a Logical CPU Index to its Local APIC ID
+/// @param Cpu Logical CPU Index
+/// @return Local APIC ID used as an Interrupt Destination
+u32 Smp::GetApicId(u32 Cpu)
+{
+    return (Cpus) ? Cpus[Cpu].ApicId : Apic::GetLocalApicId();
+}
+
+/// @brief Idle Loop of every Processor, Never Returns
+void Smp::Idle()
+{
+    for (;;) {
+        /*
+            Halt CPU till next Interrupt. This Prevents 100%
+            CPU Utilization and improves efficiency. Bottom halves
+            left over by a budget-limited interrupt exit are run
+            first. Interrupts are disabled while checking, so work
+            queued after the check wakes us from idle. The tick is
+            stopped while idle, only pending timers wake the CPU.
+            Runnable threads are switched to before idling, the
+            idle thread is never preempted on interrupt exit.
+            CpuIdle picks HLT or an MWAIT C-State.
+        */
+
+        Cpu::DisableInterrupts();
+        if (SoftIrq::IsPending()) {
+            Cpu::EnableInterrupts();
+            SoftIrq::Run();
+            continue;
+        }
+
+        if (Scheduler::NeedsResched()) {
+            Scheduler::Yield();
+            Cpu::EnableInterrupts();
+            continue;
+        }
+
+        Rcu::EnterIdle();
+        Tick::EnterIdle();
+        CpuIdle::Enter();
+
+        Cpu::DisableInterrupts();
+        Tick::ExitIdle();
+        Rcu::ExitIdle();
+        Cpu::EnableInterrupts();
+    }
+}
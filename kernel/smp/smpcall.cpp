@@ -0,0 +1,222 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <drivers/hal/apic.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/interrupts/intrdef.hpp>
+#include <kernel/mem/tlb.hpp>
+#include <kernel/smp/smpcall.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Drivers::HAL;
+
+/* Define Statics */
+SmpCall::CpuQueue SmpCall::Queues[KERNEL_SMP_MAXCPUS];
+
+/// @brief Sets up Remote Calls, the Bootstrap Processor Joins
+void SmpCall::Initialize()
+{
+    /*
+        Each processor has a lock-free MPSC queue of requests.
+        Senders push with one compare-exchange, and only the one
+        that finds the queue empty sends an IPI. Calls queued
+        before the target drains ride on that IPI, so a burst to
+        one processor costs a single interrupt. The handler takes
+        the whole queue at once and runs it in order.
+
+        Requests belong to the caller, no allocation is done.
+        Queue() is asynchronous, Busy clears once the routine
+        has run. Call() and CallMany() wait, serving requests
+        sent to the waiting processor, so two processors calling
+        each other don't deadlock. Routines run in interrupt
+        context with IF clear, they must not block.
+
+        Refer:
+        https://www.kernel.org/doc/html/latest/core-api/kernel-api.html (smp_call_function_single)
+    */
+
+    InitializeCpu(KERNEL_SMP_BOOTCPU);
+}
+
+/// @brief Makes the Executing Processor a Call Target
+/// @param Cpu Logical CPU Index of the Executing Processor
+void SmpCall::InitializeCpu(u32 Cpu)
+{
+    u8 Vector = Interrupt::AllocateVector(Cpu, Interrupt::IPI);
+    if (!Vector || !Interrupt::BindHandler(Cpu, Vector, CallInterrupt, 0)) {
+        Logging::LogMessage(Logging::LogLevel::CRITICAL, "SMP Call Vector Allocation Failed");
+        return;
+    }
+
+    __atomic_store_n(&Queues[Cpu].Vector, Vector, __ATOMIC_RELEASE);
+}
+
+/// @brief Runs a Routine on a Processor without Waiting
+/// @param Cpu Logical CPU Index of the Target
+/// @param Req Request with Routine and Context Set, Busy till it has Run
+/// @return False if the Request is still Busy or the Target can't be Called
+bool SmpCall::Queue(u32 Cpu, Request* Req)
+{
+    if (__atomic_load_n(&Req->Busy, __ATOMIC_ACQUIRE))
+        return false;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    bool Queued = Submit(Cpu, Req);
+    Cpu::RestoreFlags(Flags);
+    return Queued;
+}
+
+/// @brief Runs a Routine on a Processor, Returns once it has Run
+/// @param Cpu Logical CPU Index of the Target, may be the Executing one
+/// @return False if the Target can't be Called
+bool SmpCall::Call(u32 Cpu, CallRoutine Routine, void* Context)
+{
+    Request Req = {};
+    Req.Routine = Routine;
+    Req.Context = Context;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    bool Queued = Submit(Cpu, &Req);
+    if (Queued)
+        Wait(&Req);
+
+    Cpu::RestoreFlags(Flags);
+    return Queued;
+}
+
+/// @brief Runs a Routine on a Set of Processors, Returns once all are Done
+/// @param Mask KERNEL_SMPCALL_MASKWORDS Words, may include the Executing Processor
+void SmpCall::CallMany(const u64* Mask, CallRoutine Routine, void* Context)
+{
+    /*
+        Requests are sent in rounds of KERNEL_SMPCALL_MANYBATCH,
+        the targets of a round run in parallel. The executing
+        processor runs its own call last, while others work.
+    */
+
+    Request Reqs[KERNEL_SMPCALL_MANYBATCH];
+    u32 InFlight = 0;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    u32 Self = Smp::CurrentCpu();
+
+    for (u32 Word = 0; Word < KERNEL_SMPCALL_MASKWORDS; Word++) {
+        u64 Targets = Mask[Word];
+        if (Word == Self / 64)
+            Targets &= ~(1ULL << (Self % 64));
+
+        while (Targets) {
+            u32 Target = (Word * 64) + __builtin_ctzll(Targets);
+            Targets &= Targets - 1;
+
+            Request* Req = &Reqs[InFlight];
+            Req->Routine = Routine;
+            Req->Context = Context;
+            Req->Busy = false;
+            if (!Submit(Target, Req))
+                continue;
+
+            if (++InFlight == KERNEL_SMPCALL_MANYBATCH) {
+                for (u32 Index = 0; Index < InFlight; Index++)
+                    Wait(&Reqs[Index]);
+
+                InFlight = 0;
+            }
+        }
+    }
+
+    if (Mask[Self / 64] & (1ULL << (Self % 64)))
+        Routine(Context);
+
+    for (u32 Index = 0; Index < InFlight; Index++)
+        Wait(&Reqs[Index]);
+
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Runs a Routine on every Online Processor, Returns once all are Done
+void SmpCall::CallAll(CallRoutine Routine, void* Context)
+{
+    u64 Mask[KERNEL_SMPCALL_MASKWORDS] = {};
+    for (u32 Cpu = 0; Cpu < Smp::CpuCount; Cpu++) {
+        if (Smp::Cpus[Cpu].Online)
+            Mask[Cpu / 64] |= (1ULL << (Cpu % 64));
+    }
+
+    CallMany(Mask, Routine, Context);
+}
+
+/// @brief Runs every Request Queued to the Executing Processor, IF Clear
+void SmpCall::ProcessPending()
+{
+    CpuQueue* Me = &Queues[Smp::CurrentCpu()];
+    Tools::KernelRTL::MpscNode* Node = Me->Pending.PopAll();
+
+    while (Node) {
+        /* Busy Clears last, the Owner may Reuse the Request (and its Next) after */
+        Request* Req = (Request*)Node;
+        Node = Node->Next;
+
+        Req->Routine(Req->Context);
+        Me->Calls++;
+        __atomic_store_n(&Req->Busy, false, __ATOMIC_RELEASE);
+    }
+}
+
+/// @brief Queues a Request, Notifying the Target if its Queue was Empty, IF Clear
+bool SmpCall::Submit(u32 Cpu, Request* Req)
+{
+    if (Cpu >= Smp::CpuCount)
+        return false;
+
+    /* Calls to the Executing Processor run Directly */
+    if (Cpu == Smp::CurrentCpu()) {
+        Req->Routine(Req->Context);
+        return true;
+    }
+
+    u8 Vector = __atomic_load_n(&Queues[Cpu].Vector, __ATOMIC_ACQUIRE);
+    if (!Vector)
+        return false;
+
+    Req->Busy = true;
+    if (Queues[Cpu].Pending.Push(&Req->Node))
+        Apic::SendIpi(Smp::GetApicId(Cpu), APIC_LAPIC_ICR_FIXED | Vector);
+
+    return true;
+}
+
+/// @brief Waits for a Request, Serving Calls and Shootdowns to the Executing Processor meanwhile, IF Clear
+void SmpCall::Wait(Request* Req)
+{
+    /* The Target may be Waiting for this one's TLB Flush, with IF Clear too */
+    while (__atomic_load_n(&Req->Busy, __ATOMIC_ACQUIRE)) {
+        ProcessPending();
+        Tlb::ProcessPending();
+        Cpu::Pause();
+    }
+}
+
+/// @brief Call IPI
+void SmpCall::CallInterrupt(u8 Vector, void* Context)
+{
+    Queues[Smp::CurrentCpu()].Interrupts++;
+    ProcessPending();
+}
@@ -0,0 +1,244 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/smp/topology.hpp>
+#include <tools/kernelrtl/kernelrtl.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+static LockClass TopologyLockClass = { "topology" };
+Topology::CpuTopology Topology::Cpus[KERNEL_SMP_MAXCPUS];
+TicketLock Topology::Lock(&TopologyLockClass);
+u32 Topology::SmtShift;
+u32 Topology::PackageShift;
+u32 Topology::LlcShift;
+
+/// @brief Returns the APIC ID Bits needed to Number a Count of Units
+static inline u32 BitsFor(u32 Count)
+{
+    return (Count <= 1) ? 0 : 32 - __builtin_clz(Count - 1);
+}
+
+/// @brief Enumerates the Bootstrap Processor, after Smp::Initialize()
+void Topology::Initialize()
+{
+    /*
+        APIC IDs are built from bit fields: the thread within its
+        core, the core within its package, then the package. CPUID
+        leaf 0x1F (or 0x0B) reports the width of each field and
+        the full x2APIC ID, the deterministic cache leaves report
+        how many IDs share each cache. Processors sharing an LLC
+        differ only in the bits below its shift.
+
+        Every processor enumerates itself, once online, and links
+        into the sibling masks of those already known. The masks
+        nest (SMT within LLC within PACKAGE), they're the domains
+        the scheduler balances in, nearest first.
+
+        Refer:
+        Intel SDM Vol. 3A, Section 9.9 (Identifying Topological Relationships in a MP System)
+        https://www.kernel.org/doc/html/latest/x86/topology.html
+    */
+
+    InitializeCpu(KERNEL_SMP_BOOTCPU);
+}
+
+/// @brief Places the Executing Processor in the Topology, Called by each Processor
+/// @param Cpu Logical CPU Index of the Executing Processor
+void Topology::InitializeCpu(u32 Cpu)
+{
+    u32 X2ApicId = Enumerate();
+    CpuTopology* Self = &Cpus[Cpu];
+
+    u64 Flags = Lock.LockIrqSave();
+    Self->X2ApicId = X2ApicId;
+    Self->Thread = X2ApicId & ((1U << SmtShift) - 1);
+    Self->Core = (X2ApicId & ((1U << PackageShift) - 1)) >> SmtShift;
+    Self->Package = X2ApicId >> PackageShift;
+    Self->LlcId = X2ApicId >> LlcShift;
+    Self->Known = true;
+
+    for (u32 Other = 0; Other < Smp::CpuCount; Other++) {
+        if (!Cpus[Other].Known)
+            continue;
+
+        CpuTopology* Peer = &Cpus[Other];
+        Level Nearest = SYSTEM;
+        if (Peer->Package == Self->Package)
+            Nearest = PACKAGE;
+        if (Peer->Package == Self->Package && Peer->LlcId == Self->LlcId)
+            Nearest = LLC;
+        if (Peer->Package == Self->Package && Peer->Core == Self->Core)
+            Nearest = SMT;
+
+        for (u32 Domain = Nearest; Domain < LEVELS; Domain++) {
+            Self->Siblings[Domain][Other / 64] |= (1ULL << (Other % 64));
+            Peer->Siblings[Domain][Cpu / 64] |= (1ULL << (Cpu % 64));
+        }
+    }
+
+    Lock.UnlockIrqRestore(Flags);
+}
+
+/// @brief Returns the Nearest Level two Processors Share
+Topology::Level Topology::Distance(u32 Cpu, u32 Other)
+{
+    for (u32 Domain = SMT; Domain < SYSTEM; Domain++) {
+        if (Shares(Cpu, Other, (Level)Domain))
+            return (Level)Domain;
+    }
+
+    return SYSTEM;
+}
+
+/// @brief Prints the Topology Tree with the ACPI Processor UIDs
+void Topology::Dump()
+{
+    printf("Processor Topology (SMT/LLC/Package Shift): ");
+    printf(SmtShift);
+    printf("/");
+    printf(LlcShift);
+    printf("/");
+    printf(PackageShift);
+    printf("\n");
+
+    for (u32 Cpu = 0; Cpu < Smp::CpuCount; Cpu++) {
+        if (!Cpus[Cpu].Known)
+            continue;
+
+        printf("  CPU ");
+        printf(Cpu);
+        printf(" (ACPI UID ");
+        printf(Smp::Cpus[Cpu].AcpiId);
+        printf("): Package ");
+        printf(Cpus[Cpu].Package);
+        printf(", Core ");
+        printf(Cpus[Cpu].Core);
+        printf(", Thread ");
+        printf(Cpus[Cpu].Thread);
+        printf(", LLC ");
+        printf(Cpus[Cpu].LlcId);
+        printf("\n");
+    }
+}
+
+/// @brief Reads the APIC ID Field Widths of the Executing Processor
+/// @return x2APIC ID (or Initial APIC ID) of the Executing Processor
+u32 Topology::Enumerate()
+{
+    u32 Eax, Ebx, Ecx, Edx;
+    u32 MaxLeaf = Cpu::CpuidMaxLeaf(0);
+    u32 Leaf = (MaxLeaf >= 0x1F) ? 0x1F : 0x0B;
+
+    /* Leaf 0x1F is Reserved (Zero) on Processors that only Report 0x0B */
+    if (Leaf == 0x1F) {
+        Cpu::Cpuid(0x1F, 0, &Eax, &Ebx, &Ecx, &Edx);
+        if (!(Ebx & 0xFFFF))
+            Leaf = 0x0B;
+    }
+
+    u32 Smt = 0, Package = 0, X2ApicId = 0;
+    bool Extended = false;
+
+    if (MaxLeaf >= 0x0B) {
+        for (u32 SubLeaf = 0;; SubLeaf++) {
+            Cpu::Cpuid(Leaf, SubLeaf, &Eax, &Ebx, &Ecx, &Edx);
+            u32 Type = (Ecx >> 8) & 0xFF;
+            if (Type == KERNEL_TOPOLOGY_LEVEL_INVALID || !(Ebx & 0xFFFF))
+                break;
+
+            /* Module, Tile and Die Levels are folded into the Core Field */
+            if (Type == KERNEL_TOPOLOGY_LEVEL_SMT)
+                Smt = Eax & 0x1F;
+
+            Package = Eax & 0x1F;
+            X2ApicId = Edx;
+            Extended = true;
+        }
+    }
+
+    if (!Extended) {
+        /* Leaf 1 Counts Logical Processors per Package, Leaf 4 the Cores */
+        Cpu::Cpuid(1, 0, &Eax, &Ebx, &Ecx, &Edx);
+        X2ApicId = Ebx >> 24;
+        Package = (Edx & (1 << 28)) ? BitsFor((Ebx >> 16) & 0xFF) : 0;
+
+        u32 Cores = 1;
+        if (MaxLeaf >= 4) {
+            Cpu::Cpuid(4, 0, &Eax, &Ebx, &Ecx, &Edx);
+            if (Eax & 0x1F)
+                Cores = (Eax >> 26) + 1;
+        }
+
+        u32 CoreBits = BitsFor(Cores);
+        Smt = (Package > CoreBits) ? Package - CoreBits : 0;
+    }
+
+    /* Every Processor reports the same Widths, the Last Writer Wins */
+    u32 Llc = EnumerateLlc();
+    if (Llc == KERNEL_TOPOLOGY_NOLLC || Llc > Package)
+        Llc = Package;
+
+    __atomic_store_n(&SmtShift, Smt, __ATOMIC_RELAXED);
+    __atomic_store_n(&PackageShift, Package, __ATOMIC_RELAXED);
+    __atomic_store_n(&LlcShift, (Llc < Smt) ? Smt : Llc, __ATOMIC_RELAXED);
+    return X2ApicId;
+}
+
+/// @brief Reads the APIC ID Bits below the Last Level Cache
+/// @return Shift, KERNEL_TOPOLOGY_NOLLC if Caches aren't Enumerated
+u32 Topology::EnumerateLlc()
+{
+    /*
+        Intel reports caches in leaf 4, AMD the same format in leaf
+        0x8000001D (leaf 4 reads zero there). EAX[7:5] is the cache
+        level, EAX[25:14] the number of IDs sharing it, minus one.
+    */
+
+    u32 Leaf = 4;
+    if (Cpu::CpuidMaxLeaf(0) < 4)
+        Leaf = 0x8000001D;
+
+    u32 Eax, Ebx, Ecx, Edx;
+    Cpu::Cpuid(Leaf, 0, &Eax, &Ebx, &Ecx, &Edx);
+    if (!(Eax & 0x1F))
+        Leaf = 0x8000001D;
+
+    if (Leaf == 0x8000001D && Cpu::CpuidMaxLeaf(0x80000000) < 0x8000001D)
+        return KERNEL_TOPOLOGY_NOLLC;
+
+    u32 Highest = 0, Sharing = 0;
+    for (u32 SubLeaf = 0; SubLeaf < 8; SubLeaf++) {
+        Cpu::Cpuid(Leaf, SubLeaf, &Eax, &Ebx, &Ecx, &Edx);
+        if (!(Eax & 0x1F))
+            break;
+
+        u32 CacheLevel = (Eax >> 5) & 0x7;
+        if (CacheLevel >= Highest) {
+            Highest = CacheLevel;
+            Sharing = ((Eax >> 14) & 0xFFF) + 1;
+        }
+    }
+
+    return (Highest) ? BitsFor(Sharing) : KERNEL_TOPOLOGY_NOLLC;
+}
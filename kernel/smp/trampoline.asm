@@ -0,0 +1,162 @@
+;   tacOS
+;   Copyright (C) 2024  Atheesh Thirumalairajan
+;
+;   This program is free software: you can redistribute it and/or modify
+;   it under the terms of the GNU General Public License as published by
+;   the Free Software Foundation, either version 3 of the License, or
+;   (at your option) any later version.
+;
+;   This program is distributed in the hope that it will be useful,
+;   but WITHOUT ANY WARRANTY; without even the implied warranty of
+;   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;   GNU General Public License for more details.
+;
+;   You should have received a copy of the GNU General Public License
+;   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+
+; This Assembly File contains:
+; The Application Processor (AP) Startup Trampoline.
+;
+; An AP leaves its Startup IPI in 16-bit real mode, at CS:IP =
+; (Vector << 8):0000. Smp::StartApplicationProcessors() copies
+; this code to a page below 1MB, so nothing here may use an
+; absolute address. The load base is read from CS, and every
+; linear address is rebased into TrampolineParams by the BSP.
+;
+; Refer:
+; https://wiki.osdev.org/SMP
+; https://wiki.osdev.org/Setting_Up_Long_Mode
+; Intel SDM Vol. 3A, Section 9.8.5 (Initializing IA-32e Mode)
+
+global TrampolineStart
+global TrampolineParams
+global TrampolineEnd
+
+%define TRAMPOLINE_OFFSET(Label) ((Label) - TrampolineStart)
+%define TRAMPOLINE_CODE32 0x08
+%define TRAMPOLINE_DATA32 0x10
+%define TRAMPOLINE_CODE64 0x18
+
+section .text
+bits 16
+TrampolineStart:
+    cli
+    cld
+
+    ; EBX holds the Load Base through every mode switch
+    xor ebx, ebx
+    mov bx, cs
+    mov ds, bx
+    shl ebx, 4
+
+    ; Enter Protected Mode with the Trampoline's own GDT
+    o32 lgdt [TRAMPOLINE_OFFSET(TrampolineGdtr)]
+    mov eax, cr0
+    or eax, 1
+    mov cr0, eax
+    o32 jmp far [TRAMPOLINE_OFFSET(TrampolineProtectedPtr)]
+
+bits 32
+TrampolineProtected:
+    mov ax, TRAMPOLINE_DATA32
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+
+    ; Enable PAE, use the Kernel's PML4 (Allocated below 4GB)
+    mov eax, cr4
+    or eax, (1 << 5)
+    mov cr4, eax
+    mov eax, [ebx + TRAMPOLINE_OFFSET(TrampolineCr3)]
+    mov cr3, eax
+
+    ; Set EFER.LME
+    mov ecx, 0xC0000080
+    rdmsr
+    or eax, (1 << 8)
+    wrmsr
+
+    ; Enabling Paging activates Long Mode (Compatibility Mode first)
+    mov eax, cr0
+    or eax, (1 << 31)
+    mov cr0, eax
+    jmp far [ebx + TRAMPOLINE_OFFSET(TrampolineLongPtr)]
+
+bits 64
+TrampolineLong:
+    ; Upper Halves are Undefined after Compatibility Mode
+    mov ebx, ebx
+
+    xor eax, eax
+    mov ds, ax
+    mov es, ax
+    mov ss, ax
+    mov fs, ax
+    mov gs, ax
+
+    ; Enable SSE and Extended State as osloader.asm did on the BSP
+    mov rax, cr0
+    and rax, ~(1 << 2)
+    or rax, (1 << 1) | (1 << 5)
+    mov cr0, rax
+    mov rax, cr4
+    or rax, (1 << 9) | (1 << 10)
+    mov cr4, rax
+
+    ; XCR0 is copied from the BSP, 0 if XSAVE is Unsupported
+    mov rax, [rbx + TRAMPOLINE_OFFSET(TrampolineXcr0)]
+    test rax, rax
+    jz .NoXsave
+    mov rcx, cr4
+    or rcx, (1 << 18)
+    mov cr4, rcx
+    xor ecx, ecx
+    xor edx, edx
+    xsetbv
+
+.NoXsave:
+    fninit
+
+    ; Jump into the Kernel, Smp::ApplicationProcessorMain(Cpu)
+    mov rsp, [rbx + TRAMPOLINE_OFFSET(TrampolineStack)]
+    mov rdi, [rbx + TRAMPOLINE_OFFSET(TrampolineCpu)]
+    mov rax, [rbx + TRAMPOLINE_OFFSET(TrampolineEntry)]
+    call rax
+
+.Halt:
+    cli
+    hlt
+    jmp .Halt
+
+align 8
+TrampolineGdt:
+    dq 0
+    dq 0x00CF9A000000FFFF ; 32-bit Code, 4GB Flat
+    dq 0x00CF92000000FFFF ; 32-bit Data, 4GB Flat
+    dq 0x00209A0000000000 ; 64-bit Code
+TrampolineGdtEnd:
+
+; Layout matches TrampolineParameters in smp.cpp
+TrampolineParams:
+TrampolineGdtr:
+    dw TrampolineGdtEnd - TrampolineGdt - 1
+    dd TRAMPOLINE_OFFSET(TrampolineGdt)
+TrampolineProtectedPtr:
+    dd TRAMPOLINE_OFFSET(TrampolineProtected)
+    dw TRAMPOLINE_CODE32
+TrampolineLongPtr:
+    dd TRAMPOLINE_OFFSET(TrampolineLong)
+    dw TRAMPOLINE_CODE64
+TrampolineCr3:
+    dq 0
+TrampolineStack:
+    dq 0
+TrampolineEntry:
+    dq 0
+TrampolineCpu:
+    dq 0
+TrampolineXcr0:
+    dq 0
+TrampolineEnd:
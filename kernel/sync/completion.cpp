@@ -0,0 +1,131 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/assert/logging.hpp>
+#include <kernel/sync/completion.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+
+#ifdef KERNEL_SYNC_SELFTEST
+/* Define Statics */
+static Completion PingDone;
+static Completion PongDone;
+#endif
+
+/// @brief Signals one Waiter, or the next Wait(). Callable from Interrupts
+void Completion::Complete()
+{
+    /*
+        Everything is done under the wait queue lock, and a waiter
+        only returns after taking that lock in TryWait(). Once this
+        releases it the completion isn't touched again, so it may
+        live on the waiter's stack.
+    */
+
+    u64 Flags = Waiters.Lock.LockIrqSave();
+    if (Done != KERNEL_COMPLETION_ALL)
+        Done++;
+
+    Waiters.WakeOneLocked();
+    Waiters.Lock.UnlockIrqRestore(Flags);
+}
+
+/// @brief Signals every Waiter, and every Wait() till Reinitialize()
+void Completion::CompleteAll()
+{
+    u64 Flags = Waiters.Lock.LockIrqSave();
+    Done = KERNEL_COMPLETION_ALL;
+    Waiters.WakeAllLocked();
+    Waiters.Lock.UnlockIrqRestore(Flags);
+}
+
+/// @brief Sleeps till Signalled, Consuming the Signal. Not in Interrupts
+void Completion::Wait()
+{
+    if (TryWait())
+        return;
+
+    /* Boot and Idle Contexts can't Sleep */
+    if (!Scheduler::CanBlock()) {
+        while (!TryWait())
+            Cpu::Pause();
+
+        return;
+    }
+
+    Waiters.Wait([this] { return TryWait(); });
+}
+
+/// @brief Consumes a Signal only if one is Pending
+/// @return True if Signalled, False otherwise
+bool Completion::TryWait()
+{
+    u64 Flags = Waiters.Lock.LockIrqSave();
+    bool Signalled = Done != 0;
+    if (Signalled && Done != KERNEL_COMPLETION_ALL)
+        Done--;
+
+    Waiters.Lock.UnlockIrqRestore(Flags);
+    return Signalled;
+}
+
+/// @brief Clears Pending Signals, to be Reused. No Thread may be Waiting
+void Completion::Reinitialize()
+{
+    __atomic_store_n(&Done, 0, __ATOMIC_RELEASE);
+}
+
+#ifdef KERNEL_SYNC_SELFTEST
+/// @brief Ping-Pongs a Completion between two Threads, Called once the Scheduler is Up
+void Completion::SelfTest()
+{
+    /*
+        Each round trip makes both threads wait, with the tick
+        running. A thread preempted between PrepareToWait() and
+        Block() must stay runnable, else its partner's signal is
+        lost and the test never reports. Both run on any processor,
+        so the waits race wakeups both locally and across CPUs.
+    */
+
+    if (!Scheduler::CreateThread("selftest/ping", TestPing, 0)
+        || !Scheduler::CreateThread("selftest/pong", TestPong, 0))
+        Logging::LogMessage(Logging::LogLevel::ERROR, "Completion Self-Test Thread Creation Failed");
+}
+
+/// @brief Signals the Partner, then Waits for its Reply
+void Completion::TestPing(void* Context)
+{
+    for (u32 Round = 0; Round < KERNEL_COMPLETION_TESTROUNDS; Round++) {
+        PingDone.Complete();
+        PongDone.Wait();
+    }
+
+    Logging::LogMessage(Logging::LogLevel::INFO, "Completion Self-Test Passed");
+}
+
+/// @brief Waits for the Partner, then Replies
+void Completion::TestPong(void* Context)
+{
+    for (u32 Round = 0; Round < KERNEL_COMPLETION_TESTROUNDS; Round++) {
+        PingDone.Wait();
+        PongDone.Complete();
+    }
+}
+#endif
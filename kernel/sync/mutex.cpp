@@ -0,0 +1,120 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/sync/mutex.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools::KernelRTL;
+
+/// @brief Contended Acquisition, Spins or Sleeps till the Owner Releases
+void Mutex::LockSlow()
+{
+    /*
+        An owner running on another processor likely releases the
+        mutex within a few microseconds, far less than a sleep and
+        wakeup cost. The waiter then spins, but only while the owner
+        is still the thread running on the processor it locked on:
+        once the owner blocks or is preempted, spinning would just
+        burn the processor, so the waiter sleeps on the wait queue.
+
+        A sleeping waiter sets KERNEL_MUTEX_WAITERS in the owner
+        word, which sends Unlock() down the slow path to wake it.
+        The uncontended Lock() and Unlock() stay one compare-exchange
+        each. Ownership isn't handed over: a woken waiter competes
+        again, so a running thread may take the mutex first.
+
+        Refer:
+        https://www.kernel.org/doc/html/latest/locking/mutex-design.html
+        https://lwn.net/Articles/590243/ (Optimistic Spinning)
+    */
+
+    /* Boot and Idle Contexts can't Sleep, and rarely Contend */
+    if (!Scheduler::CanBlock()) {
+        while (!TryLock())
+            Cpu::Pause();
+
+        return;
+    }
+
+    WaitQueue::Entry Wait = {};
+    for (;;) {
+        if (TryLock())
+            break;
+
+        if (SpinOnOwner())
+            continue;
+
+        /* Queued before Flagging, an Unlock() that Sees the Flag Finds the Entry */
+        Waiters.PrepareToWait(&Wait);
+
+        u64 Word = __atomic_load_n(&Owner, __ATOMIC_RELAXED);
+        while (Word && !(Word & KERNEL_MUTEX_WAITERS)) {
+            if (__atomic_compare_exchange_n(&Owner, &Word, Word | KERNEL_MUTEX_WAITERS, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+
+        /* Released Meanwhile, Retry without Sleeping */
+        if (Word)
+            Scheduler::Block();
+
+        Waiters.FinishWait(&Wait);
+    }
+
+    /* The Unlock() that Woke us Cleared the Flag, the Rest still need it */
+    if (!Waiters.IsEmpty())
+        __atomic_fetch_or(&Owner, KERNEL_MUTEX_WAITERS, __ATOMIC_RELAXED);
+}
+
+/// @brief Releases a Mutex with Sleeping Waiters
+void Mutex::UnlockSlow()
+{
+    __atomic_store_n(&Owner, 0, __ATOMIC_RELEASE);
+    Waiters.WakeOne();
+}
+
+/// @brief Spins while the Owner is Running
+/// @return True once the Owner Changed, False if the Caller should Sleep instead
+bool Mutex::SpinOnOwner()
+{
+    /*
+        The owner's thread isn't dereferenced, it may exit once it
+        released the mutex. Comparing it against the current thread
+        of its processor is enough: a thread still owning the mutex
+        hasn't exited, and one that isn't Current there is either
+        blocked, preempted or migrated.
+    */
+
+    bool Changed = true;
+    Scheduler::PreemptDisable();
+
+    Scheduler::Thread* Holder = GetOwner();
+    while (Holder && GetOwner() == Holder) {
+        Scheduler::RunQueue* Rq = &Scheduler::RunQueues[OwnerCpu];
+        if (__atomic_load_n(&Rq->Current, __ATOMIC_RELAXED) != Holder || Scheduler::NeedsResched()) {
+            Changed = false;
+            break;
+        }
+
+        Cpu::Pause();
+    }
+
+    Scheduler::PreemptEnable();
+    return Changed;
+}
@@ -0,0 +1,338 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/interrupts/intrdef.hpp>
+#include <kernel/interrupts/softirq.hpp>
+#include <kernel/sync/completion.hpp>
+#include <kernel/sync/rcu.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+static LockClass RcuLockClass = { "rcu" };
+Rcu::CpuData Rcu::Cpus[KERNEL_SMP_MAXCPUS];
+TicketLock Rcu::Lock(&RcuLockClass);
+volatile u64 Rcu::GpNumber;
+volatile u64 Rcu::Completed;
+u64 Rcu::Requested;
+u64 Rcu::OnlineMask[KERNEL_RCU_MASKWORDS];
+u64 Rcu::PendingMask[KERNEL_RCU_MASKWORDS];
+
+/// @brief Wait of a Synchronize() Caller, on its Stack
+struct SyncRequest {
+    Rcu::Head Hd; /* First, the Head is Cast back to the Request */
+    Completion Done;
+};
+
+/// @brief Completes a Synchronize(), from the RCU SoftIrq
+static void SyncComplete(Rcu::Head* Hd)
+{
+    ((SyncRequest*)Hd)->Done.Complete();
+}
+
+/// @brief Sets up Grace Period Tracking, the Bootstrap Processor Joins
+void Rcu::Initialize()
+{
+    /*
+        Readers of an RCU protected structure take no locks. An
+        updater publishes a new version with Assign(), and frees
+        the old one only after a grace period, once every processor
+        has passed a quiescent state: a point where it can't be
+        inside a read-side critical section.
+
+        Quiescent states are context switches, idle entry and
+        ticks that interrupted neither a reader (preemption enabled)
+        nor another interrupt. Each processor notices a new grace
+        period on its tick and reports once it passed one after.
+        Idle processors (tick stopped) are skipped entirely, an
+        interrupt that wakes one makes it count again (IrqEnter).
+
+        Callbacks wait in three segments per processor: registered,
+        waiting for a grace period, and done. Done callbacks run in
+        the RCU SoftIrq. The tick isn't stopped on an idle processor
+        with callbacks, they'd never be advanced.
+
+        Refer:
+        https://www.kernel.org/doc/html/latest/RCU/whatisRCU.html
+        https://lwn.net/Articles/253651/ (What is RCU, Fundamentally?)
+        https://www.rdrop.com/users/paulmck/RCU/rclockpdcsproof.pdf (Classic RCU)
+    */
+
+    SoftIrq::RegisterAction(SoftIrq::Type::RCU, InvokeCallbacks);
+    InitializeCpu(KERNEL_SMP_BOOTCPU);
+}
+
+/// @brief Makes a Processor Take Part in Grace Periods
+/// @param Cpu Logical CPU Index
+void Rcu::InitializeCpu(u32 Cpu)
+{
+    CpuData* Data = &Cpus[Cpu];
+    Data->NextTail = &Data->Next;
+    Data->WaitingTail = &Data->Waiting;
+    Data->DoneTail = &Data->Done;
+
+    /* A Grace Period in Progress doesn't wait for it, its Readers Started Later */
+    u64 Flags = Lock.LockIrqSave();
+    Data->NoticedGp = GpNumber;
+    OnlineMask[Cpu / 64] |= (1ULL << (Cpu % 64));
+    Lock.UnlockIrqRestore(Flags);
+}
+
+/// @brief Registers a Callback to run after a Grace Period
+/// @param Hd Head Embedded in the Object
+/// @param Routine Invoked in SoftIrq Context, once Pre-Existing Readers are Done
+void Rcu::Call(Head* Hd, void (*Routine)(Head* Hd))
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    CpuData* Data = &Cpus[Smp::CurrentCpu()];
+
+    Hd->Next = 0;
+    Hd->Routine = Routine;
+    *Data->NextTail = Hd;
+    Data->NextTail = &Hd->Next;
+
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Waits for a Grace Period, Not in Interrupts or with IF Clear
+void Rcu::Synchronize()
+{
+    /*
+        Threads block till the callback wakes them. Contexts that
+        can't block (Boot, Idle) poll, reporting their own
+        quiescent state, as the caller can't be a reader.
+    */
+
+    SyncRequest Request;
+    Call(&Request.Hd, SyncComplete);
+
+    if (Scheduler::CanBlock()) {
+        Request.Done.Wait();
+        return;
+    }
+
+    while (!Request.Done.TryWait()) {
+        QuiescentState();
+        if (SoftIrq::IsPending())
+            SoftIrq::Run();
+
+        Cpu::Pause();
+    }
+}
+
+/// @brief Reports a Quiescent State of the Executing Processor
+void Rcu::QuiescentState()
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    Process(Smp::CurrentCpu(), true);
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Notes a Context Switch, Called by the Scheduler with IF Clear
+/// @param Cpu Logical CPU Index of the Executing Processor
+void Rcu::NoteContextSwitch(u32 Cpu)
+{
+    /* Reported on the Next Tick, a Plain Store is all the Switch Pays */
+    Cpus[Cpu].Quiescent = true;
+}
+
+/// @brief Tick Processing, Called from the Tick Interrupt
+/// @param Cpu Logical CPU Index of the Executing Processor
+void Rcu::Tick(u32 Cpu)
+{
+    /*
+        A tick nested in another interrupt may have interrupted a
+        reader in that handler. Otherwise, the interrupted context
+        is quiescent if it couldn't have been reading: preemption
+        was enabled, or without preemption, it was the idle loop.
+    */
+
+    bool Outermost = (PerCpu::Read(Interrupt::NestingDepth) == 1);
+
+#ifndef KERNEL_SCHED_NOPREEMPT
+    Process(Cpu, Outermost && !Scheduler::PreemptDisabled());
+#else
+    Process(Cpu, Outermost && Cpus[Cpu].IdleLoop);
+#endif
+}
+
+/// @brief Enters an Extended Quiescent State, Called by the Idle Loop with IF Clear
+void Rcu::EnterIdle()
+{
+    u32 Self = Smp::CurrentCpu();
+    CpuData* Data = &Cpus[Self];
+
+    Data->IdleLoop = true;
+    Process(Self, true);
+
+    /*
+        Grace periods that start from now on skip this processor.
+        One that started before it was marked is reported here,
+        StartGracePeriod() bumps GpNumber before reading Extended.
+    */
+
+    __atomic_store_n(&Data->Extended, true, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&GpNumber, __ATOMIC_SEQ_CST) != Data->NoticedGp)
+        Process(Self, true);
+}
+
+/// @brief Leaves the Extended Quiescent State, Called by the Idle Loop with IF Clear
+void Rcu::ExitIdle()
+{
+    CpuData* Data = &Cpus[Smp::CurrentCpu()];
+    Data->IdleLoop = false;
+    __atomic_store_n(&Data->Extended, false, __ATOMIC_SEQ_CST);
+}
+
+/// @brief Makes an Idle Processor Count again, Called on Outermost Interrupt Entry
+void Rcu::IrqEnter()
+{
+    /* Handlers are Readers, a Plain Load unless Woken from Idle */
+    CpuData* Data = &Cpus[Smp::CurrentCpu()];
+    if (Data->Extended)
+        __atomic_store_n(&Data->Extended, false, __ATOMIC_SEQ_CST);
+}
+
+/// @brief Checks if a Processor has Callbacks, and needs its Tick
+/// @param Cpu Logical CPU Index
+bool Rcu::NeedsCpu(u32 Cpu)
+{
+    return Cpus[Cpu].Next || Cpus[Cpu].Waiting || Cpus[Cpu].Done;
+}
+
+/// @brief Reports Quiescent States and Advances Callbacks, IF Clear
+/// @param Cpu Logical CPU Index of the Executing Processor
+/// @param Quiescent The Processor is in a Quiescent State right now
+void Rcu::Process(u32 Cpu, bool Quiescent)
+{
+    CpuData* Data = &Cpus[Cpu];
+    u64 Bit = 1ULL << (Cpu % 64);
+
+    /* A Quiescent State only counts for Grace Periods that Started before it */
+    u64 Gp = __atomic_load_n(&GpNumber, __ATOMIC_ACQUIRE);
+    if (Data->NoticedGp != Gp) {
+        Data->NoticedGp = Gp;
+        Data->Quiescent = false;
+    }
+
+    if (Quiescent)
+        Data->Quiescent = true;
+
+    if (Data->Quiescent && (__atomic_load_n(&PendingMask[Cpu / 64], __ATOMIC_RELAXED) & Bit)) {
+        Lock.Lock();
+        if (GpNumber == Data->NoticedGp && (PendingMask[Cpu / 64] & Bit)) {
+            PendingMask[Cpu / 64] &= ~Bit;
+
+            bool Remaining = false;
+            for (u32 Word = 0; Word < KERNEL_RCU_MASKWORDS; Word++)
+                Remaining |= (PendingMask[Word] != 0);
+
+            if (!Remaining) {
+                __atomic_store_n(&Completed, GpNumber, __ATOMIC_RELEASE);
+                StartGracePeriod();
+            }
+        }
+
+        Lock.Unlock();
+    }
+
+    /* Grace Periods Complete in Order, WaitingGp done means its Callbacks are Safe */
+    if (Data->Waiting && __atomic_load_n(&Completed, __ATOMIC_ACQUIRE) >= Data->WaitingGp) {
+        *Data->DoneTail = Data->Waiting;
+        Data->DoneTail = Data->WaitingTail;
+        Data->Waiting = 0;
+        Data->WaitingTail = &Data->Waiting;
+    }
+
+    if (!Data->Waiting && Data->Next) {
+        Data->Waiting = Data->Next;
+        Data->WaitingTail = Data->NextTail;
+        Data->Next = 0;
+        Data->NextTail = &Data->Next;
+        Data->WaitingGp = RequestGracePeriod();
+    }
+
+    if (Data->Done)
+        SoftIrq::Raise(SoftIrq::Type::RCU);
+}
+
+/// @brief Asks for a Grace Period that Starts after Now
+/// @return Number of that Grace Period
+u64 Rcu::RequestGracePeriod()
+{
+    Lock.Lock();
+
+    /* One in Progress may have Started before the Callbacks were Registered */
+    u64 Needed = GpNumber + 1;
+    if (Needed > Requested)
+        Requested = Needed;
+
+    if (Completed == GpNumber)
+        StartGracePeriod();
+
+    Lock.Unlock();
+    return Needed;
+}
+
+/// @brief Starts the Next Requested Grace Period, Called with the Lock Held
+void Rcu::StartGracePeriod()
+{
+    while (Requested > GpNumber) {
+        __atomic_store_n(&GpNumber, GpNumber + 1, __ATOMIC_SEQ_CST);
+
+        /* Idle Processors are Quiescent already, they're not Waited for */
+        bool Waiting = false;
+        for (u32 Word = 0; Word < KERNEL_RCU_MASKWORDS; Word++) {
+            u64 Mask = OnlineMask[Word];
+            for (u64 Online = Mask; Online; Online &= Online - 1) {
+                u32 Cpu = (Word * 64) + __builtin_ctzll(Online);
+                if (__atomic_load_n(&Cpus[Cpu].Extended, __ATOMIC_SEQ_CST))
+                    Mask &= ~(1ULL << (Cpu % 64));
+            }
+
+            PendingMask[Word] = Mask;
+            Waiting |= (Mask != 0);
+        }
+
+        if (Waiting)
+            return;
+
+        __atomic_store_n(&Completed, GpNumber, __ATOMIC_RELEASE);
+    }
+}
+
+/// @brief Runs the Done Callbacks of the Executing Processor (RCU SoftIrq)
+void Rcu::InvokeCallbacks()
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    CpuData* Data = &Cpus[Smp::CurrentCpu()];
+    Head* List = Data->Done;
+    Data->Done = 0;
+    Data->DoneTail = &Data->Done;
+    Cpu::RestoreFlags(Flags);
+
+    while (List) {
+        Head* Next = List->Next;
+        List->Routine(List);
+        Data->Invoked++;
+        List = Next;
+    }
+}
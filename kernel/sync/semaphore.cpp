@@ -0,0 +1,54 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/sync/semaphore.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+
+/// @brief Takes a Unit, Sleeping till one is Available. Not in Interrupts
+void Semaphore::Down()
+{
+    if (TryDown())
+        return;
+
+    /* Boot and Idle Contexts can't Sleep */
+    if (!Scheduler::CanBlock()) {
+        while (!TryDown())
+            Cpu::Pause();
+
+        return;
+    }
+
+    Waiters.Wait([this] { return TryDown(); });
+}
+
+/// @brief Returns a Unit, Waking a Waiter. Callable from Interrupts
+void Semaphore::Up()
+{
+    /*
+        The count is raised before the queue is checked, a waiter
+        queues itself before checking the count. Both are ordered
+        by a full barrier, so one of them sees the other.
+    */
+
+    __atomic_fetch_add(&Count, 1, __ATOMIC_SEQ_CST);
+    if (!Waiters.IsEmpty())
+        Waiters.WakeOne();
+}
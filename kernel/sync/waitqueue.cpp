@@ -0,0 +1,170 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <kernel/sync/waitqueue.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools::KernelRTL;
+
+/// @brief Queues the Current Thread and Marks it about to Block
+/// @param Wait Entry on the Caller's Stack, Reused across PrepareToWait() Calls
+/// @param Exclusive Woken alone by WakeOne(), else by every Wakeup
+void WaitQueue::PrepareToWait(Entry* Wait, bool Exclusive)
+{
+    /*
+        The waiter queues itself and sets its state to BLOCKED
+        before testing its condition. A waker changes the condition
+        first and then wakes the queue, so either the waiter sees
+        the change, or it's queued by then and is woken: Block()
+        returns at once for a thread Woken after PrepareToBlock().
+
+        Exclusive waiters (lock and semaphore waits) are woken one
+        per WakeOne(), so a release doesn't wake every sleeper only
+        for all but one to sleep again. Waking unlinks the entry, a
+        second WakeOne() goes to the next waiter.
+
+        Refer:
+        https://lwn.net/Articles/577370/ (Wait Queue Tutorial)
+        https://www.kernel.org/doc/html/latest/kernel-hacking/hacking.html#wait-queues-include-linux-wait-h
+    */
+
+    u64 Flags = Lock.LockIrqSave();
+
+    if (!Wait->Queued) {
+        Wait->Thd = Scheduler::CurrentThread();
+        Wait->Exclusive = Exclusive;
+        Add(Wait);
+    }
+
+    Scheduler::PrepareToBlock();
+    Lock.UnlockIrqRestore(Flags);
+}
+
+/// @brief Leaves the Queue once the Wait is Over
+/// @param Wait Entry passed to PrepareToWait()
+void WaitQueue::FinishWait(Entry* Wait)
+{
+    Scheduler::CancelBlock();
+
+    /* A Waker Unlinked it already, the Entry is no longer Touched */
+    if (!__atomic_load_n(&Wait->Queued, __ATOMIC_ACQUIRE))
+        return;
+
+    u64 Flags = Lock.LockIrqSave();
+    if (Wait->Queued)
+        Remove(Wait);
+
+    Lock.UnlockIrqRestore(Flags);
+}
+
+/// @brief Wakes the First Exclusive Waiter, and the Non-Exclusive ones before it
+/// @return True if an Exclusive Waiter was Woken
+bool WaitQueue::WakeOne()
+{
+    u64 Flags = Lock.LockIrqSave();
+    bool Woken = WakeOneLocked();
+    Lock.UnlockIrqRestore(Flags);
+    return Woken;
+}
+
+/// @brief Wakes every Waiter
+/// @return Number of Threads Woken
+u32 WaitQueue::WakeAll()
+{
+    u64 Flags = Lock.LockIrqSave();
+    u32 Woken = WakeAllLocked();
+    Lock.UnlockIrqRestore(Flags);
+    return Woken;
+}
+
+/// @brief WakeOne(), with the Lock Held
+bool WaitQueue::WakeOneLocked()
+{
+    return WakeLocked(false) != 0;
+}
+
+/// @brief WakeAll(), with the Lock Held
+u32 WaitQueue::WakeAllLocked()
+{
+    return WakeLocked(true);
+}
+
+/// @brief Links a Waiter at the Tail, Lock Held
+void WaitQueue::Add(Entry* Wait)
+{
+    Wait->Next = 0;
+    Wait->Prev = Tail;
+
+    if (Tail)
+        Tail->Next = Wait;
+    else
+        __atomic_store_n(&Head, Wait, __ATOMIC_RELEASE);
+
+    Tail = Wait;
+    Wait->Queued = true;
+}
+
+/// @brief Unlinks a Waiter, Lock Held
+void WaitQueue::Remove(Entry* Wait)
+{
+    if (Wait->Prev)
+        Wait->Prev->Next = Wait->Next;
+    else
+        __atomic_store_n(&Head, Wait->Next, __ATOMIC_RELEASE);
+
+    if (Wait->Next)
+        Wait->Next->Prev = Wait->Prev;
+    else
+        Tail = Wait->Prev;
+
+    __atomic_store_n(&Wait->Queued, false, __ATOMIC_RELEASE);
+}
+
+/// @brief Unlinks and Wakes Waiters, Lock Held
+/// @param All Wake every Waiter, else Stop after the First Exclusive one
+/// @return Number of Exclusive Waiters Woken (All Woken, if All)
+u32 WaitQueue::WakeLocked(bool All)
+{
+    u32 Woken = 0;
+    Entry* Wait = Head;
+
+    while (Wait) {
+        Entry* Next = Wait->Next;
+        Scheduler::Thread* Thd = Wait->Thd;
+        bool Exclusive = Wait->Exclusive;
+
+        /*
+            Woken while still Queued, so FinishWait() waits for the
+            Lock and the Thread can't Exit under Wake(). Once Unlinked,
+            the Waiter may Return and Reuse its Stack.
+        */
+
+        Scheduler::Wake(Thd);
+        Remove(Wait);
+
+        if (All || Exclusive)
+            Woken++;
+
+        if (!All && Exclusive)
+            break;
+
+        Wait = Next;
+    }
+
+    return Woken;
+}
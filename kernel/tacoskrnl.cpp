@@ -20,6 +20,17 @@
 #include <kernel/assert/logging.hpp>
 #include <kernel/interrupts/intrdef.hpp>
 #include <kernel/mem/bootmem.hpp>
+#include <kernel/mem/numa.hpp>
+#include <kernel/mem/tlb.hpp>
+#include <kernel/sched/sched.hpp>
+#include <kernel/sched/workqueue.hpp>
+#include <kernel/smp/cpuidle.hpp>
+#include <kernel/smp/isolation.hpp>
+#include <kernel/smp/smp.hpp>
+#include <kernel/smp/smpcall.hpp>
+#include <kernel/smp/topology.hpp>
+#include <kernel/sync/completion.hpp>
+#include <kernel/sync/rcu.hpp>
 #include <kernel/multiboot/mbpvdr.hpp>
 
 using namespace tacOS::Drivers::Acpi;
@@ -39,6 +50,7 @@ extern "C" void LoadKernel(u64 MultibootInfoAddr)
     clear_screen();
 
     /* Perform Early Initialization */
+    Smp::InitializeBootCpu();
     Interrupt::Register(); // FUTURE: IMPROVE ROUTINES, NAMING.
     MBootProvider::Initialize(MultibootInfoAddr); // FUTURE: Returns Status, Use it
 
@@ -62,15 +74,25 @@ extern "C" void LoadKernel(u64 MultibootInfoAddr)
     /* Check if CPU Exceptions and Interrupts Interrupts Work! */
     // int DivByZ = 1/0;
 
+    /* Register Processors from the MADT, Start the Application Processors */
+    Smp::Initialize();
+    Isolation::Initialize();
+    Topology::Initialize();
+    Numa::Initialize();
+    SmpCall::Initialize();
+    Tlb::Initialize();
+    CpuIdle::Initialize();
+    Rcu::Initialize();
+    Scheduler::Initialize();
+    Workqueue::Initialize();
+    Smp::StartApplicationProcessors();
+    Topology::Dump();
+
+#ifdef KERNEL_SYNC_SELFTEST
+    Completion::SelfTest();
+#endif
+
     /* Log Init Complete */
     Logging::LogMessage(Logging::LogLevel::INFO, "tacOS Kernel Init Complete!");
-
-    for (;;) {
-        /*
-            Halt CPU till next Interrupt. This Prevents 100%
-            CPU Utilization and improves efficiency.
-        */
-
-        __asm__ volatile("hlt");
-    }
-}
\ No newline at end of file
+    Smp::Idle();
+}
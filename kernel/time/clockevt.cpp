@@ -0,0 +1,49 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <kernel/time/clockevt.hpp>
+#include <kernel/time/tick.hpp>
+
+using namespace tacOS::Kernel;
+
+/* Define Statics */
+ClockEvent::Device* ClockEvent::Devices[KERNEL_SMP_MAXCPUS];
+
+/// @brief Registers a Timer Event Device of a Processor
+/// @param Dev Device, Cpu must be set
+/// @return True if the Device now drives the Processor's Tick
+bool ClockEvent::Register(Device* Dev)
+{
+    /*
+        Several devices can raise events on a processor (LAPIC
+        timer, HPET comparators, PIT). The best rated one drives
+        the tick. A one-shot capable device is what lets the tick
+        stop on an idle processor.
+    */
+
+    Device* Current = Devices[Dev->Cpu];
+    if (Current && Current->Rating >= Dev->Rating)
+        return false;
+
+    if (Current)
+        Current->Shutdown(Current);
+
+    Devices[Dev->Cpu] = Dev;
+    Tick::InstallDevice(Dev);
+    return true;
+}
@@ -0,0 +1,127 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/time/clocksrc.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::ASM;
+
+/* Define Statics */
+ClockSource::Source* ClockSource::Current;
+volatile u32 ClockSource::Sequence;
+u64 ClockSource::BaseCycles;
+u64 ClockSource::BaseNs;
+
+/// @brief Computes the Conversion Factor of a Source
+/// @param Src Source to Update
+/// @param Frequency Counter Frequency in Hz
+void ClockSource::SetFrequency(Source* Src, u64 Frequency)
+{
+    /*
+        Converting on every read with a division would cost tens
+        of cycles. The division is done once here, into a 32.32
+        fixed-point multiplier. Reads then multiply into 128 bits
+        and shift, which is exact to well below a nanosecond for
+        any counter between a few KHz and tens of GHz.
+    */
+
+    Src->Frequency = Frequency;
+    Src->Mult = (KERNEL_NSEC_PER_SEC << KERNEL_CLOCKSRC_SHIFT) / Frequency;
+
+    /* Accumulate at least twice per Wrap */
+    if (Src->Mask == ~0ULL)
+        Src->MaxIdleNs = ~0ULL;
+    else
+        Src->MaxIdleNs = CyclesToNs(Src, Src->Mask) / 2;
+}
+
+/// @brief Registers a Clock Source, the best Rated one becomes Current
+/// @param Src Source with Frequency Set
+/// @return True if the Source is now Current
+bool ClockSource::Register(Source* Src)
+{
+    if (Current && Current->Rating >= Src->Rating)
+        return false;
+
+    /* Continue from the Current Time, so the Clock stays Monotonic */
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    u64 Ns = Now();
+
+    Sequence++;
+    __asm__ volatile("" ::: "memory");
+    Current = Src;
+    BaseCycles = Src->Read(Src);
+    BaseNs = Ns;
+    __asm__ volatile("" ::: "memory");
+    Sequence++;
+
+    Cpu::RestoreFlags(Flags);
+    return true;
+}
+
+/// @brief Returns the Monotonic System Clock in Nanoseconds
+u64 ClockSource::Now()
+{
+    /*
+        Readers never block. The base pair is published under a
+        sequence count (odd while being updated), and a reader that
+        observes a change simply retries. x86 does not reorder
+        loads with other loads, so compiler barriers suffice.
+    */
+
+    u32 Start;
+    u64 Ns;
+
+    do {
+        Start = Sequence;
+        __asm__ volatile("" ::: "memory");
+
+        Source* Src = Current;
+        if (!Src)
+            return 0;
+
+        u64 Delta = (Src->Read(Src) - BaseCycles) & Src->Mask;
+        Ns = BaseNs + CyclesToNs(Src, Delta);
+
+        __asm__ volatile("" ::: "memory");
+    } while ((Start & 1) || Start != Sequence);
+
+    return Ns;
+}
+
+/// @brief Folds Elapsed Cycles into the Base, before a Narrow Counter Wraps
+void ClockSource::Accumulate()
+{
+    Source* Src = Current;
+    if (!Src)
+        return;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    u64 Cycles = Src->Read(Src);
+    u64 Delta = (Cycles - BaseCycles) & Src->Mask;
+
+    Sequence++;
+    __asm__ volatile("" ::: "memory");
+    BaseNs += CyclesToNs(Src, Delta);
+    BaseCycles = Cycles;
+    __asm__ volatile("" ::: "memory");
+    Sequence++;
+
+    Cpu::RestoreFlags(Flags);
+}
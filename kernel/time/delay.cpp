@@ -0,0 +1,34 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <kernel/time/clockevt.hpp>
+#include <kernel/time/delay.hpp>
+
+using namespace tacOS::Kernel;
+
+/* Define Statics */
+u64 Delay::CyclesPerNs;
+
+/// @brief Enables TSC based Delays
+/// @param TscFrequency Calibrated TSC Frequency in Hz
+void Delay::Calibrate(u64 TscFrequency)
+{
+    /* Shifted Separately, Frequencies above 2^32 Hz Overflow a Single Shift */
+    CyclesPerNs = ((TscFrequency / KERNEL_NSEC_PER_SEC) << KERNEL_DELAY_SHIFT)
+        + (((TscFrequency % KERNEL_NSEC_PER_SEC) << KERNEL_DELAY_SHIFT) / KERNEL_NSEC_PER_SEC);
+}
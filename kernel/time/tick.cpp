@@ -0,0 +1,369 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/interrupts/softirq.hpp>
+#include <kernel/sched/sched.hpp>
+#include <kernel/smp/isolation.hpp>
+#include <kernel/sync/rcu.hpp>
+#include <kernel/time/clocksrc.hpp>
+#include <kernel/time/tick.hpp>
+#include <kernel/time/timerwheel.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::ASM;
+
+/* Define Statics */
+volatile u64 Tick::Jiffies;
+Tick::CpuTick Tick::Ticks[KERNEL_SMP_MAXCPUS];
+
+/// @brief Initializes the Tick Layer, before any Device is Registered
+void Tick::Initialize()
+{
+    /*
+        Each processor keeps its own tick. A busy processor takes
+        KERNEL_TICK_HZ ticks per second for accounting and the
+        timer wheel. An idle processor stops its tick (NOHZ idle).
+        Its device is then programmed for the earliest of its own
+        timers, so an idle core with nothing pending is not woken.
+        A NOHZ Full processor (see Isolation) also stops it while
+        running a single thread, keeping a residual tick per second.
+
+        Deadlines finer than a tick are high-resolution timers.
+        They program the one-shot device directly. They are kept
+        on a sorted list, since only a few are ever armed at once
+        (sleeps, scheduler slices). Bulk timeouts use the wheel.
+
+        Refer:
+        https://docs.kernel.org/timers/no_hz.html
+        https://lwn.net/Articles/549580/
+    */
+
+    for (u32 Cpu = 0; Cpu < KERNEL_SMP_MAXCPUS; Cpu++)
+        Ticks[Cpu].NextEvent = KERNEL_TICK_NOEVENT;
+
+    TimerWheel::Initialize();
+    SoftIrq::RegisterAction(SoftIrq::TIMER, RunTimers);
+}
+
+/// @brief Hands a Processor's Tick to a Timer Event Device
+/// @param Dev Device selected by ClockEvent::Register
+void Tick::InstallDevice(ClockEvent::Device* Dev)
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    CpuTick* Tck = &Ticks[Dev->Cpu];
+
+    Update(Tck);
+    Tck->Device = Dev;
+    Tck->Base = Tck->Now;
+    Tck->NextTick = Tck->Now + KERNEL_TICK_PERIODNS;
+    Tck->Periodic = !(Dev->Features & KERNEL_CLOCKEVT_ONESHOT);
+    Dev->EventHandler = HandleEvent;
+
+    if (Tck->Periodic) {
+        Tck->NextEvent = Tck->NextTick;
+        Dev->SetPeriodic(Dev, KERNEL_TICK_PERIODNS);
+    } else
+        Program(Tck);
+
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Returns the Clock of the Executing Processor in Nanoseconds
+u64 Tick::Now()
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    CpuTick* Tck = &Ticks[Smp::CurrentCpu()];
+
+    Update(Tck);
+    u64 Current = Tck->Now;
+
+    Cpu::RestoreFlags(Flags);
+    return Current;
+}
+
+/// @brief Advances a Processor Clock by the Device's Elapsed Time, IF Clear
+void Tick::Update(CpuTick* Tck)
+{
+    /*
+        Time comes from the clock source. Before one is registered,
+        it is derived from the event device itself. The device
+        counts down from the programmed delta, so Base plus the
+        elapsed part is the current time.
+    */
+
+    if (ClockSource::Current) {
+        Tck->Now = ClockSource::Now();
+        return;
+    }
+
+    ClockEvent::Device* Dev = Tck->Device;
+    if (!Dev)
+        return;
+
+    Tck->Now = Tck->Base + Dev->Elapsed(Dev);
+}
+
+/// @brief Accounts the Periodic Ticks that passed, IF Clear
+/// @return Number of Ticks that passed (0 if None)
+u64 Tick::AdvanceTicks(CpuTick* Tck)
+{
+    if (Tck->Now < Tck->NextTick)
+        return 0;
+
+    u64 Passed = ((Tck->Now - Tck->NextTick) / KERNEL_TICK_PERIODNS) + 1;
+    Tck->NextTick += Passed * KERNEL_TICK_PERIODNS;
+
+    /* The Bootstrap Processor does the Global Timekeeping */
+    if (Tck == &Ticks[KERNEL_SMP_BOOTCPU]) {
+        Jiffies += Passed;
+        ClockSource::Accumulate();
+    }
+
+    return Passed;
+}
+
+/// @brief Programs the Device for the Next Deadline, IF Clear
+void Tick::Program(CpuTick* Tck)
+{
+    ClockEvent::Device* Dev = Tck->Device;
+    u64 Next = (Tck->Stopped) ? KERNEL_TICK_NOEVENT : Tck->NextTick;
+
+    if (Tck->HrTimers && Tck->HrTimers->Expires < Next)
+        Next = Tck->HrTimers->Expires;
+
+    /* A Running Tick drives the Wheel, a Stopped one wakes for it */
+    if (Tck->Stopped) {
+        u64 WheelExpiry = TimerWheel::NextExpiry(Tck - Ticks);
+        if (WheelExpiry != TIMERWHEEL_NOEXPIRY && WheelExpiry * KERNEL_TICK_PERIODNS < Next)
+            Next = WheelExpiry * KERNEL_TICK_PERIODNS;
+    }
+
+    /* A Busy Thread still has to Report to RCU and be Accounted */
+    if (Tck->FullStop && Tck->Now + KERNEL_TICK_MAXDEFERNS < Next)
+        Next = Tck->Now + KERNEL_TICK_MAXDEFERNS;
+
+    /*
+        With nothing pending, the device is stopped. Only the Boot
+        Processor wakes, and only as often as a narrow clock source
+        needs to be accumulated. Without a clock source the device
+        keeps this processor's clock, so it is armed for its
+        longest delta instead.
+    */
+
+    ClockSource::Source* Src = ClockSource::Current;
+    if (Src && Tck == &Ticks[KERNEL_SMP_BOOTCPU] && Src->MaxIdleNs != ~0ULL && Tck->Now + Src->MaxIdleNs < Next)
+        Next = Tck->Now + Src->MaxIdleNs;
+
+    if (Src && Next == KERNEL_TICK_NOEVENT) {
+        Tck->NextEvent = KERNEL_TICK_NOEVENT;
+        Dev->Shutdown(Dev);
+        return;
+    }
+
+    u64 Delta = (Next > Tck->Now) ? Next - Tck->Now : 0;
+    if (Delta < Dev->MinDeltaNs)
+        Delta = Dev->MinDeltaNs;
+    if (Delta > Dev->MaxDeltaNs)
+        Delta = Dev->MaxDeltaNs;
+
+    Tck->Base = Tck->Now;
+    Tck->NextEvent = Tck->Now + Delta;
+    Dev->SetOneShot(Dev, Delta);
+}
+
+/// @brief Tick Device Interrupt, Runs in Interrupt Context
+void Tick::HandleEvent(ClockEvent::Device* Dev)
+{
+    CpuTick* Tck = &Ticks[Dev->Cpu];
+
+    /* A Periodic Device Reloads itself, its Elapsed restarts every Period */
+    if (Tck->Periodic)
+        Tck->Base += KERNEL_TICK_PERIODNS;
+
+    Update(Tck);
+    if (AdvanceTicks(Tck)) {
+        Scheduler::Tick(Dev->Cpu);
+        Rcu::Tick(Dev->Cpu);
+    }
+
+    /* Expired Timers run in the Bottom Half, with Interrupts Enabled */
+    if ((Tck->HrTimers && Tck->HrTimers->Expires <= Tck->Now)
+        || TimerWheel::HasExpired(Dev->Cpu, Tck->Now / KERNEL_TICK_PERIODNS))
+        SoftIrq::Raise(SoftIrq::TIMER);
+
+    /* NOHZ Full, a Single Thread has Nothing to Round-Robin with */
+    if (!Tck->Periodic && Isolation::IsNoHzFull(Dev->Cpu) && (!Tck->Stopped || Tck->FullStop)) {
+        bool Stop = Scheduler::CanStopTick(Dev->Cpu) && !Rcu::NeedsCpu(Dev->Cpu);
+        Tck->Stopped = Stop;
+        Tck->FullStop = Stop;
+    }
+
+    if (!Tck->Periodic)
+        Program(Tck);
+}
+
+/// @brief Runs Expired Timers of the Executing Processor (TIMER SoftIrq)
+void Tick::RunTimers()
+{
+    u32 CpuIndex = Smp::CurrentCpu();
+    CpuTick* Tck = &Ticks[CpuIndex];
+
+    for (;;) {
+        u64 Flags = Cpu::SaveFlagsAndDisable();
+        Update(Tck);
+
+        HrTimer* Expired = Tck->HrTimers;
+        if (!Expired || Expired->Expires > Tck->Now) {
+            Cpu::RestoreFlags(Flags);
+            break;
+        }
+
+        /* Unlinked before running, the Routine may Re-Arm it */
+        Tck->HrTimers = Expired->Next;
+        Expired->Pending = false;
+        Cpu::RestoreFlags(Flags);
+
+        Expired->Routine(Expired->Context);
+    }
+
+    TimerWheel::Run(CpuIndex, Now() / KERNEL_TICK_PERIODNS);
+}
+
+/// @brief Arms a High-Resolution Timer on the Executing Processor
+/// @param Tmr Caller-Owned Timer, Re-Armed if Pending
+/// @param DelayNs Nanoseconds from Now
+/// @param Routine Runs in the TIMER Bottom Half on this Processor
+/// @param Context Opaque pointer passed to the Routine
+void Tick::ArmHrTimer(HrTimer* Tmr, u64 DelayNs, TimerRoutine Routine, void* Context)
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    if (Tmr->Pending)
+        CancelHrTimer(Tmr);
+
+    u32 CpuIndex = Smp::CurrentCpu();
+    CpuTick* Tck = &Ticks[CpuIndex];
+    Update(Tck);
+
+    Tmr->Expires = Tck->Now + DelayNs;
+    Tmr->Routine = Routine;
+    Tmr->Context = Context;
+    Tmr->Cpu = CpuIndex;
+    Tmr->Pending = true;
+
+    /* Sorted Insert, Equal Deadlines keep Arming Order */
+    HrTimer** Link = &Tck->HrTimers;
+    while (*Link && (*Link)->Expires <= Tmr->Expires)
+        Link = &(*Link)->Next;
+
+    Tmr->Next = *Link;
+    *Link = Tmr;
+
+    /* An Earlier Deadline than Programmed pulls the Device in */
+    if (Tck->Device && !Tck->Periodic && Tmr->Expires < Tck->NextEvent)
+        Program(Tck);
+
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Cancels a Pending High-Resolution Timer, must run on the Processor that Armed it
+/// @param Tmr Timer to Cancel
+/// @return True if the Timer was Pending
+bool Tick::CancelHrTimer(HrTimer* Tmr)
+{
+    if (!Tmr->Pending)
+        return false;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    bool Removed = false;
+
+    /* The Device is left Programmed, an Early Event is Harmless */
+    for (HrTimer** Link = &Ticks[Tmr->Cpu].HrTimers; *Link; Link = &(*Link)->Next) {
+        if (*Link == Tmr) {
+            *Link = Tmr->Next;
+            Tmr->Pending = false;
+            Removed = true;
+            break;
+        }
+    }
+
+    Cpu::RestoreFlags(Flags);
+    return Removed;
+}
+
+/// @brief Stops the Tick before Idling, Called with IF Clear
+void Tick::EnterIdle()
+{
+    /* Pending RCU Callbacks are Advanced on the Tick, it keeps Running */
+    CpuTick* Tck = &Ticks[Smp::CurrentCpu()];
+    if (!Tck->Device || Tck->Periodic)
+        return;
+
+    if (Rcu::NeedsCpu(Smp::CurrentCpu())) {
+        Restart();
+        return;
+    }
+
+    Update(Tck);
+    Tck->Stopped = true;
+    Tck->FullStop = false;
+    Program(Tck);
+}
+
+/// @brief Returns the Time till the Device Fires, Called with IF Clear after EnterIdle()
+/// @return Nanoseconds, KERNEL_TICK_NOEVENT if Nothing is Pending
+u64 Tick::ExpectedIdleNs()
+{
+    CpuTick* Tck = &Ticks[Smp::CurrentCpu()];
+    if (!Tck->Device)
+        return KERNEL_TICK_NOEVENT;
+
+    /* A Periodic Device was not Reprogrammed, it Fires on the Next Tick */
+    Update(Tck);
+    u64 Deadline = (Tck->Periodic) ? Tck->NextTick : Tck->NextEvent;
+    if (Deadline == KERNEL_TICK_NOEVENT)
+        return KERNEL_TICK_NOEVENT;
+
+    return (Deadline > Tck->Now) ? Deadline - Tck->Now : 0;
+}
+
+/// @brief Restarts the Tick after Idling, Called with IF Clear
+void Tick::ExitIdle()
+{
+    Restart();
+}
+
+/// @brief Restarts a Stopped Tick of the Executing Processor, Called with IF Clear
+void Tick::Restart()
+{
+    CpuTick* Tck = &Ticks[Smp::CurrentCpu()];
+    if (!Tck->Stopped)
+        return;
+
+    Update(Tck);
+    Tck->Stopped = false;
+    Tck->FullStop = false;
+
+    /* Account the Ticks that were never Taken */
+    u64 Before = Tck->NextTick;
+    AdvanceTicks(Tck);
+    Tck->SkippedTicks += (Tck->NextTick - Before) / KERNEL_TICK_PERIODNS;
+
+    if (Tck->NextEvent > Tck->NextTick)
+        Program(Tck);
+}
@@ -0,0 +1,328 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/time/tick.hpp>
+#include <kernel/time/timerwheel.hpp>
+
+using namespace tacOS::Kernel;
+using namespace tacOS::ASM;
+
+/* Define Statics */
+TimerWheel::Base TimerWheel::Bases[KERNEL_SMP_MAXCPUS];
+
+/// @brief Initializes the Wheels, before the Tick Starts
+void TimerWheel::Initialize()
+{
+    /*
+        Most timers are timeouts that are cancelled long before
+        they expire (I/O, retransmits). A hashed, hierarchical
+        wheel makes both arming and cancelling O(1): the slot is
+        derived from the expiry, and removal only relinks the
+        neighbours. Far-future timers sit in coarse outer levels
+        and are cascaded one level down each time the level below
+        completes a rotation. Most are cancelled before that.
+
+        Refer:
+        Varghese & Lauck, Hashed and Hierarchical Timing Wheels (1987)
+        https://lwn.net/Articles/156329/
+    */
+
+    u64 Jiffies = Tick::Now() / KERNEL_TICK_PERIODNS;
+    for (u32 Cpu = 0; Cpu < KERNEL_SMP_MAXCPUS; Cpu++)
+        Bases[Cpu].Clock = Jiffies;
+}
+
+/// @brief Converts a Delay into an Absolute Expiry, Rounded Up
+u64 TimerWheel::GetExpires(u64 DelayNs)
+{
+    /* A Timer never Fires Early, Round to the next Jiffy Boundary */
+    return (Tick::Now() + DelayNs + KERNEL_TICK_PERIODNS - 1) / KERNEL_TICK_PERIODNS;
+}
+
+/// @brief Links a Timer into its Slot, IF Clear
+void TimerWheel::Enqueue(Base* Wheel, Timer* Tmr)
+{
+    u64 Expires = Tmr->Expires;
+    Timer** Slot;
+
+    if (Expires < Wheel->Clock)
+        /* Already Due, Run at the next Processed Jiffy */
+        Slot = &Wheel->Root[Wheel->Clock & TIMERWHEEL_ROOTMASK];
+
+    else if (Expires - Wheel->Clock < TIMERWHEEL_ROOTSIZE)
+        Slot = &Wheel->Root[Expires & TIMERWHEEL_ROOTMASK];
+
+    else {
+        if (Expires - Wheel->Clock > TIMERWHEEL_MAXDELTA)
+            Expires = Tmr->Expires = Wheel->Clock + TIMERWHEEL_MAXDELTA;
+
+        /* Pick the Innermost Level whose Range covers the Delta */
+        u64 Delta = Expires - Wheel->Clock;
+        u32 Level = 0;
+        while (Level < TIMERWHEEL_LEVELS - 1 && Delta >= (1ULL << TIMERWHEEL_LEVELSHIFT(Level + 1)))
+            Level++;
+
+        Slot = &Wheel->Levels[Level][(Expires >> TIMERWHEEL_LEVELSHIFT(Level)) & TIMERWHEEL_LEVELMASK];
+    }
+
+    Tmr->Next = *Slot;
+    Tmr->Prev = Slot;
+    if (Tmr->Next)
+        Tmr->Next->Prev = &Tmr->Next;
+
+    *Slot = Tmr;
+    Tmr->TimerState = QUEUED;
+    Wheel->Pending++;
+}
+
+/// @brief Removes a Timer from its Slot in O(1), IF Clear
+void TimerWheel::Unlink(Timer* Tmr)
+{
+    *Tmr->Prev = Tmr->Next;
+    if (Tmr->Next)
+        Tmr->Next->Prev = Tmr->Prev;
+
+    Tmr->Next = 0;
+    Tmr->Prev = 0;
+}
+
+/// @brief Arms a Timer on the Executing Processor
+/// @param Tmr Caller-Owned Timer, Re-Armed if Pending
+/// @param DelayNs Nanoseconds from Now, Rounded up to a Jiffy
+/// @param Routine Runs in the TIMER Bottom Half on this Processor
+/// @param Context Opaque pointer passed to the Routine
+void TimerWheel::Arm(Timer* Tmr, u64 DelayNs, TimerRoutine Routine, void* Context)
+{
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    if (Tmr->TimerState == QUEUED)
+        Cancel(Tmr);
+
+    Tmr->Expires = GetExpires(DelayNs);
+    Tmr->Routine = Routine;
+    Tmr->Context = Context;
+    Tmr->Cpu = Smp::CurrentCpu();
+    Enqueue(&Bases[Tmr->Cpu], Tmr);
+
+    Cpu::RestoreFlags(Flags);
+}
+
+/// @brief Cancels a Queued Timer, must run on the Processor that owns it
+/// @param Tmr Timer to Cancel
+/// @return True if the Timer was Queued (Migrating Timers cannot be Cancelled)
+bool TimerWheel::Cancel(Timer* Tmr)
+{
+    if (Tmr->TimerState != QUEUED)
+        return false;
+
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    Unlink(Tmr);
+    Tmr->TimerState = IDLE;
+    Bases[Tmr->Cpu].Pending--;
+
+    Cpu::RestoreFlags(Flags);
+    return true;
+}
+
+/// @brief Arms an Idle Timer on another Processor
+/// @param Tmr Timer, must not be Queued
+/// @param Cpu Logical CPU Index that runs the Timer
+/// @param DelayNs Nanoseconds from Now, Rounded up to a Jiffy
+/// @param Routine Runs in the TIMER Bottom Half on Cpu
+/// @param Context Opaque pointer passed to the Routine
+/// @return True if Handed Over
+bool TimerWheel::Migrate(Timer* Tmr, u32 Cpu, u64 DelayNs, TimerRoutine Routine, void* Context)
+{
+    /*
+        Timers run where they were armed, which keeps their data
+        cache-hot and the wheels free of locks. Moving one is the
+        explicit exception. The wheel of another processor is never
+        touched, the timer is pushed onto its lock-free remote list
+        and linked by that processor on its next run.
+    */
+
+    if (Tmr->TimerState != IDLE)
+        return false;
+
+    Tmr->Expires = GetExpires(DelayNs);
+    Tmr->Routine = Routine;
+    Tmr->Context = Context;
+    Tmr->Cpu = Cpu;
+    Tmr->TimerState = REMOTE;
+
+    Base* Wheel = &Bases[Cpu];
+    Timer* Head = Wheel->Remote;
+    do
+        Tmr->Next = Head;
+    while (!__atomic_compare_exchange_n(&Wheel->Remote, &Head, Tmr, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    return true;
+}
+
+/// @brief Links Timers Migrated to this Processor, IF Clear
+void TimerWheel::DrainRemote(Base* Wheel)
+{
+    if (!Wheel->Remote)
+        return;
+
+    Timer* List = __atomic_exchange_n(&Wheel->Remote, (Timer*)0, __ATOMIC_ACQUIRE);
+    while (List) {
+        Timer* Tmr = List;
+        List = List->Next;
+        Enqueue(Wheel, Tmr);
+    }
+}
+
+/// @brief Moves one Slot of an Outer Level down the Wheel, IF Clear
+/// @return True if the Level Wrapped, so the next Level cascades too
+bool TimerWheel::Cascade(Base* Wheel, u32 Level)
+{
+    u32 Index = (Wheel->Clock >> TIMERWHEEL_LEVELSHIFT(Level)) & TIMERWHEEL_LEVELMASK;
+    Timer* List = Wheel->Levels[Level][Index];
+    Wheel->Levels[Level][Index] = 0;
+
+    /* Every Timer lands in a Lower Level, or the Root */
+    while (List) {
+        Timer* Tmr = List;
+        List = List->Next;
+
+        Wheel->Pending--;
+        Enqueue(Wheel, Tmr);
+    }
+
+    return Index == 0;
+}
+
+/// @brief Checks if a Processor has Timers Due by a Jiffy
+bool TimerWheel::HasExpired(u32 Cpu, u64 Jiffies)
+{
+    Base* Wheel = &Bases[Cpu];
+    return (Wheel->Pending || Wheel->Remote) && Wheel->Clock <= Jiffies;
+}
+
+/// @brief Returns the earliest Jiffy the Wheel must be Run at
+/// @param Cpu Logical CPU Index
+/// @return Jiffy, or TIMERWHEEL_NOEXPIRY if the Wheel is Empty
+u64 TimerWheel::NextExpiry(u32 Cpu)
+{
+    /*
+        Called when the tick stops, and by Run() to skip ahead. The
+        root level is exact. For outer levels, the jiffy their next
+        non-empty slot cascades at is returned, which may be earlier
+        than the expiry. The processor then wakes, cascades and
+        sleeps again. Root slots past the rotation hold timers that
+        are still valid, but a cascade at the rotation may queue
+        earlier ones, so the earliest of both is returned.
+    */
+
+    Base* Wheel = &Bases[Cpu];
+    if (Wheel->Remote)
+        return Wheel->Clock;
+
+    if (!Wheel->Pending)
+        return TIMERWHEEL_NOEXPIRY;
+
+    u64 Earliest = TIMERWHEEL_NOEXPIRY;
+    for (u64 Jiffy = Wheel->Clock; Jiffy < Wheel->Clock + TIMERWHEEL_ROOTSIZE; Jiffy++) {
+        if (Wheel->Root[Jiffy & TIMERWHEEL_ROOTMASK]) {
+            Earliest = Jiffy;
+            break;
+        }
+    }
+
+    for (u32 Level = 0; Level < TIMERWHEEL_LEVELS; Level++) {
+        u32 Shift = TIMERWHEEL_LEVELSHIFT(Level);
+        u64 Current = Wheel->Clock >> Shift;
+
+        for (u64 Step = 1; Step <= TIMERWHEEL_LEVELSIZE; Step++) {
+            if (Wheel->Levels[Level][(Current + Step) & TIMERWHEEL_LEVELMASK]) {
+                u64 CascadeAt = (Current + Step) << Shift;
+                if (CascadeAt < Earliest)
+                    Earliest = CascadeAt;
+                break;
+            }
+        }
+    }
+
+    return Earliest;
+}
+
+/// @brief Runs Timers Due by a Jiffy (TIMER SoftIrq)
+/// @param CpuIndex Logical Index of the Executing Processor
+/// @param Jiffies Current Jiffy
+void TimerWheel::Run(u32 CpuIndex, u64 Jiffies)
+{
+    Base* Wheel = &Bases[CpuIndex];
+    u64 Flags = Cpu::SaveFlagsAndDisable();
+    DrainRemote(Wheel);
+
+    while (Wheel->Clock <= Jiffies) {
+        /* Nothing Queued, Skip Ahead (Slot Positions stay Consistent) */
+        if (!Wheel->Pending) {
+            Wheel->Clock = Jiffies + 1;
+            break;
+        }
+
+        /*
+            Catching up after the tick was stopped (NOHZ idle, NOHZ
+            full) would otherwise step through every empty slot with
+            interrupts disabled. Only jiffies that expire a timer or
+            cascade a non-empty outer slot are visited. Skipped root
+            rotations and outer slots are empty by construction.
+        */
+
+        if (Wheel->Clock < Jiffies) {
+            u64 Next = NextExpiry(CpuIndex);
+            if (Next > Jiffies) {
+                Wheel->Clock = Jiffies + 1;
+                break;
+            }
+
+            if (Next > Wheel->Clock)
+                Wheel->Clock = Next;
+        }
+
+        u32 Index = Wheel->Clock & TIMERWHEEL_ROOTMASK;
+        if (!Index) {
+            for (u32 Level = 0; Level < TIMERWHEEL_LEVELS; Level++)
+                if (!Cascade(Wheel, Level))
+                    break;
+        }
+
+        /* Detach the Slot, Cancel keeps working on the Local List */
+        Timer* Expired = Wheel->Root[Index];
+        Wheel->Root[Index] = 0;
+        if (Expired)
+            Expired->Prev = &Expired;
+
+        Wheel->Clock++;
+        while (Expired) {
+            Timer* Tmr = Expired;
+            Unlink(Tmr);
+            Tmr->TimerState = IDLE;
+            Wheel->Pending--;
+
+            /* The Routine may Re-Arm or Cancel other Expired Timers */
+            Cpu::RestoreFlags(Flags);
+            Tmr->Routine(Tmr->Context);
+            Cpu::SaveFlagsAndDisable();
+        }
+    }
+
+    Cpu::RestoreFlags(Flags);
+}
@@ -89,6 +89,7 @@ osload:
 
     ; Check CPU Capabilities and Enable Paging
     call cpu_check
+    call cpu_sse
     call memory_paging
 
     ; Load GDT, Perform Long Jump
@@ -187,6 +188,54 @@ error_lm:
     mov ebx, 0x43
     jmp error
 
+; Enable SSE and Extended State Management
+cpu_sse:
+    ; The x86-64 ABI (and compiler) assumes SSE, it has to
+    ; be usable before any C++ runs. XSAVE managed state is
+    ; enabled in XCR0 for x87, SSE and AVX (if supported).
+    mov eax, 1
+    cpuid
+    test edx, 1 << 25      ; SSE
+    jz error_sse
+
+    ; Clear CR0.EM (bit 2), Set CR0.MP (bit 1) and CR0.NE (bit 5)
+    mov eax, cr0
+    and eax, ~(1 << 2)
+    or eax, (1 << 1) | (1 << 5)
+    mov cr0, eax
+
+    ; Set CR4.OSFXSR (bit 9) and CR4.OSXMMEXCPT (bit 10)
+    mov eax, cr4
+    or eax, (1 << 9) | (1 << 10)
+    mov cr4, eax
+
+    ; Set CR4.OSXSAVE (bit 18) if XSAVE is supported
+    test ecx, 1 << 26
+    jz cpu_sse_done
+    mov eax, cr4
+    or eax, 1 << 18
+    mov cr4, eax
+
+    ; XCR0: x87 and SSE, with AVX (bit 2) if supported
+    mov esi, ecx
+    mov eax, 0b011
+    test esi, 1 << 28
+    jz cpu_sse_xcr0
+    or eax, 0b100
+
+    cpu_sse_xcr0:
+        xor ecx, ecx
+        xor edx, edx
+        xsetbv
+
+    cpu_sse_done:
+        fninit
+        ret
+
+error_sse:
+    mov ebx, 0x44
+    jmp error
+
 ; Setup Basic Paging
 memory_paging:
     ; Map PDP Table to first PML4 Entry
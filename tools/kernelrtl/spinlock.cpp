@@ -0,0 +1,173 @@
+/*
+    tacOS
+    Copyright (C) 2024  Atheesh Thirumalairajan
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <asm/cpu.hpp>
+#include <kernel/smp/percpu.hpp>
+#include <kernel/smp/smp.hpp>
+#include <tools/kernelrtl/printf.hpp>
+#include <tools/kernelrtl/spinlock.hpp>
+
+using namespace tacOS::ASM;
+using namespace tacOS::Kernel;
+using namespace tacOS::Tools;
+using namespace tacOS::Tools::KernelRTL;
+
+/* Define Statics */
+LockClass* LockStatistics::Classes;
+
+/* Queue Nodes of every Nesting Level, and the Levels in use */
+static KERNEL_PERCPU QueuedSpinLock::QueueNode QueueNodes[KERNELRTL_QSPINLOCK_MAXNESTING];
+static KERNEL_PERCPU u32 QueueDepth;
+
+/// @brief Encodes a Queue Node as a Tail, 0 means an Empty Queue
+static inline u16 EncodeTail(u32 Cpu, u32 Level)
+{
+    return (u16)(((Cpu + 1) << 2) | Level);
+}
+
+/// @brief Returns the Queue Node a Tail refers to
+static inline QueuedSpinLock::QueueNode* DecodeTail(u16 Tail)
+{
+    return PerCpu::Remote(QueueNodes[0], (Tail >> 2) - 1) + (Tail & 3);
+}
+
+/// @brief Queues the Executing Processor and Waits for the Lock
+/// @return Number of Spin Iterations
+u64 QueuedSpinLock::LockSlowPath()
+{
+    u64 Spins = 0;
+    u32 Level = PerCpu::Read(QueueDepth);
+
+    /* Deeper Nesting than expected (NMI in NMI?), Spin on the Word instead */
+    if (Level >= KERNELRTL_QSPINLOCK_MAXNESTING) {
+        for (;;) {
+            u32 Expected = 0;
+            if (__atomic_compare_exchange_n(&Value, &Expected, KERNELRTL_QSPINLOCK_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                return Spins;
+
+            Cpu::Pause();
+            Spins++;
+        }
+    }
+
+    /*
+        The level is taken before the node is touched. An interrupt
+        arriving in between takes the next level, and releases it
+        before returning, so nodes are never shared.
+    */
+
+    PerCpu::Add(QueueDepth, 1U);
+    QueueNode* Node = PerCpu::Local(QueueNodes[0]) + Level;
+    Node->Next = 0;
+    Node->Ready = false;
+
+    /* Become the Tail, then Link behind the Previous One */
+    u16 Previous = __atomic_exchange_n(&Tail, EncodeTail(Smp::CurrentCpu(), Level), __ATOMIC_ACQ_REL);
+    if (Previous) {
+        __atomic_store_n(&DecodeTail(Previous)->Next, Node, __ATOMIC_RELEASE);
+        while (!__atomic_load_n(&Node->Ready, __ATOMIC_ACQUIRE)) {
+            Cpu::Pause();
+            Spins++;
+        }
+    }
+
+    /* Head of the Queue, only this Processor Spins on the Word */
+    while (__atomic_load_n(&Locked, __ATOMIC_ACQUIRE)) {
+        Cpu::Pause();
+        Spins++;
+    }
+
+    /* Still the Tail? Take the Lock and Empty the Queue at Once */
+    u32 Expected = (u32)EncodeTail(Smp::CurrentCpu(), Level) << 16;
+    if (!__atomic_compare_exchange_n(&Value, &Expected, KERNELRTL_QSPINLOCK_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        /*
+            Someone queued behind us. The fast path can't succeed
+            while the Tail is set, so the Locked byte is ours to set.
+            Their link may not be stored yet, wait for it.
+        */
+
+        __atomic_store_n(&Locked, KERNELRTL_QSPINLOCK_LOCKED, __ATOMIC_RELAXED);
+
+        QueueNode* Next;
+        while (!(Next = __atomic_load_n(&Node->Next, __ATOMIC_ACQUIRE))) {
+            Cpu::Pause();
+            Spins++;
+        }
+
+        __atomic_store_n(&Next->Ready, true, __ATOMIC_RELEASE);
+    }
+
+    PerCpu::Add(QueueDepth, (u32)-1);
+    return Spins;
+}
+
+/// @brief Accounts an Acquisition of a Lock Class
+/// @param Class Lock Class (0 if Unclassified)
+/// @param Spins Spin Iterations before Acquiring
+void LockStatistics::Acquired(LockClass* Class, u64 Spins)
+{
+    if (!Class)
+        return;
+
+    /* Classes Register on First Use, so Unused ones are not Dumped */
+    if (!__atomic_load_n(&Class->Registered, __ATOMIC_ACQUIRE)
+        && !__atomic_exchange_n(&Class->Registered, true, __ATOMIC_ACQ_REL)) {
+        LockClass* Head = __atomic_load_n(&Classes, __ATOMIC_RELAXED);
+        do {
+            Class->Next = Head;
+        } while (!__atomic_compare_exchange_n(&Classes, &Head, Class, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+
+    __atomic_fetch_add(&Class->Acquisitions, 1, __ATOMIC_RELAXED);
+    if (Spins) {
+        __atomic_fetch_add(&Class->Contentions, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&Class->Spins, Spins, __ATOMIC_RELAXED);
+    }
+}
+
+/// @brief Accounts a Release of a Lock Class
+/// @param Class Lock Class (0 if Unclassified)
+/// @param HeldCycles TSC Cycles the Lock was Held
+void LockStatistics::Released(LockClass* Class, u64 HeldCycles)
+{
+    if (!Class)
+        return;
+
+    u64 Max = __atomic_load_n(&Class->MaxHoldCycles, __ATOMIC_RELAXED);
+    while (HeldCycles > Max
+        && !__atomic_compare_exchange_n(&Class->MaxHoldCycles, &Max, HeldCycles, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+/// @brief Writes the Statistics of every Used Lock Class
+void LockStatistics::Dump()
+{
+    printf("\nLock Statistics (Class, Acquisitions, Contended, Spins, Max Hold Cycles):\n");
+    for (LockClass* Class = __atomic_load_n(&Classes, __ATOMIC_ACQUIRE); Class; Class = Class->Next) {
+        printf((char*)Class->Name);
+        printf(": ");
+        printf(Class->Acquisitions);
+        printf(", ");
+        printf(Class->Contentions);
+        printf(", ");
+        printf(Class->Spins);
+        printf(", ");
+        printf(Class->MaxHoldCycles);
+        printf("\n");
+    }
+}
@@ -38,4 +38,14 @@ void* KernelRTL::memset(void* dest, u8 value, u64 len) {
     }
 
     return dest;
-}
\ No newline at end of file
+}
+
+void* KernelRTL::memcpy(void* dest, const void* src, u64 len) {
+    u8* dptr = (u8*) dest;
+    const u8* sptr = (const u8*) src;
+    while (len-- > 0) {
+        *(dptr++) = *(sptr++);
+    }
+
+    return dest;
+}